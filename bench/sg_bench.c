@@ -0,0 +1,157 @@
+/*
+ * sg-bench: Self-Guard per-call cost benchmark
+ *
+ * Usage: sg-bench [iterations]
+ *
+ * Reports the mean wall-clock cost of the public entry points so that
+ * build modes (static, shared, LTO, unity) can be compared directly,
+ * then the SG_OPT_GRANULE tradeoff on this binary's text.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "self_guard.h"
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Keeps results observable so calls are not optimized away */
+static volatile int g_sink;
+
+static void report(const char* name, uint64_t elapsed_ns, unsigned long iterations) {
+    printf("%-34s %12.1f ns/call  (%lu calls)\n",
+           name, (double)elapsed_ns / (double)iterations, iterations);
+}
+
+static void bench_get_state(unsigned long iterations) {
+    uint64_t start = now_ns();
+    for (unsigned long i = 0; i < iterations; i++) {
+        g_sink = (int)sg_get_security_state();
+    }
+    report("sg_get_security_state", now_ns() - start, iterations);
+}
+
+static void bench_detect_debugger(unsigned long iterations) {
+    uint64_t start = now_ns();
+    for (unsigned long i = 0; i < iterations; i++) {
+        g_sink = sg_detect_debugger();
+    }
+    report("sg_detect_debugger", now_ns() - start, iterations);
+}
+
+static void bench_require_fresh(unsigned long iterations) {
+    /* Make the state fresh first so every call takes the one-load path */
+    sg_check_integrity(SG_CHECK_MEMORY);
+
+    uint64_t start = now_ns();
+    for (unsigned long i = 0; i < iterations; i++) {
+        g_sink = (int)sg_require_fresh(60ULL * 1000000000ULL, SG_CHECK_ALL);
+    }
+    report("sg_require_fresh (fresh)", now_ns() - start, iterations);
+}
+
+/*
+ * Normalized per KiB verified: the text being hashed is this binary's
+ * own, so its size differs between build modes.
+ */
+static void bench_check_memory(unsigned long iterations) {
+    sg_check_result_t result;
+    uint64_t bytes = 0;
+    uint64_t start = now_ns();
+    for (unsigned long i = 0; i < iterations; i++) {
+        g_sink = (int)sg_check_integrity_ex(SG_CHECK_MEMORY, &result);
+        bytes += result.detectors[SG_DETECTOR_MEMORY].bytes_verified;
+    }
+    uint64_t elapsed = now_ns() - start;
+    printf("%-34s %12.1f ns/KiB   (%lu calls, %llu KiB each)\n",
+           "sg_check_integrity(MEMORY)",
+           (double)elapsed / ((double)bytes / 1024.0), iterations,
+           (unsigned long long)(bytes / iterations / 1024));
+}
+
+/* Pagemap mode: cost per call, since most pages are never hashed */
+static void bench_check_memory_pagemap(unsigned long iterations) {
+    if (sg_set_option(SG_OPT_MEMORY_MODE, SG_MEMORY_PAGEMAP) != SG_OK) {
+        return;
+    }
+    uint64_t start = now_ns();
+    for (unsigned long i = 0; i < iterations; i++) {
+        g_sink = (int)sg_check_integrity(SG_CHECK_MEMORY);
+    }
+    report("sg_check_integrity(MEMORY, pagemap)", now_ns() - start, iterations);
+    sg_set_option(SG_OPT_MEMORY_MODE, SG_MEMORY_HASH);
+}
+
+/*
+ * One line per granule: full-pass time, the latency of a one-page
+ * slice (which still covers a whole block), and the rotate-XOR digest
+ * table. Units other than ns/call and ns/KiB keep these out of the PGO
+ * gate in scripts/bench_compare.sh.
+ */
+static void bench_granules(unsigned long iterations) {
+    static const uint64_t granules[] = {4096, 64 * 1024, SG_GRANULE_MAX};
+    sg_check_result_t result;
+
+    for (size_t g = 0; g < sizeof(granules) / sizeof(granules[0]); g++) {
+        if (sg_set_option(SG_OPT_GRANULE, granules[g]) != SG_OK || sg_snapshot() != SG_OK) {
+            continue;
+        }
+
+        uint64_t bytes = 0;
+        uint64_t start = now_ns();
+        for (unsigned long i = 0; i < iterations; i++) {
+            g_sink = (int)sg_check_integrity_ex(SG_CHECK_MEMORY, &result);
+            bytes = result.detectors[SG_DETECTOR_MEMORY].bytes_verified;
+        }
+        const double pass_ms = (double)(now_ns() - start) / (double)iterations / 1e6;
+
+        /* max_age 0: every call runs one slice */
+        sg_set_option(SG_OPT_SLICE_PAGES, 1);
+        const unsigned long slices = iterations * 10;
+        start = now_ns();
+        for (unsigned long i = 0; i < slices; i++) {
+            g_sink = (int)sg_require_fresh(0, SG_CHECK_MEMORY);
+        }
+        const double slice_us = (double)(now_ns() - start) / (double)slices / 1e3;
+
+        const uint64_t blocks = (bytes + granules[g] - 1) / granules[g];
+        char name[40];
+        snprintf(name, sizeof(name), "granule %llu KiB", (unsigned long long)(granules[g] / 1024));
+        printf("%-34s %9.3f ms/pass  %9.1f us/slice  %8llu B table  (%llu KiB text)\n",
+               name, pass_ms, slice_us, (unsigned long long)(blocks * sizeof(uint32_t)),
+               (unsigned long long)(bytes / 1024));
+    }
+    sg_set_option(SG_OPT_GRANULE, 0);
+}
+
+int main(int argc, char** argv) {
+    unsigned long iterations = 1000000;
+    if (argc > 1) {
+        iterations = strtoul(argv[1], NULL, 10);
+        if (iterations == 0) {
+            fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (sg_init() != SG_OK || sg_snapshot() != SG_OK) {
+        fprintf(stderr, "[!] Self-Guard initialization failed\n");
+        return EXIT_FAILURE;
+    }
+
+    bench_get_state(iterations);
+    bench_require_fresh(iterations);
+    bench_detect_debugger(iterations / 100 + 1);
+    bench_check_memory(iterations / 1000 + 1);
+    bench_check_memory_pagemap(iterations / 1000 + 1);
+    bench_granules(iterations / 10000 + 1);
+
+    sg_shutdown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+# Self-Guard profile-guided optimization flow
+#
+# Invoked by the `pgo` target (cmake -P). Steps:
+#   1. Release baseline build of sg-bench
+#   2. Instrumented build (SG_PGO=GENERATE), run sg-train
+#   3. Rebuild the same tree with the profile (SG_PGO=USE)
+#   4. Run sg-bench on both builds and fail on regressions
+#
+# Required: SG_SOURCE_DIR, SG_PGO_ROOT
+# Optional: SG_PGO_COMPILER_ID, SG_PGO_TOLERANCE (percent, default 10)
+
+if(NOT SG_SOURCE_DIR OR NOT SG_PGO_ROOT)
+    message(FATAL_ERROR "pgo.cmake requires SG_SOURCE_DIR and SG_PGO_ROOT")
+endif()
+if(NOT SG_PGO_TOLERANCE)
+    set(SG_PGO_TOLERANCE 10)
+endif()
+
+set(BASELINE_DIR ${SG_PGO_ROOT}/baseline)
+set(PGO_DIR ${SG_PGO_ROOT}/build)
+set(PROFILE_DIR ${SG_PGO_ROOT}/profiles)
+
+function(sg_pgo_run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "PGO step failed (${result}): ${ARGN}")
+    endif()
+endfunction()
+
+# Three runs per build; the gate keeps the best of each benchmark
+function(sg_pgo_bench binary output)
+    file(WRITE ${output} "")
+    foreach(run RANGE 1 3)
+        execute_process(COMMAND ${binary}
+                        OUTPUT_VARIABLE bench_output
+                        RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "Benchmark failed (${result}): ${binary}")
+        endif()
+        file(APPEND ${output} "${bench_output}")
+    endforeach()
+endfunction()
+
+# Profiles from a previous run would be merged into the new ones
+file(REMOVE_RECURSE ${PROFILE_DIR})
+file(MAKE_DIRECTORY ${PROFILE_DIR})
+
+message(STATUS "[pgo] 1/4 baseline build")
+sg_pgo_run(${CMAKE_COMMAND} -S ${SG_SOURCE_DIR} -B ${BASELINE_DIR}
+           -DCMAKE_BUILD_TYPE=Release -DSG_PGO=OFF)
+sg_pgo_run(${CMAKE_COMMAND} --build ${BASELINE_DIR} --target sg-bench)
+
+message(STATUS "[pgo] 2/4 instrumented build + training")
+sg_pgo_run(${CMAKE_COMMAND} -S ${SG_SOURCE_DIR} -B ${PGO_DIR}
+           -DCMAKE_BUILD_TYPE=Release -DSG_PGO=GENERATE
+           -DSG_PGO_PROFILE_DIR=${PROFILE_DIR})
+sg_pgo_run(${CMAKE_COMMAND} --build ${PGO_DIR} --target sg-train)
+sg_pgo_run(${PGO_DIR}/sg-train)
+
+if(SG_PGO_COMPILER_ID MATCHES "Clang")
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    file(GLOB RAW_PROFILES ${PROFILE_DIR}/*.profraw)
+    sg_pgo_run(${LLVM_PROFDATA} merge -o ${PROFILE_DIR}/default.profdata ${RAW_PROFILES})
+endif()
+
+# Same tree and object paths, so the profiles match the objects
+message(STATUS "[pgo] 3/4 profile-guided rebuild")
+sg_pgo_run(${CMAKE_COMMAND} -S ${SG_SOURCE_DIR} -B ${PGO_DIR}
+           -DCMAKE_BUILD_TYPE=Release -DSG_PGO=USE
+           -DSG_PGO_PROFILE_DIR=${PROFILE_DIR})
+sg_pgo_run(${CMAKE_COMMAND} --build ${PGO_DIR})
+
+message(STATUS "[pgo] 4/4 benchmark gate (tolerance ${SG_PGO_TOLERANCE}%)")
+sg_pgo_bench(${BASELINE_DIR}/sg-bench ${SG_PGO_ROOT}/bench-baseline.txt)
+sg_pgo_bench(${PGO_DIR}/sg-bench ${SG_PGO_ROOT}/bench-pgo.txt)
+sg_pgo_run(sh ${SG_SOURCE_DIR}/scripts/bench_compare.sh
+           ${SG_PGO_ROOT}/bench-baseline.txt ${SG_PGO_ROOT}/bench-pgo.txt
+           ${SG_PGO_TOLERANCE})
+
+message(STATUS "[pgo] optimized artifacts: ${PGO_DIR}")
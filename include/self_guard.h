@@ -18,6 +18,27 @@
 extern "C" {
 #endif
 
+/* ============================================
+ * Symbol Visibility
+ *
+ * The library is compiled with -fvisibility=hidden; only SG_API
+ * symbols are exported. In the shared library they are protected,
+ * so calls from inside the library bind locally instead of going
+ * through the PLT.
+ * ============================================ */
+
+#ifndef SG_API
+#if defined(_WIN32) || defined(__CYGWIN__)
+#define SG_API
+#elif defined(SG_BUILD_SHARED) && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define SG_API __attribute__((visibility("protected")))
+#elif defined(__GNUC__) || defined(__clang__)
+#define SG_API __attribute__((visibility("default")))
+#else
+#define SG_API
+#endif
+#endif
+
 /* ============================================
  * Security State Definitions
  * ============================================ */
@@ -48,8 +69,287 @@ typedef enum {
 #define SG_CHECK_TIMING     (1 << 1)
 #define SG_CHECK_MEMORY     (1 << 2)
 #define SG_CHECK_STACK      (1 << 3)
+#define SG_CHECK_SIGNATURES (1 << 4)
+#define SG_CHECK_MAPS       (1 << 5)
+#define SG_CHECK_THREADS    (1 << 6)
+#define SG_CHECK_WATCH      (1 << 7)
 #define SG_CHECK_ALL        (0xFFFFFFFF)
 
+/* ============================================
+ * Detailed Check Results
+ * ============================================ */
+
+/* Detector index = bit position of its SG_CHECK_* flag */
+typedef enum {
+    SG_DETECTOR_DEBUGGER   = 0,
+    SG_DETECTOR_TIMING     = 1,
+    SG_DETECTOR_MEMORY     = 2,
+    SG_DETECTOR_STACK      = 3,
+    SG_DETECTOR_SIGNATURES = 4,
+    SG_DETECTOR_MAPS       = 5,
+    SG_DETECTOR_THREADS    = 6,
+    SG_DETECTOR_WATCH      = 7
+} sg_detector_t;
+
+#define SG_DETECTOR_MAX     16
+
+typedef enum {
+    SG_VERDICT_SKIPPED     = 0,  /* Not requested */
+    SG_VERDICT_PASS        = 1,  /* Ran, nothing found */
+    SG_VERDICT_SUSPICIOUS  = 2,  /* Ran, raised WARNING */
+    SG_VERDICT_TAMPERED    = 3,  /* Ran, raised COMPROMISED */
+    SG_VERDICT_UNAVAILABLE = 4,  /* Requested but not supported here */
+    SG_VERDICT_REPAIRED    = 5   /* Ran, restored tampered pages (SG_OPT_SELF_HEAL),
+                                    raised WARNING */
+} sg_verdict_t;
+
+typedef struct {
+    uint32_t verdict;         /* sg_verdict_t */
+    uint32_t reserved;
+    uint64_t cycles;          /* Cycle counter delta spent in the detector */
+    uint64_t bytes_verified;  /* Memory hashed by the detector */
+} sg_detector_result_t;
+
+typedef struct {
+    uint32_t flags_requested;
+    uint32_t state;               /* sg_security_state_t after the check */
+    uint64_t total_cycles;
+    uint64_t pages_remaining;     /* Digest blocks (see SG_OPT_GRANULE) of the sweep
+                                     not verified by this call */
+    uint64_t first_mismatch_addr; /* Start of the first mismatching block, 0 if none */
+    sg_detector_result_t detectors[SG_DETECTOR_MAX];
+} sg_check_result_t;
+
+/* Published state with its provenance (see sg_get_state_info) */
+typedef struct {
+    uint32_t state;       /* sg_security_state_t */
+    uint32_t generation;  /* Incremented by every check, wraps at 2^20 */
+    uint64_t age_ns;      /* Time since the last complete memory sweep,
+                             UINT64_MAX if none has completed */
+} sg_state_info_t;
+
+/* ============================================
+ * Runtime Options
+ * ============================================ */
+
+typedef enum {
+    SG_OPT_SLICE_PAGES = 1,  /* System pages' worth of bytes verified per
+                                sg_require_fresh slice, at least one digest
+                                block (default 64) */
+    SG_OPT_MEMORY_MODE = 2,  /* sg_memory_mode_t (default SG_MEMORY_HASH) */
+    SG_OPT_VERITY = 3,       /* 1: use the fs-verity Merkle tree of a verity-enabled
+                                executable as the baseline (default); 0: always hash */
+    SG_OPT_MODULES = 4,      /* 1: sg_snapshot also baselines the text of every loaded
+                                shared library (default 0) */
+    SG_OPT_SELF_HEAL = 5,    /* sg_heal_source_t: restore tampered pages of the main
+                                image instead of reporting COMPROMISED (default off) */
+    SG_OPT_CALLER_STATS = 6, /* 1: charge the cost of every check call to its call
+                                site (see sg_get_callers); setting 1 clears the
+                                table (default 0) */
+    SG_OPT_MONITOR_STALL_MS = 7, /* A running monitor silent this long reads as
+                                SG_WARNING (default 1000; 0: not enforced) */
+    SG_OPT_HASH = 8,         /* sg_hash_t for page digests, from the next
+                                sg_snapshot (default SG_HASH_ROTXOR) */
+    SG_OPT_GRANULE = 9,      /* Bytes covered by one digest, from the next
+                                sg_snapshot: a power of two from the system
+                                page size to SG_GRANULE_MAX, or 0 (default)
+                                for the system page size, SG_GRANULE_MAX
+                                where the region sits on huge pages */
+    SG_OPT_DIGEST_BITS = 10  /* Most bits kept of each digest, from the next
+                                sg_snapshot: 32, 64 or 128 truncate SipHash
+                                and SHA-256 to shrink the table, 0 (default)
+                                keeps the whole hash */
+} sg_option_t;
+
+/* Coarsest SG_OPT_GRANULE: one x86-64 / arm64 (4K granule) PMD huge page */
+#define SG_GRANULE_MAX (2u * 1024 * 1024)
+
+/* How SG_CHECK_MEMORY decides which code pages to hash */
+typedef enum {
+    SG_MEMORY_HASH = 0,      /* Hash every page */
+    SG_MEMORY_PAGEMAP = 1,   /* Linux: hash only pages /proc/self/pagemap reports
+                                as copy-on-written (anonymous), swapped or
+                                exclusively mapped; others cost 8 bytes of read */
+    SG_MEMORY_RESIDENT = 2   /* Never fault code in: hash resident pages, verify
+                                the rest against the backing file. Applies to
+                                sg_snapshot baselines too */
+} sg_memory_mode_t;
+
+/*
+ * Page digest of the memory baselines. Rotate-XOR and CRC32C are fast
+ * but a patch can be crafted to keep them; SipHash is keyed with a
+ * per-process random key; SHA-256 is collision resistant. Shared
+ * library baselines are only shared (sg_set_baseline_cache,
+ * sg_verify_file) with SG_HASH_ROTXOR.
+ */
+typedef enum {
+    SG_HASH_ROTXOR = 0,      /* 32-bit, the autotuned kernel */
+    SG_HASH_CRC32C = 1,      /* 32-bit, SSE4.2 / ARMv8 CRC when available */
+    SG_HASH_SIPHASH = 2,     /* 64-bit SipHash-2-4 */
+    SG_HASH_SHA256 = 3       /* 256-bit */
+} sg_hash_t;
+
+/* Where SG_OPT_SELF_HEAL takes the original bytes from */
+typedef enum {
+    SG_HEAL_OFF = 0,
+    SG_HEAL_FILE = 1,        /* Linux: the mapped file, read through the page cache */
+    SG_HEAL_SHADOW = 2       /* LZ4-compressed copy taken by sg_snapshot; set the
+                                option before sg_snapshot */
+} sg_heal_source_t;
+
+#define SG_REPAIR_SAMPLE    32
+
+/* Last self-healing repair (see sg_get_repair_info) */
+typedef struct {
+    uint64_t repairs;          /* Pages restored since sg_init */
+    uint64_t page_addr;        /* Range replaced by the last repair */
+    uint64_t page_len;
+    uint64_t first_diff_addr;  /* First byte that differed from the baseline */
+    uint64_t diff_span;        /* First to last differing byte, inclusive */
+    uint64_t diff_bytes;       /* Bytes that differed */
+    uint64_t restore_ns;       /* Compare, restore and re-verify */
+    uint32_t source;           /* sg_heal_source_t */
+    uint32_t sample_len;       /* Valid bytes in expected/found */
+    uint8_t expected[SG_REPAIR_SAMPLE]; /* Baseline bytes at first_diff_addr */
+    uint8_t found[SG_REPAIR_SAMPLE];    /* Bytes that were there instead */
+} sg_repair_info_t;
+
+/* ============================================
+ * Call-Site Cost Attribution
+ * ============================================ */
+
+#define SG_CALLER_NAME_MAX  64
+
+/* Entry points accounted with SG_OPT_CALLER_STATS */
+typedef enum {
+    SG_CALL_CHECK_INTEGRITY = 1,
+    SG_CALL_CHECK_INTEGRITY_EX = 2,
+    SG_CALL_REQUIRE_FRESH = 3,
+    SG_CALL_DETECT_DEBUGGER = 4
+} sg_call_t;
+
+typedef struct {
+    uint64_t caller;          /* Return address of the call; 0 collects the
+                                 sites that did not fit in the table */
+    uint64_t calls;
+    uint64_t cycles;          /* Cycle counter ticks spent in the calls */
+    uint64_t max_cycles;      /* Slowest single call */
+    uint64_t module_offset;   /* caller relative to its module, for addr2line */
+    uint32_t call;            /* sg_call_t */
+    uint32_t symbol_offset;   /* caller - symbol */
+    char symbol[SG_CALLER_NAME_MAX];  /* Calling function, "" if unknown */
+    char module[SG_CALLER_NAME_MAX];  /* File name of the calling module */
+} sg_caller_stats_t;
+
+/* ============================================
+ * Watchpoints
+ * ============================================ */
+
+#define SG_WATCH_MAX        4     /* x86-64 and most ARM64 cores have 4 debug registers */
+
+typedef enum {
+    SG_WATCH_WRITE = 1,      /* Any store into the range */
+    SG_WATCH_EXEC = 2        /* Execution of the instruction at addr */
+} sg_watch_type_t;
+
+/* How a watch is enforced, best first */
+typedef enum {
+    SG_WATCH_HASH = 0,       /* Digest compared by SG_CHECK_WATCH; sees changed bytes
+                                only, neither writes of the same value nor execution */
+    SG_WATCH_COUNTER = 1,    /* Hardware breakpoint counted, read by SG_CHECK_WATCH */
+    SG_WATCH_SIGNAL = 2      /* Hardware breakpoint raising COMPROMISED on the
+                                faulting instruction (Linux 5.13+) */
+} sg_watch_mode_t;
+
+typedef struct {
+    uint32_t mode;           /* sg_watch_mode_t */
+    uint32_t type;           /* sg_watch_type_t */
+    uint64_t hits;           /* Writes or executions seen so far */
+} sg_watch_info_t;
+
+/* ============================================
+ * Background Monitor
+ * ============================================ */
+
+#define SG_SLO_BUCKETS      16    /* Staleness histogram, eighths of the SLO */
+#define SG_STATS_MAX_UNITS  64
+
+/* One scheduled unit: a memory region (main image or a module) or a detector */
+typedef struct {
+    uint32_t detector;          /* sg_detector_t */
+    uint32_t granule;           /* SG_DETECTOR_MEMORY: bytes per digest, else 0 */
+    uint64_t region_addr;       /* SG_DETECTOR_MEMORY: region verified, else 0 */
+    uint64_t region_len;
+    uint64_t slo_ns;            /* Declared maximum staleness */
+    uint64_t staleness_ns;      /* Since the last complete pass started (or the
+                                   unit was scheduled, before the first one) */
+    uint64_t max_staleness_ns;  /* Worst staleness a completing pass ended */
+    uint64_t passes;            /* Complete passes */
+    uint64_t misses;            /* Passes that ended staleness above slo_ns */
+    uint64_t busy_ns;           /* Monitor time spent on this unit */
+    uint32_t histogram[SG_SLO_BUCKETS]; /* Staleness ended by each pass; bucket k
+                                           is [k/8, (k+1)/8) of slo_ns, the last
+                                           one open-ended */
+} sg_slo_stats_t;
+
+typedef struct {
+    uint32_t monitor_running;
+    uint32_t unit_count;        /* Units scheduled; the first SG_STATS_MAX_UNITS
+                                   are reported */
+    uint64_t wakeups;           /* Times the monitor slept and woke */
+    uint64_t slices;            /* Bounded slices run */
+    uint64_t busy_ns;           /* Monitor time spent in slices */
+    uint64_t heartbeats;        /* Liveness deadlines published */
+    uint64_t stalls;            /* Times the monitor found its deadline passed */
+    sg_slo_stats_t units[SG_STATS_MAX_UNITS];
+} sg_stats_t;
+
+/* ============================================
+ * Kernel Autotuning
+ * ============================================ */
+
+#define SG_TUNING_NAME_MAX      16
+#define SG_TUNING_MAX_KERNELS   8
+
+/* Where the active tuning came from */
+typedef enum {
+    SG_TUNING_DEFAULT = 0,   /* Built-in kernel and slice size */
+    SG_TUNING_FROM_FILE = 1, /* Loaded from SG_TUNING_FILE by sg_init */
+    SG_TUNING_FROM_AUTOTUNE = 2
+} sg_tuning_source_t;
+
+typedef struct {
+    char name[SG_TUNING_NAME_MAX];
+    uint32_t matches_reference;  /* 0: digests differ, kernel rejected */
+    uint32_t reserved;
+    uint64_t ns_per_kib;         /* Best measured cost, 0 if rejected */
+} sg_tuning_candidate_t;
+
+typedef struct {
+    char kernel[SG_TUNING_NAME_MAX]; /* Active checksum kernel */
+    uint64_t slice_pages;            /* Applied SG_OPT_SLICE_PAGES, 0 if default */
+    uint64_t ns_per_kib;             /* Measured cost of the active kernel */
+    uint32_t source;                 /* sg_tuning_source_t */
+    uint32_t candidate_count;        /* Filled by sg_autotune only */
+    sg_tuning_candidate_t candidates[SG_TUNING_MAX_KERNELS];
+} sg_tuning_info_t;
+
+/* ============================================
+ * Pre-load File Verification
+ * ============================================ */
+
+#define SG_VERIFY_DIGEST_SIZE   32   /* SHA-256, as printed by sha256sum */
+
+typedef enum {
+    SG_VERIFY_MATCH = 0,     /* File digest equals the expected one */
+    SG_VERIFY_PENDING = 1,   /* Still streaming (sg_verify_poll) */
+    SG_VERIFY_MISMATCH = 2,  /* Digest differs; do not load the file */
+    SG_VERIFY_ERROR = 3      /* File could not be read completely */
+} sg_verify_status_t;
+
+/* In-flight verification started by sg_verify_file_async */
+typedef struct sg_verify_op sg_verify_op_t;
+
 /* ============================================
  * Public API Functions
  * ============================================ */
@@ -61,7 +361,7 @@ typedef enum {
  * Returns: SG_OK on success, error code otherwise
  * Side effects: Allocates internal state, takes memory snapshot
  */
-sg_result_t sg_init(void);
+SG_API sg_result_t sg_init(void);
 
 /*
  * Take a snapshot of current process state
@@ -70,7 +370,7 @@ sg_result_t sg_init(void);
  * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized
  * Side effects: Updates internal baseline checksums
  */
-sg_result_t sg_snapshot(void);
+SG_API sg_result_t sg_snapshot(void);
 
 /*
  * Perform comprehensive integrity check
@@ -81,7 +381,20 @@ sg_result_t sg_snapshot(void);
  * Returns: SG_OK if all checks pass, error code on failure
  * Side effects: May update security state to WARNING/COMPROMISED
  */
-sg_result_t sg_check_integrity(uint32_t flags);
+SG_API sg_result_t sg_check_integrity(uint32_t flags);
+
+/*
+ * Integrity check with per-detector outcome and cost
+ * Same checks as sg_check_integrity; never allocates.
+ *
+ * Parameters:
+ *   flags - Bitmask of SG_CHECK_* values
+ *   out   - Caller-provided result, fully overwritten
+ *
+ * Returns: SG_OK if the checks ran, error code on failure
+ * Side effects: May update security state to WARNING/COMPROMISED
+ */
+SG_API sg_result_t sg_check_integrity_ex(uint32_t flags, sg_check_result_t* out);
 
 /*
  * Fast debugger detection check
@@ -89,15 +402,346 @@ sg_result_t sg_check_integrity(uint32_t flags);
  *
  * Returns: 1 if debugger detected, 0 otherwise, -1 on error
  */
-int sg_detect_debugger(void);
+SG_API int sg_detect_debugger(void);
 
 /*
  * Get current security state
  *
+ * While the background monitor runs, SG_SAFE is reported as
+ * SG_WARNING once it has not beaten for SG_OPT_MONITOR_STALL_MS, e.g.
+ * because its thread was stopped or ptrace-attached.
+ *
  * Returns: Current state (SG_SAFE, SG_WARNING, SG_COMPROMISED)
  *          Returns SG_COMPROMISED if not initialized
  */
-sg_security_state_t sg_get_security_state(void);
+SG_API sg_security_state_t sg_get_security_state(void);
+
+/*
+ * Freshness-bounded security state
+ * Intended for request handlers: returns the published state without
+ * taking a lock while every detector named in flags has completed a
+ * verification within max_age_ns. Freshness is tracked per detector,
+ * so checks of other detectors never make these ones fresh. When
+ * stale, runs one bounded slice of the requested checks
+ * (SG_OPT_SLICE_PAGES system pages' worth of the memory sweep) before
+ * returning; SG_CHECK_MEMORY becomes fresh again once a sweep completes.
+ * The published state follows the same monitor stall rule as
+ * sg_get_security_state.
+ *
+ * Parameters:
+ *   max_age_ns - Maximum acceptable age of each requested detector
+ *   flags      - SG_CHECK_* detectors that must be fresh (and run when stale)
+ *
+ * Returns: Current state; SG_COMPROMISED if not initialized
+ */
+SG_API sg_security_state_t sg_require_fresh(uint64_t max_age_ns, uint32_t flags);
+
+/*
+ * Get the published state together with its generation and age
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized
+ */
+SG_API sg_result_t sg_get_state_info(sg_state_info_t* out);
+
+/*
+ * Set a runtime option (may be called before sg_init)
+ *
+ * Returns: SG_OK on success, SG_ERR_INTERNAL for unknown options or
+ *          out-of-range values
+ */
+SG_API sg_result_t sg_set_option(sg_option_t option, uint64_t value);
+
+/*
+ * Describe the last page restored by SG_OPT_SELF_HEAL
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized
+ */
+SG_API sg_result_t sg_get_repair_info(sg_repair_info_t* out);
+
+/*
+ * Vouch for the calling thread (SG_CHECK_THREADS)
+ * Threads alive at sg_snapshot are known. A thread started later is
+ * inspected once: where it is stopped and the return addresses at the
+ * top of its stack must all be code the snapshot accounts for. Code
+ * the snapshot does not account for is rated as SG_CHECK_MAPS rates
+ * its mapping: anonymous memory is SUSPICIOUS, a file or memfd
+ * TAMPERED. A thread found running on a CPU by 8 checks in a row is
+ * SUSPICIOUS as well. Call this first thing in a thread whose code
+ * lives in JIT memory or that never blocks.
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized
+ */
+SG_API sg_result_t sg_register_thread(void);
+
+/*
+ * Watch a critical variable or code byte
+ * Arms a hardware breakpoint on every thread (and the threads they
+ * start) through perf_event_open: a write to the range, or execution
+ * of addr, then raises COMPROMISED from the SIGTRAP it delivers, at
+ * no cost until it fires. Where that is not permitted, or the range
+ * is not 1, 2, 4 or 8 aligned bytes, the watch degrades to a counting
+ * breakpoint or a digest, both checked by SG_CHECK_WATCH (see
+ * sg_watch_mode_t and sg_watch_info). Other SIGTRAPs are passed on to
+ * the handler installed before.
+ *
+ * Every write counts, the application's own included: a watched
+ * SG_WATCH_WRITE range must be one nothing legitimately stores to
+ * after sg_watch, or that store publishes COMPROMISED straight from
+ * the SIGTRAP handler (or at the next SG_CHECK_WATCH in the other
+ * modes). Unwatch the range around intended updates. Threads started
+ * while the watch is armed are covered; arming re-lists the threads
+ * until no new one appears.
+ *
+ * Parameters:
+ *   addr - Start of the range; identifies the watch
+ *   len  - Bytes to watch (ignored for SG_WATCH_EXEC)
+ *   type - SG_WATCH_WRITE or SG_WATCH_EXEC
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized,
+ *          SG_ERR_INTERNAL if SG_WATCH_MAX watches are armed or addr
+ *          is already watched
+ */
+SG_API sg_result_t sg_watch(const void* addr, size_t len, sg_watch_type_t type);
+
+/*
+ * Disarm the watch starting at addr
+ *
+ * Returns: SG_OK on success, SG_ERR_INTERNAL if addr is not watched
+ */
+SG_API sg_result_t sg_unwatch(const void* addr);
+
+/*
+ * Report how the watch at addr is enforced and how often it fired
+ *
+ * Returns: SG_OK on success, SG_ERR_INTERNAL if addr is not watched
+ */
+SG_API sg_result_t sg_watch_info(const void* addr, sg_watch_info_t* out);
+
+/*
+ * Declare how stale a detector's verdict may get (see sg_monitor_start)
+ * For SG_DETECTOR_MEMORY this applies to the main image and, with
+ * SG_OPT_MODULES, to each shared library separately, unless
+ * sg_set_region_slo overrides it.
+ *
+ * Parameters:
+ *   detector           - Detector to schedule
+ *   max_staleness_ns   - Longest acceptable time between the start of
+ *                        two complete passes, or 0 to stop scheduling it
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized,
+ *          SG_ERR_INTERNAL for an unknown detector
+ */
+SG_API sg_result_t sg_set_slo(sg_detector_t detector, uint64_t max_staleness_ns);
+
+/*
+ * Override the memory SLO for the region (main image or module text)
+ * containing addr; 0 returns it to the SG_DETECTOR_MEMORY SLO
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized,
+ *          SG_ERR_INTERNAL if no region of the snapshot contains addr
+ */
+SG_API sg_result_t sg_set_region_slo(const void* addr, uint64_t max_staleness_ns);
+
+/*
+ * Override SG_OPT_GRANULE for the region (main image or module text)
+ * containing addr, from the next sg_snapshot; 0 returns it to the
+ * option. Coarse granules shrink the digest table and the per-block
+ * overhead of every pass; fine ones bound the bytes a slice or a
+ * self-healing repair must cover.
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized,
+ *          SG_ERR_INTERNAL if no region of the snapshot contains addr
+ *          or bytes is not a valid granule
+ */
+SG_API sg_result_t sg_set_region_granule(const void* addr, size_t bytes);
+
+/*
+ * Start the background monitor thread
+ * Every region and detector with an SLO becomes a unit kept on a
+ * hierarchical timer wheel. A unit is woken as late as its measured
+ * pass time allows, and ready units run in bounded slices earliest
+ * deadline first, so each is verified about once per SLO and the
+ * state mutex is never held for long. Findings are published as by
+ * sg_check_integrity; once every unit of a detector has completed a
+ * pass, that detector's age for sg_require_fresh is that of its
+ * stalest unit (for SG_DETECTOR_MEMORY also the age reported by
+ * sg_get_state_info). The thread registers itself for
+ * SG_CHECK_THREADS.
+ *
+ * The monitor also publishes a heartbeat deadline that
+ * sg_get_security_state checks (SG_OPT_MONITOR_STALL_MS). The monitor
+ * cannot beat while an API call holds the state mutex, so keep the
+ * threshold above the longest sg_snapshot or full check. A forked
+ * child has no monitor and reads as SG_WARNING once it expires.
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized,
+ *          SG_ERR_ALREADY_INIT if running, SG_ERR_INTERNAL if the
+ *          thread cannot be started
+ */
+SG_API sg_result_t sg_monitor_start(void);
+
+/*
+ * Stop the background monitor and wait for it; sg_shutdown does this too
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if it is not running
+ */
+SG_API sg_result_t sg_monitor_stop(void);
+
+/*
+ * Report per-unit staleness histograms and SLO misses
+ * Statistics survive sg_set_slo, sg_snapshot and monitor restarts
+ * for units that are still scheduled.
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not initialized
+ */
+SG_API sg_result_t sg_get_stats(sg_stats_t* out);
+
+/*
+ * Report what each call site has spent in the library
+ * With SG_OPT_CALLER_STATS, sg_check_integrity, sg_check_integrity_ex,
+ * sg_require_fresh and sg_detect_debugger add their duration to a
+ * lock-free table keyed by return address (512 sites). Sites are
+ * resolved here, not when recorded: the function comes from the
+ * module's symbol table, so static functions are named unless the
+ * file is stripped. Move the costliest sites to sg_require_fresh or
+ * to the background monitor.
+ *
+ * Parameters:
+ *   out - Receives the costliest sites first
+ *   max - Capacity of out
+ *
+ * Returns: Number of sites recorded (may exceed max)
+ */
+SG_API size_t sg_get_callers(sg_caller_stats_t* out, size_t max);
+
+/*
+ * Share shared-library baselines between processes (SG_OPT_MODULES)
+ * Page digests are stored per module in dir, keyed by build-id, file
+ * size, mtime and inode, so only modules no process on the host has
+ * baselined yet are hashed. sg_init also reads the SG_BASELINE_CACHE
+ * environment variable. The directory must be owned by root or the
+ * current user and not writable by group or others.
+ *
+ * Parameters:
+ *   dir - Cache directory, or NULL to disable
+ *
+ * Returns: SG_OK on success, SG_ERR_INTERNAL if dir is unsuitable
+ */
+SG_API sg_result_t sg_set_baseline_cache(const char* dir);
+
+/*
+ * Load a compiled signature set (see sg-sigc and self_guard_signatures.h)
+ * SG_CHECK_SIGNATURES then scans readable executable mappings with no
+ * backing file (JIT output, injected shellcode) for any signature; a
+ * hit is COMPROMISED and is journaled with the signature id. Sliced
+ * checks resume the scan where the last one stopped. Replaces any set
+ * loaded before and may be called before sg_init.
+ *
+ * Parameters:
+ *   path - Signature set file, or NULL to unload
+ *
+ * Returns: SG_OK on success, SG_ERR_INTERNAL if the file cannot be
+ *          read or fails validation (the previous set stays loaded)
+ */
+SG_API sg_result_t sg_load_signatures(const char* path);
+
+/*
+ * Benchmark the built-in checksum kernels on this host
+ * Every kernel is first checked to produce digests identical to the
+ * reference; the fastest valid one becomes active and the
+ * require_fresh slice is sized to ~100 us. With a path, the result
+ * is also written there; sg_init applies it when the SG_TUNING_FILE
+ * environment variable names the file, it was produced on the same
+ * CPU model by the same library build, and it is a regular file owned
+ * by root or the caller and writable by no one else. Takes tens of ms; run it
+ * at install or deploy time, not on a hot path.
+ *
+ * Parameters:
+ *   path - Tuning file to write, or NULL
+ *   out  - Optional measurements and choice
+ *
+ * Returns: SG_OK on success, SG_ERR_INTERNAL if no kernel is valid
+ *          or the file cannot be written
+ */
+SG_API sg_result_t sg_autotune(const char* path, sg_tuning_info_t* out);
+
+/*
+ * Report the active kernel and slice size and where they came from
+ *
+ * Returns: SG_OK on success
+ */
+SG_API sg_result_t sg_get_tuning(sg_tuning_info_t* out);
+
+/*
+ * Verify a file (typically a plugin) before it is dlopen'ed
+ * The file is streamed in 1 MiB page-aligned chunks, through io_uring
+ * where the kernel allows it and pread otherwise, and hashed as the
+ * chunks arrive. When it matches, the page digests of its executable
+ * segment are kept: once loaded, SG_OPT_MODULES baselines it from
+ * them instead of rehashing its text. Does not need sg_init.
+ *
+ * A MATCH vouches for the inode that was open while it was hashed,
+ * not for whatever path names later: a file renamed over it before
+ * dlopen(path) is loaded unverified. To load exactly what was hashed,
+ * verify with sg_verify_file_async, take the descriptor with
+ * sg_verify_take_fd and dlopen "/proc/self/fd/<fd>". A file written
+ * while it was streamed is a MISMATCH. Retained digests are only used
+ * for a module whose mapping is backed by the verified inode.
+ *
+ * Parameters:
+ *   path     - File to verify
+ *   expected - SHA-256 of the file, e.g. from a signed manifest
+ *
+ * Returns: SG_VERIFY_MATCH, SG_VERIFY_MISMATCH or SG_VERIFY_ERROR
+ */
+SG_API sg_verify_status_t sg_verify_file(const char* path,
+                                         const uint8_t expected[SG_VERIFY_DIGEST_SIZE]);
+
+/*
+ * Start verifying a file without blocking
+ * Drive the operation with sg_verify_poll, for instance when
+ * sg_verify_fd becomes readable, then free it with sg_verify_release.
+ * An operation must not be used from several threads at once.
+ *
+ * Returns: SG_OK on success, SG_ERR_INTERNAL if the file cannot be
+ *          opened or the read buffers cannot be allocated
+ */
+SG_API sg_result_t sg_verify_file_async(const char* path,
+                                        const uint8_t expected[SG_VERIFY_DIGEST_SIZE],
+                                        sg_verify_op_t** op);
+
+/*
+ * Hash the chunks that have arrived and queue the next reads
+ * Without wait, a call hashes at most 4 MiB (1 MiB with the pread
+ * fallback) and never blocks on I/O; with wait it runs to the end.
+ *
+ * Returns: SG_VERIFY_PENDING until the whole file has been hashed,
+ *          then the final status
+ */
+SG_API sg_verify_status_t sg_verify_poll(sg_verify_op_t* op, int wait);
+
+/*
+ * Descriptor that becomes readable when reads complete
+ *
+ * Returns: The io_uring descriptor, or -1 with the pread fallback
+ *          (poll again from the event loop's idle hook)
+ */
+SG_API int sg_verify_fd(const sg_verify_op_t* op);
+
+/*
+ * Keep the descriptor of a verified file
+ * After SG_VERIFY_MATCH, transfers the read-only descriptor the file
+ * was hashed through to the caller, who must close it (after dlopen).
+ *
+ * Returns: The descriptor, or -1 unless the operation matched (or if
+ *          the descriptor was already taken)
+ */
+SG_API int sg_verify_take_fd(sg_verify_op_t* op);
+
+/*
+ * Cancel or finish an operation and free it
+ */
+SG_API void sg_verify_release(sg_verify_op_t* op);
 
 /*
  * Shutdown library and cleanup resources
@@ -106,7 +750,67 @@ sg_security_state_t sg_get_security_state(void);
  * Returns: SG_OK on success
  * Side effects: Invalidates all internal state
  */
-sg_result_t sg_shutdown(void);
+SG_API sg_result_t sg_shutdown(void);
+
+/* ============================================
+ * Forensic Journal (optional)
+ * ============================================ */
+
+/*
+ * Attach an append-only journal file
+ * Detection events, baseline regions and timing data are written
+ * as fixed-size records (see self_guard_journal.h) to a MAP_SHARED
+ * mapping, so they survive the process being killed.
+ * May be called before sg_init.
+ *
+ * Parameters:
+ *   path     - Journal file; created if missing, an existing journal
+ *              of the same capacity is appended to. Symlinks are not
+ *              followed, and any other existing file is left untouched
+ *   capacity - Number of 64-byte record slots
+ *
+ * Returns: SG_OK on success, SG_ERR_ALREADY_INIT if a journal is
+ *          attached, SG_ERR_INIT if the file cannot be mapped or is
+ *          not a journal of this capacity
+ */
+SG_API sg_result_t sg_journal_open(const char* path, uint64_t capacity);
+
+/*
+ * Detach the journal and unmap the file
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if no journal is attached
+ */
+SG_API sg_result_t sg_journal_close(void);
+
+/* ============================================
+ * Local Attestation (optional)
+ * ============================================ */
+
+/*
+ * Publish this process's state to the local sg-attestd daemon
+ * State, generation, verification age, monitor heartbeat and the
+ * baseline's Merkle roots are mirrored into a shared segment (see
+ * self_guard_attest.h) as they change, so sidecars can ask the
+ * daemon instead of every process exposing an endpoint. A state
+ * change costs one extra store; nothing is sent per query.
+ * May be called before sg_init. A forked child is not registered;
+ * after a daemon restart, detach and attach again.
+ *
+ * Parameters:
+ *   socket_path - Daemon socket; NULL uses $SG_ATTEST_SOCKET or
+ *                 SG_ATTEST_DEFAULT_SOCKET
+ *
+ * Returns: SG_OK on success, SG_ERR_ALREADY_INIT if attached,
+ *          SG_ERR_INIT if the daemon cannot be reached or refused
+ */
+SG_API sg_result_t sg_attest_attach(const char* socket_path);
+
+/*
+ * Unregister from sg-attestd and unmap the segment
+ *
+ * Returns: SG_OK on success, SG_ERR_NOT_INIT if not attached
+ */
+SG_API sg_result_t sg_attest_detach(void);
 
 #ifdef __cplusplus
 }
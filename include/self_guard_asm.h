@@ -18,6 +18,27 @@
 extern "C" {
 #endif
 
+/* ============================================
+ * Symbol Visibility
+ *
+ * The library is compiled with -fvisibility=hidden; only SG_API
+ * symbols are exported. In the shared library they are protected,
+ * so calls from inside the library bind locally instead of going
+ * through the PLT.
+ * ============================================ */
+
+#ifndef SG_API
+#if defined(_WIN32) || defined(__CYGWIN__)
+#define SG_API
+#elif defined(SG_BUILD_SHARED) && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define SG_API __attribute__((visibility("protected")))
+#elif defined(__GNUC__) || defined(__clang__)
+#define SG_API __attribute__((visibility("default")))
+#else
+#define SG_API
+#endif
+#endif
+
 /* ============================================
  * Unified Low-Level API
  * 
@@ -38,7 +59,7 @@ extern "C" {
  * Security note: Used for timing attack detection.
  * Single-stepping causes observable timing deltas.
  */
-uint64_t sg_get_cycle_counter(void);
+SG_API uint64_t sg_get_cycle_counter(void);
 
 /**
  * Perform low-level security checks
@@ -53,7 +74,7 @@ uint64_t sg_get_cycle_counter(void);
  *   1 = Threat detected (debugger, tampering)
  *  -1 = Check unavailable on this platform
  */
-int sg_low_level_check(void);
+SG_API int sg_low_level_check(void);
 
 /**
  * Timing-based anomaly detection
@@ -65,7 +86,7 @@ int sg_low_level_check(void);
  *   0 = Normal timing
  *   1 = Timing anomaly detected
  */
-int sg_timing_check(void);
+SG_API int sg_timing_check(void);
 
 /**
  * Calculate checksum of memory region
@@ -78,7 +99,7 @@ int sg_timing_check(void);
  * 
  * Algorithm: XOR-based rolling checksum (fast, deterministic)
  */
-uint32_t sg_checksum_memory(const void* start, size_t length);
+SG_API uint32_t sg_checksum_memory(const void* start, size_t length);
 
 /**
  * Get implementation information
@@ -88,7 +109,7 @@ uint32_t sg_checksum_memory(const void* start, size_t length);
  * - "arm64-native"
  * - "c-fallback"
  */
-const char* sg_get_implementation(void);
+SG_API const char* sg_get_implementation(void);
 
 #ifdef __cplusplus
 }
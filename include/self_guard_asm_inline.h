@@ -0,0 +1,158 @@
+/*
+ * Self-Guard Low-Level Detection API (inline)
+ * Header-only equivalents of the primitives in src/asm/
+ *
+ * Design Philosophy:
+ * - Same semantics as the exported functions in self_guard_asm.h
+ * - GNU inline asm with exact clobbers, so the compiler keeps
+ *   unrelated values in registers instead of spilling around a call
+ * - The .S exports remain the ABI-stable entry points; these are for
+ *   hot callers that can afford to be recompiled with the library
+ * - Falls back to calling the exports when inline asm is unavailable
+ */
+
+#ifndef SELF_GUARD_ASM_INLINE_H
+#define SELF_GUARD_ASM_INLINE_H
+
+#include <stdint.h>
+#include "self_guard_asm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__aarch64__) || defined(__arm64__)) && \
+    !defined(SG_NO_INLINE_ASM) && !defined(SG_PORTABLE_BACKEND)
+#define SG_HAVE_INLINE_ASM 1
+#else
+#define SG_HAVE_INLINE_ASM 0
+#endif
+
+/* Same threshold as the .S timing checks */
+#define SG_TIMING_THRESHOLD_CYCLES 1000u
+
+#if SG_HAVE_INLINE_ASM && defined(__x86_64__)
+
+/* ============================================
+ * x86_64
+ * ============================================ */
+
+/* CPUID-serialized RDTSC, as sg_get_cycle_counter */
+static inline uint64_t sg_get_cycle_counter_inline(void) {
+    uint32_t lo, hi;
+    __asm__ __volatile__(
+        "xor %%eax, %%eax\n\t"
+        "cpuid\n\t"
+        "rdtsc"
+        : "=a"(lo), "=d"(hi)
+        :
+        : "rbx", "rcx", "memory");
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/* RDTSC around a 10-NOP sled, as sg_timing_check */
+static inline int sg_timing_check_inline(void) {
+    uint32_t lo0, hi0, lo1, hi1;
+    __asm__ __volatile__(
+        "rdtsc\n\t"
+        "mov %%eax, %0\n\t"
+        "mov %%edx, %1\n\t"
+        ".rept 10\n\t"
+        "nop\n\t"
+        ".endr\n\t"
+        "rdtsc"
+        : "=&r"(lo0), "=&r"(hi0), "=a"(lo1), "=d"(hi1)
+        :
+        : "memory");
+    uint64_t t0 = ((uint64_t)hi0 << 32) | lo0;
+    uint64_t t1 = ((uint64_t)hi1 << 32) | lo1;
+    return (t1 - t0 > SG_TIMING_THRESHOLD_CYCLES) ? 1 : 0;
+}
+
+/*
+ * Debug register inspection, as sg_low_level_check
+ *
+ * WARNING: MOV from DRn is privileged. Like the .S export, this
+ * raises #GP (SIGSEGV) at CPL3 unless the platform virtualizes the
+ * access; callers must probe before relying on it.
+ */
+static inline int sg_low_level_check_inline(void) {
+#if defined(__linux__)
+    uint64_t dr0, dr1, dr2, dr3, dr7;
+    __asm__ __volatile__("mov %%dr0, %0" : "=r"(dr0));
+    __asm__ __volatile__("mov %%dr1, %0" : "=r"(dr1));
+    __asm__ __volatile__("mov %%dr2, %0" : "=r"(dr2));
+    __asm__ __volatile__("mov %%dr3, %0" : "=r"(dr3));
+    __asm__ __volatile__("mov %%dr7, %0" : "=r"(dr7));
+    return (dr0 | dr1 | dr2 | dr3 | (dr7 & 0xFF)) != 0 ? 1 : 0;
+#else
+    return 0;
+#endif
+}
+
+#elif SG_HAVE_INLINE_ASM
+
+/* ============================================
+ * ARM64
+ * ============================================ */
+
+/* CNTVCT_EL0 followed by ISB, as sg_get_cycle_counter */
+static inline uint64_t sg_get_cycle_counter_inline(void) {
+    uint64_t value;
+    __asm__ __volatile__(
+        "mrs %0, cntvct_el0\n\t"
+        "isb"
+        : "=r"(value)
+        :
+        : "memory");
+    return value;
+}
+
+/* CNTVCT_EL0 around a 10-NOP sled, as sg_timing_check */
+static inline int sg_timing_check_inline(void) {
+    uint64_t t0, t1;
+    __asm__ __volatile__(
+        "mrs %0, cntvct_el0\n\t"
+        "isb\n\t"
+        ".rept 10\n\t"
+        "nop\n\t"
+        ".endr\n\t"
+        "mrs %1, cntvct_el0\n\t"
+        "isb"
+        : "=&r"(t0), "=r"(t1)
+        :
+        : "memory");
+    return (t1 - t0 > SG_TIMING_THRESHOLD_CYCLES) ? 1 : 0;
+}
+
+/* Debug registers are EL1-only; as the .S export, nothing to inspect */
+static inline int sg_low_level_check_inline(void) {
+    return 0;
+}
+
+#else
+
+/* ============================================
+ * Fallback: call the exported implementations
+ * ============================================ */
+
+static inline uint64_t sg_get_cycle_counter_inline(void) {
+    return sg_get_cycle_counter();
+}
+
+static inline int sg_timing_check_inline(void) {
+    return sg_timing_check();
+}
+
+static inline int sg_low_level_check_inline(void) {
+    return sg_low_level_check();
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SELF_GUARD_ASM_INLINE_H */
@@ -0,0 +1,175 @@
+/*
+ * Self-Guard Local Attestation Protocol
+ * Shared by the library, the sg-attestd daemon and its client library
+ *
+ * Design Philosophy:
+ * - Processes push, sidecars pull: a guarded process publishes its
+ *   state into a shared-memory segment as it changes, and sg-attestd
+ *   answers queries from those cached values. A query never triggers
+ *   a scan and never touches the queried process.
+ * - One atomic store per state change on the publishing side; the
+ *   daemon reads the segment read-only.
+ * - Liveness is tied to a connection: the daemon drops a process
+ *   when its registration socket closes (exit, exec, sg_attest_detach).
+ *
+ * Transport:
+ *   SOCK_SEQPACKET Unix socket, SG_ATTEST_DEFAULT_SOCKET unless
+ *   SG_ATTEST_SOCKET is set in the environment. Every message starts
+ *   with sg_attest_msg_t followed by `count` payload entries.
+ *
+ *   REGISTER  process -> daemon, the segment memfd in SCM_RIGHTS;
+ *             the daemon binds it to the peer pid (SO_PEERCRED)
+ *   QUERY     client -> daemon, `count` uint32_t pids (0 = every
+ *             registered process); replied with sg_attest_record_t
+ *             batches of at most SG_ATTEST_MAX_BATCH, all but the
+ *             last flagged SG_ATTEST_F_MORE
+ *   REGIONS   client -> daemon, one pid; replied with its
+ *             sg_attest_region_t entries
+ *
+ * Segment Layout:
+ *   [sg_attest_segment_t], sealed against shrinking
+ */
+
+#ifndef SELF_GUARD_ATTEST_H
+#define SELF_GUARD_ATTEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SG_ATTEST_MAGIC           0x5453455454414753ULL  /* "SGATTEST" little-endian */
+#define SG_ATTEST_VERSION         1u
+#define SG_ATTEST_DEFAULT_SOCKET  "/run/sg-attestd.sock"
+#define SG_ATTEST_SOCKET_ENV      "SG_ATTEST_SOCKET"
+
+#define SG_ATTEST_MAX_REGIONS     64    /* Region roots kept in a segment */
+#define SG_ATTEST_MAX_BATCH       256   /* Pids per query, records per reply packet */
+#define SG_ATTEST_ROOT_SIZE       32    /* SHA-256 */
+
+/* ============================================
+ * Published State Word
+ *
+ * Same packing as the library's internal word:
+ *   [63:24] last complete verification, CLOCK_MONOTONIC in 2^16 ns
+ *           units (0 = never)
+ *   [23:4]  check generation (wraps at 2^20)
+ *   [3:0]   sg_security_state_t
+ * ============================================ */
+
+#define SG_ATTEST_WORD_STATE(w)       ((uint32_t)((w) & 0xFu))
+#define SG_ATTEST_WORD_GENERATION(w)  ((uint32_t)(((w) >> 4) & 0xFFFFFu))
+#define SG_ATTEST_WORD_TIME(w)        ((w) >> 24)
+#define SG_ATTEST_TIME_UNIT_SHIFT     16
+#define SG_ATTEST_TIME_MASK           ((1ULL << 40) - 1)
+
+/* Region hash that is not an sg_hash_t: the root is the fs-verity digest */
+#define SG_ATTEST_HASH_FSVERITY       0x100u
+
+/* ============================================
+ * Region Root (one cache line)
+ *
+ * `root` is SHA-256 over le32 hash, le32 granule, le64 len and the
+ * region's block digest table, or the fs-verity file digest. Roots
+ * are comparable across processes except under SG_HASH_SIPHASH,
+ * whose key is drawn per process.
+ * ============================================ */
+
+typedef struct {
+    uint64_t addr;           /* Region start in the publishing process */
+    uint64_t len;
+    uint32_t granule;        /* Bytes per digest block */
+    uint32_t hash;           /* sg_hash_t or SG_ATTEST_HASH_FSVERITY */
+    uint8_t  reserved[8];
+    uint8_t  root[SG_ATTEST_ROOT_SIZE];
+} sg_attest_region_t;
+
+/* ============================================
+ * Shared Segment
+ *
+ * `state_word` and `heartbeat_ns` are single atomic stores by the
+ * process. The roots block (`root`, `region_*`, `regions`) is
+ * rewritten on every snapshot under the `roots_seq` seqlock: odd
+ * while a write is in progress, readers retry when it moved.
+ * ============================================ */
+
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t size;                /* sizeof(sg_attest_segment_t) */
+    uint64_t state_word;          /* Packed as above (atomic) */
+    uint64_t heartbeat_ns;        /* Monitor deadline, CLOCK_MONOTONIC_COARSE; 0 = not enforced */
+    uint32_t roots_seq;
+    uint32_t region_count;        /* Entries in regions[] */
+    uint32_t region_total;        /* Regions folded into root (may exceed region_count) */
+    uint32_t reserved;
+    uint8_t  root[SG_ATTEST_ROOT_SIZE]; /* SHA-256 over every region root; zero before a snapshot */
+    sg_attest_region_t regions[SG_ATTEST_MAX_REGIONS];
+} sg_attest_segment_t;
+
+/* ============================================
+ * Messages
+ * ============================================ */
+
+typedef enum {
+    SG_ATTEST_MSG_REGISTER = 1,
+    SG_ATTEST_MSG_QUERY    = 2,
+    SG_ATTEST_MSG_REGIONS  = 3,
+    SG_ATTEST_MSG_REPLY    = 0x80   /* Or'ed into the request type */
+} sg_attest_msg_type_t;
+
+#define SG_ATTEST_F_MORE  0x1u      /* More reply packets follow for this tag */
+
+typedef struct {
+    uint16_t type;           /* sg_attest_msg_type_t */
+    uint16_t flags;          /* SG_ATTEST_F_* */
+    uint32_t tag;            /* Chosen by the requester, echoed in replies */
+    uint32_t count;          /* Payload entries after the header */
+    uint32_t status;         /* Replies: 0 or an errno value */
+} sg_attest_msg_t;
+
+/* Record flags */
+#define SG_ATTEST_R_UNKNOWN   0x1u  /* Pid not registered; other fields zero */
+#define SG_ATTEST_R_STALLED   0x2u  /* Monitor missed its heartbeat: SAFE reported as WARNING */
+#define SG_ATTEST_R_NO_ROOTS  0x4u  /* No snapshot published yet */
+
+/* One process, as the daemon last saw it (one cache line) */
+typedef struct {
+    uint32_t pid;
+    uint32_t state;          /* sg_security_state_t after the heartbeat check */
+    uint32_t generation;
+    uint32_t flags;          /* SG_ATTEST_R_* */
+    uint64_t age_ns;         /* Since the last complete verification, UINT64_MAX = never */
+    uint32_t region_total;
+    uint32_t reserved;
+    uint8_t  root[SG_ATTEST_ROOT_SIZE];
+} sg_attest_record_t;
+
+/* ============================================
+ * Client Library (libsg_attest)
+ *
+ * Blocking calls on a connected socket, one request in flight per
+ * socket. Return -1 and set errno on failure.
+ * ============================================ */
+
+/* Connect to socket_path (NULL = environment or default); returns the socket */
+int sg_attest_connect(const char* socket_path);
+
+/*
+ * Query count pids (count 0 = every registered process). Writes at
+ * most max records to out and returns how many the daemon sent, which
+ * may exceed max; the surplus is discarded.
+ */
+int sg_attest_query(int sock, const uint32_t* pids, size_t count,
+                    sg_attest_record_t* out, size_t max);
+
+/* Region roots of pid; returns the number of entries written (<= max) */
+int sg_attest_regions(int sock, uint32_t pid, sg_attest_region_t* out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SELF_GUARD_ATTEST_H */
@@ -0,0 +1,87 @@
+/*
+ * Self-Guard Forensic Journal Format
+ * On-disk layout shared by the library and the sg-journal reader
+ *
+ * Design Philosophy:
+ * - Fixed-size binary records, no parsing on the write path
+ * - Append-only: a record slot is reserved once and never reused
+ * - Survives process death: the file is MAP_SHARED, so the page
+ *   cache keeps every committed record after the writer is killed
+ *
+ * Layout:
+ *   [sg_journal_header_t][sg_journal_record_t * capacity]
+ */
+
+#ifndef SELF_GUARD_JOURNAL_H
+#define SELF_GUARD_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SG_JOURNAL_MAGIC    0x4C4E524A44524753ULL  /* "SGRDJRNL" little-endian */
+#define SG_JOURNAL_VERSION  1u
+
+/* ============================================
+ * Event Types
+ * ============================================ */
+
+typedef enum {
+    SG_JEV_OPEN      = 1,  /* Journal attached by a process */
+    SG_JEV_SNAPSHOT  = 2,  /* Baseline taken: addr/len = region, value = digest */
+    SG_JEV_DETECTION = 3,  /* Detector fired: detector, addr/len, value = detail */
+    SG_JEV_STATE     = 4,  /* Security state transition: value = previous state */
+    SG_JEV_CLOSE     = 5,  /* Journal detached cleanly */
+    SG_JEV_REPAIR    = 6   /* Page restored: addr/len = differing bytes, value = count */
+} sg_journal_event_t;
+
+/* ============================================
+ * File Header (one cache line)
+ *
+ * `cursor` is the lock-free reservation cursor: writers claim a
+ * slot with an atomic fetch-add and never touch it again.
+ * Reservations past `capacity` are counted in `dropped`.
+ * ============================================ */
+
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;       /* Number of record slots in the file */
+    uint64_t cursor;         /* Next slot to reserve (atomic) */
+    uint64_t dropped;        /* Reservations that found the file full (atomic) */
+    uint64_t created_ns;     /* CLOCK_REALTIME at file creation */
+    uint8_t  reserved[16];
+} sg_journal_header_t;
+
+/* ============================================
+ * Record (one cache line)
+ *
+ * `commit` is written last with release ordering and holds
+ * slot index + 1. A record whose commit does not match its
+ * slot was torn by process death and must be ignored.
+ * ============================================ */
+
+typedef struct {
+    uint64_t realtime_ns;    /* CLOCK_REALTIME_COARSE when the event was raised */
+    uint64_t cycles;         /* Cycle cost attributed to the event */
+    uint64_t addr;           /* Region start (0 if not applicable) */
+    uint64_t len;            /* Region length in bytes */
+    uint64_t value;          /* Event-specific detail (digest, old state, ...) */
+    uint32_t pid;
+    uint32_t tid;
+    uint16_t type;           /* sg_journal_event_t */
+    uint8_t  detector;       /* SG_CHECK_* bit index, 0xFF if none */
+    uint8_t  state;          /* Security state after the event */
+    uint8_t  reserved[4];
+    uint64_t commit;         /* Slot index + 1, written last */
+} sg_journal_record_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SELF_GUARD_JOURNAL_H */
@@ -0,0 +1,47 @@
+/*
+ * Self-Guard Signature Set Format
+ * On-disk layout shared by the library and the sg-sigc compiler
+ *
+ * Design Philosophy:
+ * - Compact: a 4-byte id and a 1-byte length per signature, no padding
+ * - Loaded with one read and validated before anything is built
+ * - Signatures are exact byte strings; the matcher is rebuilt on load
+ *
+ * Layout:
+ *   [sg_sigset_header_t][record * count]
+ *   record = uint32_t id (little-endian), uint8_t len, uint8_t bytes[len]
+ */
+
+#ifndef SELF_GUARD_SIGNATURES_H
+#define SELF_GUARD_SIGNATURES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SG_SIGSET_MAGIC     0x54455347u   /* "GSET" little-endian */
+#define SG_SIGSET_VERSION   1u
+
+#define SG_SIG_MIN_LEN      4     /* Shorter strings match ordinary code */
+#define SG_SIG_MAX_LEN      255
+#define SG_SIG_MAX_COUNT    65536
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;          /* Number of records */
+    uint32_t payload_size;   /* Bytes of records after the header */
+    uint64_t checksum;       /* FNV-1a 64 over the payload */
+} sg_sigset_header_t;
+
+#define SG_SIGSET_FNV_OFFSET  0xcbf29ce484222325ULL
+#define SG_SIGSET_FNV_PRIME   0x100000001b3ULL
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SELF_GUARD_SIGNATURES_H */
@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# bench_compare.sh: gate an optimized build on sg-bench results
+#
+# Usage: bench_compare.sh <baseline.txt> <candidate.txt> [tolerance-percent]
+#
+# Compares the "ns/call" and "ns/KiB" lines of two sg-bench runs benchmark by
+# benchmark. Each file may hold several runs; the best (lowest) result
+# per benchmark is used. Fails if any benchmark in the candidate is
+# slower than the baseline by more than the tolerance (default 10%) and
+# by more than 2 ns, which keeps loop-alignment noise on the few-ns
+# benchmarks from failing the gate.
+
+set -eu
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <baseline.txt> <candidate.txt> [tolerance-percent]" >&2
+    exit 2
+fi
+
+BASELINE=$1
+CANDIDATE=$2
+TOLERANCE=${3:-10}
+
+awk -v tol="$TOLERANCE" '
+    / ns\/(call|KiB) / {
+        name = $0
+        sub(/[ \t]+[0-9.]+ ns\/(call|KiB) .*/, "", name)
+        for (i = 1; i < NF; i++) {
+            if ($(i + 1) ~ /^ns\//) {
+                value = $i + 0
+            }
+        }
+        if (FNR == NR) {
+            if (!(name in base) || value < base[name]) {
+                base[name] = value
+                order[++count] = name
+            }
+        } else if (!(name in cand) || value < cand[name]) {
+            cand[name] = value
+        }
+    }
+    END {
+        for (k = 1; k <= count; k++) {
+            name = order[k]
+            if (!(name in cand) || (name in seen)) {
+                continue
+            }
+            seen[name] = 1
+            delta = (cand[name] - base[name]) / base[name] * 100
+            status = "ok"
+            if (delta > tol && cand[name] - base[name] > 2) {
+                status = "REGRESSION"
+                failed = 1
+            }
+            printf "%-34s %12.1f -> %12.1f ns  (%+6.1f%%)  %s\n", name, base[name], cand[name], delta, status
+            compared++
+        }
+        if (compared == 0) {
+            print "bench_compare: no common benchmarks found" > "/dev/stderr"
+            exit 2
+        }
+        exit failed ? 1 : 0
+    }
+' "$BASELINE" "$CANDIDATE"
@@ -3,7 +3,7 @@
  * 
  * Used when:
  * - Architecture is not x86_64 or ARM64
- * - Assembly is disabled (safety/portability)
+ * - Assembly is disabled (SG_PORTABLE_BACKEND)
  * - Compiler doesn't support inline assembly
  * 
  * Trade-offs:
@@ -12,13 +12,18 @@
  * - Statistical detection only
  */
 
+/* clock_gettime under -std=c11 */
+#define _POSIX_C_SOURCE 200809L
+
 #include "self_guard_asm.h"
+#include "../checksum_words.h"
 #include <time.h>
 #include <string.h>
 #include <stdio.h>
 
 /* Compile this fallback only if no native assembly is available */
-#if !defined(__x86_64__) && !defined(_M_X64) && !defined(__aarch64__) && !defined(__arm64__)
+#if defined(SG_PORTABLE_BACKEND) || \
+    (!defined(__x86_64__) && !defined(_M_X64) && !defined(__aarch64__) && !defined(__arm64__))
 
 /* ============================================
  * Portable Timing via clock_gettime
@@ -113,22 +118,12 @@ int sg_timing_check(void) {
  * Portable Memory Checksumming
  * ============================================ */
 
+/*
+ * Word-at-a-time rotate-XOR (see checksum_words.h); same digest as
+ * the byte loop of the native backends.
+ */
 uint32_t sg_checksum_memory(const void* start, size_t length) {
-    const uint8_t* data = (const uint8_t*)start;
-    uint32_t checksum = 0;
-    
-    if (start == NULL || length == 0) {
-        return 0;
-    }
-    
-    for (size_t i = 0; i < length; i++) {
-        /* Rotate left by 1 bit */
-        checksum = (checksum << 1) | (checksum >> 31);
-        /* XOR in current byte */
-        checksum ^= data[i];
-    }
-    
-    return checksum;
+    return sg_checksum_words(start, length);
 }
 
 const char* sg_get_implementation(void) {
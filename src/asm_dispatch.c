@@ -9,7 +9,8 @@
 #include "self_guard_asm.h"
 
 /* Only provide dispatcher if using native assembly */
-#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(__arm64__)
+#if !defined(SG_PORTABLE_BACKEND) && \
+    (defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(__arm64__))
 
 const char* sg_get_implementation(void) {
 #if defined(__x86_64__) || defined(_M_X64)
@@ -0,0 +1,333 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Attestation Publisher
+ *
+ * Responsibilities:
+ * - Create the sealed memfd segment sg-attestd reads the state from
+ * - Register it over the daemon's SOCK_SEQPACKET socket
+ * - Mirror state word and heartbeat with single stores, roots under a seqlock
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <atomic>
+#include <new>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+extern "C" {
+    #include "self_guard_attest.h"
+}
+#include "attest.h"
+#include "sha256.h"
+
+static_assert(sizeof(sg_attest_region_t) == 64, "attest region must be one cache line");
+static_assert(sizeof(sg_attest_record_t) == 64, "attest record must be one cache line");
+static_assert(sizeof(sg_attest_msg_t) == 16, "attest message header is 16 bytes");
+
+#if defined(__linux__) && defined(SYS_memfd_create) && defined(F_ADD_SEALS)
+#define SG_HAVE_ATTEST 1
+#else
+#define SG_HAVE_ATTEST 0
+#endif
+
+namespace {
+
+struct AttestMapping {
+    sg_attest_segment_t* segment;
+    int sock;                  /* Registration; closing it unregisters */
+};
+
+/* Published mapping; writers only ever load this pointer */
+std::atomic<AttestMapping*> g_attest(nullptr);
+
+/* Serializes attach/detach and roots updates (never taken by state writers) */
+std::mutex g_attest_mutex;
+
+/* Writers still inside a segment store; detach waits for zero */
+std::atomic<uint32_t> g_attest_writers(0);
+
+pthread_once_t g_attest_fork_once = PTHREAD_ONCE_INIT;
+
+void unmap_attest(AttestMapping* mapping) {
+    close(mapping->sock);
+    munmap(mapping->segment, sizeof(sg_attest_segment_t));
+    delete mapping;
+}
+
+/*
+ * A forked child must not write into its parent's segment or keep the
+ * registration socket open past the parent's exit: drop both.
+ */
+void attest_fork_prepare() {
+    g_attest_mutex.lock();
+}
+
+void attest_fork_parent() {
+    g_attest_mutex.unlock();
+}
+
+void attest_fork_child() {
+    AttestMapping* mapping = g_attest.exchange(nullptr, std::memory_order_relaxed);
+    g_attest_writers.store(0, std::memory_order_relaxed);
+    if (mapping != nullptr) {
+        unmap_attest(mapping);
+    }
+    g_attest_mutex.unlock();
+}
+
+void install_fork_handlers() {
+    pthread_atfork(attest_fork_prepare, attest_fork_parent, attest_fork_child);
+}
+
+AttestMapping* enter_writer() {
+    if (g_attest.load(std::memory_order_relaxed) == nullptr) {
+        return nullptr;
+    }
+    g_attest_writers.fetch_add(1, std::memory_order_seq_cst);
+    AttestMapping* mapping = g_attest.load(std::memory_order_seq_cst);
+    if (mapping == nullptr) {
+        g_attest_writers.fetch_sub(1, std::memory_order_release);
+    }
+    return mapping;
+}
+
+void leave_writer() {
+    g_attest_writers.fetch_sub(1, std::memory_order_release);
+}
+
+#if SG_HAVE_ATTEST
+/* Send REGISTER with the segment fd and wait up to a second for the ack */
+bool register_segment(int sock, int memfd) {
+    sg_attest_msg_t msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.type = SG_ATTEST_MSG_REGISTER;
+    msg.tag = static_cast<uint32_t>(getpid());
+
+    struct iovec iov;
+    iov.iov_base = &msg;
+    iov.iov_len = sizeof(msg);
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    struct msghdr hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buf;
+    hdr.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+
+    if (sendmsg(sock, &hdr, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(msg))) {
+        return false;
+    }
+
+    struct timeval timeout = {1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sg_attest_msg_t ack;
+    if (recv(sock, &ack, sizeof(ack), 0) != static_cast<ssize_t>(sizeof(ack))) {
+        return false;
+    }
+    return ack.type == (SG_ATTEST_MSG_REGISTER | SG_ATTEST_MSG_REPLY) && ack.status == 0;
+}
+
+int connect_daemon(const char* socket_path) {
+    if (socket_path == nullptr) {
+        socket_path = getenv(SG_ATTEST_SOCKET_ENV);
+    }
+    if (socket_path == nullptr || socket_path[0] == '\0') {
+        socket_path = SG_ATTEST_DEFAULT_SOCKET;
+    }
+
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    const size_t len = std::strlen(socket_path);
+    if (len >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    std::memcpy(addr.sun_path, socket_path, len + 1);
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    if (connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/* Sealed against resizing so the daemon's read-only mapping cannot fault */
+sg_attest_segment_t* create_segment(uint64_t initial_word, int* memfd_out) {
+    int memfd = static_cast<int>(syscall(SYS_memfd_create, "sg-attest",
+                                         MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (memfd < 0) {
+        return nullptr;
+    }
+    if (ftruncate(memfd, sizeof(sg_attest_segment_t)) != 0 ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        close(memfd);
+        return nullptr;
+    }
+
+    void* base = mmap(nullptr, sizeof(sg_attest_segment_t), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, memfd, 0);
+    if (base == MAP_FAILED) {
+        close(memfd);
+        return nullptr;
+    }
+
+    sg_attest_segment_t* seg = static_cast<sg_attest_segment_t*>(base);
+    seg->version = SG_ATTEST_VERSION;
+    seg->size = sizeof(sg_attest_segment_t);
+    seg->state_word = initial_word;
+    /* Magic last: the daemon rejects a half-initialized segment */
+    __atomic_store_n(&seg->magic, SG_ATTEST_MAGIC, __ATOMIC_RELEASE);
+
+    *memfd_out = memfd;
+    return seg;
+}
+#endif
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_attest_attach(const char* socket_path, uint64_t initial_word) {
+#if SG_HAVE_ATTEST
+    pthread_once(&g_attest_fork_once, install_fork_handlers);
+    std::lock_guard<std::mutex> lock(g_attest_mutex);
+
+    if (g_attest.load(std::memory_order_acquire) != nullptr) {
+        return -1;
+    }
+
+    int memfd = -1;
+    sg_attest_segment_t* seg = create_segment(initial_word, &memfd);
+    if (seg == nullptr) {
+        return -1;
+    }
+
+    int sock = connect_daemon(socket_path);
+    const bool registered = sock >= 0 && register_segment(sock, memfd);
+    close(memfd);
+
+    AttestMapping* mapping = registered ? new(std::nothrow) AttestMapping : nullptr;
+    if (mapping == nullptr) {
+        if (sock >= 0) {
+            close(sock);
+        }
+        munmap(seg, sizeof(sg_attest_segment_t));
+        return -1;
+    }
+    mapping->segment = seg;
+    mapping->sock = sock;
+
+    g_attest.store(mapping, std::memory_order_release);
+    return 0;
+#else
+    (void)socket_path;
+    (void)initial_word;
+    (void)install_fork_handlers;
+    return -1;
+#endif
+}
+
+int guard_attest_detach(void) {
+    std::lock_guard<std::mutex> lock(g_attest_mutex);
+
+    AttestMapping* mapping = g_attest.load(std::memory_order_acquire);
+    if (mapping == nullptr) {
+        return -1;
+    }
+    g_attest.store(nullptr, std::memory_order_seq_cst);
+
+    /* Let in-flight writers finish their store before unmapping */
+    while (g_attest_writers.load(std::memory_order_seq_cst) != 0) {
+        sched_yield();
+    }
+
+    unmap_attest(mapping);
+    return 0;
+}
+
+int guard_attest_active(void) {
+    return g_attest.load(std::memory_order_relaxed) != nullptr ? 1 : 0;
+}
+
+void guard_attest_state(uint64_t word) {
+    AttestMapping* mapping = enter_writer();
+    if (mapping == nullptr) {
+        return;
+    }
+    __atomic_store_n(&mapping->segment->state_word, word, __ATOMIC_RELEASE);
+    leave_writer();
+}
+
+void guard_attest_heartbeat(uint64_t deadline_ns) {
+    AttestMapping* mapping = enter_writer();
+    if (mapping == nullptr) {
+        return;
+    }
+    __atomic_store_n(&mapping->segment->heartbeat_ns, deadline_ns, __ATOMIC_RELAXED);
+    leave_writer();
+}
+
+void guard_attest_roots(const sg_attest_region_t* regions, size_t count) {
+    std::lock_guard<std::mutex> lock(g_attest_mutex);
+
+    AttestMapping* mapping = g_attest.load(std::memory_order_acquire);
+    if (mapping == nullptr) {
+        return;
+    }
+
+    uint8_t root[SG_ATTEST_ROOT_SIZE];
+    std::memset(root, 0, sizeof(root));
+    if (count != 0) {
+        guard_sha256_t ctx;
+        guard_sha256_init(&ctx);
+        for (size_t i = 0; i < count; ++i) {
+            guard_sha256_update(&ctx, regions[i].root, SG_ATTEST_ROOT_SIZE);
+        }
+        guard_sha256_final(&ctx, root);
+    }
+
+    sg_attest_segment_t* seg = mapping->segment;
+    const uint32_t seq = __atomic_load_n(&seg->roots_seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&seg->roots_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    const size_t kept = count < SG_ATTEST_MAX_REGIONS ? count : SG_ATTEST_MAX_REGIONS;
+    std::memcpy(seg->regions, regions, kept * sizeof(sg_attest_region_t));
+    std::memcpy(seg->root, root, sizeof(root));
+    seg->region_count = static_cast<uint32_t>(kept);
+    seg->region_total = static_cast<uint32_t>(count);
+
+    __atomic_store_n(&seg->roots_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+} /* extern "C" */
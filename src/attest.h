@@ -0,0 +1,46 @@
+/*
+ * Self-Guard Attestation Publisher
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_ATTEST_H
+#define SG_INTERNAL_ATTEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "self_guard_attest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Create the shared segment and register it with sg-attestd at
+ * socket_path (NULL = environment or default). The segment starts
+ * out with initial_word. Returns 0, or -1 if already attached or the
+ * daemon refused or could not be reached.
+ */
+int guard_attest_attach(const char* socket_path, uint64_t initial_word);
+int guard_attest_detach(void);
+
+/* Non-zero while registered with a daemon */
+int guard_attest_active(void);
+
+/*
+ * Mirror the packed state word / heartbeat deadline. One atomic store
+ * when attached, a single load otherwise; async-signal-safe.
+ */
+void guard_attest_state(uint64_t word);
+void guard_attest_heartbeat(uint64_t deadline_ns);
+
+/*
+ * Replace the region roots and fold them into the top root. Regions
+ * past SG_ATTEST_MAX_REGIONS only contribute to the top root.
+ */
+void guard_attest_roots(const sg_attest_region_t* regions, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_ATTEST_H */
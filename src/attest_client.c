@@ -0,0 +1,175 @@
+/*
+ * Self-Guard Attestation Client (libsg_attest)
+ *
+ * Responsibilities:
+ * - Connect sidecars to sg-attestd without linking the guard library
+ * - Send QUERY / REGIONS requests and collect their batched replies
+ *
+ * Standalone: depends only on self_guard_attest.h and libc.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "self_guard_attest.h"
+
+/* Largest reply packet: a full record batch */
+typedef union {
+    sg_attest_msg_t header;
+    struct {
+        sg_attest_msg_t header;
+        sg_attest_record_t records[SG_ATTEST_MAX_BATCH];
+    } query;
+    struct {
+        sg_attest_msg_t header;
+        sg_attest_region_t regions[SG_ATTEST_MAX_REGIONS];
+    } roots;
+} attest_reply_t;
+
+static uint32_t g_next_tag = 0;
+
+int sg_attest_connect(const char* socket_path) {
+    if (socket_path == NULL) {
+        socket_path = getenv(SG_ATTEST_SOCKET_ENV);
+    }
+    if (socket_path == NULL || socket_path[0] == '\0') {
+        socket_path = SG_ATTEST_DEFAULT_SOCKET;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    const size_t len = strlen(socket_path);
+    if (len >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memcpy(addr.sun_path, socket_path, len + 1);
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        int saved = errno;
+        close(sock);
+        errno = saved;
+        return -1;
+    }
+
+    /* A wedged daemon must not wedge the sidecar */
+    struct timeval timeout = {1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return sock;
+}
+
+/*
+ * Receive the next reply to (type, tag), skipping late replies to
+ * requests that timed out earlier. Returns the payload count or -1.
+ */
+static int recv_reply(int sock, uint16_t type, uint32_t tag, attest_reply_t* reply,
+                      size_t entry_size) {
+    for (;;) {
+        ssize_t n = recv(sock, reply, sizeof(*reply), 0);
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            errno = ECONNRESET;
+            return -1;
+        }
+        if ((size_t)n < sizeof(sg_attest_msg_t)) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (reply->header.tag != tag || reply->header.type != (type | SG_ATTEST_MSG_REPLY)) {
+            continue;
+        }
+        if (reply->header.status != 0) {
+            errno = (int)reply->header.status;
+            return -1;
+        }
+        if ((size_t)n != sizeof(sg_attest_msg_t) + reply->header.count * entry_size) {
+            errno = EPROTO;
+            return -1;
+        }
+        return (int)reply->header.count;
+    }
+}
+
+static int send_request(int sock, uint16_t type, uint32_t tag, const uint32_t* pids,
+                        size_t count) {
+    struct {
+        sg_attest_msg_t header;
+        uint32_t pids[SG_ATTEST_MAX_BATCH];
+    } request;
+
+    memset(&request.header, 0, sizeof(request.header));
+    request.header.type = type;
+    request.header.tag = tag;
+    request.header.count = (uint32_t)count;
+    if (count != 0) {
+        memcpy(request.pids, pids, count * sizeof(uint32_t));
+    }
+
+    const size_t len = sizeof(sg_attest_msg_t) + count * sizeof(uint32_t);
+    return send(sock, &request, len, MSG_NOSIGNAL) == (ssize_t)len ? 0 : -1;
+}
+
+int sg_attest_query(int sock, const uint32_t* pids, size_t count,
+                    sg_attest_record_t* out, size_t max) {
+    attest_reply_t reply;
+    size_t total = 0;
+    size_t done = 0;
+
+    /* Longer pid lists go out as several requests of one batch each */
+    do {
+        const size_t batch = count - done < SG_ATTEST_MAX_BATCH ? count - done : SG_ATTEST_MAX_BATCH;
+        const uint32_t tag = __atomic_add_fetch(&g_next_tag, 1, __ATOMIC_RELAXED);
+        if (send_request(sock, SG_ATTEST_MSG_QUERY, tag, pids + done, batch) != 0) {
+            return -1;
+        }
+
+        int more;
+        do {
+            int n = recv_reply(sock, SG_ATTEST_MSG_QUERY, tag, &reply, sizeof(sg_attest_record_t));
+            if (n < 0) {
+                return -1;
+            }
+            for (int i = 0; i < n; ++i, ++total) {
+                if (total < max) {
+                    out[total] = reply.query.records[i];
+                }
+            }
+            more = (reply.header.flags & SG_ATTEST_F_MORE) != 0;
+        } while (more);
+
+        done += batch;
+    } while (done < count);
+
+    return (int)total;
+}
+
+int sg_attest_regions(int sock, uint32_t pid, sg_attest_region_t* out, size_t max) {
+    attest_reply_t reply;
+    const uint32_t tag = __atomic_add_fetch(&g_next_tag, 1, __ATOMIC_RELAXED);
+
+    if (send_request(sock, SG_ATTEST_MSG_REGIONS, tag, &pid, 1) != 0) {
+        return -1;
+    }
+
+    int n = recv_reply(sock, SG_ATTEST_MSG_REGIONS, tag, &reply, sizeof(sg_attest_region_t));
+    if (n < 0) {
+        return -1;
+    }
+    size_t kept = (size_t)n < max ? (size_t)n : max;
+    memcpy(out, reply.roots.regions, kept * sizeof(sg_attest_region_t));
+    return (int)kept;
+}
@@ -0,0 +1,311 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Call-Site Cost Attribution
+ *
+ * Responsibilities:
+ * - Charge the cost of each instrumented API call to its return
+ *   address in a fixed, lock-free open-addressing table
+ * - Read the cycle counter without serialization, so accounting a
+ *   call costs a few ns rather than a CPUID
+ * - Resolve call sites to function + offset on demand from the
+ *   modules' ELF symbol tables (static functions included)
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__linux__) || defined(__FreeBSD__)
+#include <link.h>
+#define SG_HAVE_DL_ITERATE_PHDR 1
+#endif
+
+extern "C" {
+    #include "self_guard.h"
+    #include "self_guard_asm.h"
+    #include "self_guard_asm_inline.h"
+}
+#include "callers.h"
+
+namespace {
+
+/* ============================================
+ * Call-Site Table
+ * ============================================ */
+
+constexpr size_t CALLER_SLOTS = 512;     /* Power of two */
+constexpr size_t CALLER_PROBES = 16;
+
+/* One cache line per site: sites hit from different threads do not share */
+struct alignas(64) CallerSlot {
+    std::atomic<uintptr_t> caller;       /* 0 = free */
+    std::atomic<uint32_t> call;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> cycles;
+    std::atomic<uint64_t> max_cycles;
+};
+
+CallerSlot g_caller_slots[CALLER_SLOTS];
+CallerSlot g_caller_overflow;            /* Sites that found no free slot */
+std::atomic<int> g_callers_enabled(0);
+
+inline uint64_t read_call_counter() {
+#if SG_HAVE_INLINE_ASM && defined(__x86_64__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#elif SG_HAVE_INLINE_ASM
+    uint64_t value;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return sg_get_cycle_counter();
+#endif
+}
+
+CallerSlot* find_slot(uintptr_t caller, uint32_t call) {
+    size_t i = static_cast<size_t>((caller * 0x9E3779B97F4A7C15ULL) >> 55) & (CALLER_SLOTS - 1);
+    for (size_t probe = 0; probe < CALLER_PROBES; ++probe, i = (i + 1) & (CALLER_SLOTS - 1)) {
+        CallerSlot& slot = g_caller_slots[i];
+        uintptr_t key = slot.caller.load(std::memory_order_acquire);
+        if (key == 0) {
+            if (slot.caller.compare_exchange_strong(key, caller, std::memory_order_acq_rel)) {
+                slot.call.store(call, std::memory_order_relaxed);
+                return &slot;
+            }
+        }
+        if (key == caller) {
+            return &slot;
+        }
+    }
+    return &g_caller_overflow;
+}
+
+void clear_slot(CallerSlot& slot) {
+    slot.calls.store(0, std::memory_order_relaxed);
+    slot.cycles.store(0, std::memory_order_relaxed);
+    slot.max_cycles.store(0, std::memory_order_relaxed);
+    slot.call.store(0, std::memory_order_relaxed);
+    slot.caller.store(0, std::memory_order_release);
+}
+
+void copy_slot(const CallerSlot& slot, sg_caller_stats_t* out) {
+    std::memset(out, 0, sizeof(*out));
+    out->caller = slot.caller.load(std::memory_order_acquire);
+    out->call = slot.call.load(std::memory_order_relaxed);
+    out->calls = slot.calls.load(std::memory_order_relaxed);
+    out->cycles = slot.cycles.load(std::memory_order_relaxed);
+    out->max_cycles = slot.max_cycles.load(std::memory_order_relaxed);
+}
+
+/* ============================================
+ * Symbol Resolution
+ * ============================================ */
+
+#if defined(SG_HAVE_DL_ITERATE_PHDR)
+
+const char* base_name(const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    return slash != nullptr ? slash + 1 : path;
+}
+
+/* name may be unterminated within its max_len bytes */
+void copy_name(char* out, const char* name, size_t max_len) {
+    size_t len = strnlen(name, max_len < SG_CALLER_NAME_MAX - 1 ? max_len : SG_CALLER_NAME_MAX - 1);
+    std::memcpy(out, name, len);
+    out[len] = '\0';
+}
+
+/*
+ * Name the function around each entry's module_offset from the file's
+ * .symtab (.dynsym when stripped). Entries stay unnamed if the file
+ * cannot be read or has neither.
+ */
+void resolve_in_file(const char* path, sg_caller_stats_t** entries, size_t count) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(ElfW(Ehdr))) {
+        map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        return;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    const uint8_t* file = static_cast<const uint8_t*>(map);
+    const ElfW(Ehdr)* eh = reinterpret_cast<const ElfW(Ehdr)*>(file);
+    const bool valid = std::memcmp(eh->e_ident, ELFMAG, SELFMAG) == 0 &&
+                       eh->e_shentsize == sizeof(ElfW(Shdr)) &&
+                       eh->e_shoff < size &&
+                       eh->e_shnum <= (size - eh->e_shoff) / sizeof(ElfW(Shdr));
+    const ElfW(Shdr)* sections = valid ? reinterpret_cast<const ElfW(Shdr)*>(file + eh->e_shoff) : nullptr;
+
+    const ElfW(Shdr)* symtab = nullptr;
+    for (size_t i = 0; sections != nullptr && i < eh->e_shnum; ++i) {
+        if (sections[i].sh_type == SHT_SYMTAB ||
+            (sections[i].sh_type == SHT_DYNSYM && symtab == nullptr)) {
+            symtab = &sections[i];
+        }
+    }
+    const ElfW(Shdr)* strtab = symtab != nullptr && symtab->sh_link < eh->e_shnum
+        ? &sections[symtab->sh_link] : nullptr;
+
+    if (strtab != nullptr && symtab->sh_offset <= size && symtab->sh_size <= size - symtab->sh_offset &&
+        strtab->sh_offset <= size && strtab->sh_size <= size - strtab->sh_offset) {
+        const ElfW(Sym)* syms = reinterpret_cast<const ElfW(Sym)*>(file + symtab->sh_offset);
+        const size_t nsyms = symtab->sh_size / sizeof(ElfW(Sym));
+        const char* names = reinterpret_cast<const char*>(file + strtab->sh_offset);
+
+        for (size_t e = 0; e < count; ++e) {
+            sg_caller_stats_t* entry = entries[e];
+            const ElfW(Sym)* best = nullptr;
+            for (size_t s = 0; s < nsyms; ++s) {
+                const ElfW(Sym)& sym = syms[s];
+                const unsigned type = ELF64_ST_TYPE(sym.st_info);
+                if ((type != STT_FUNC && type != STT_GNU_IFUNC) || sym.st_shndx == SHN_UNDEF ||
+                    entry->module_offset < sym.st_value ||
+                    entry->module_offset - sym.st_value >= (sym.st_size != 0 ? sym.st_size : 1)) {
+                    continue;
+                }
+                if (best == nullptr || sym.st_value > best->st_value) {
+                    best = &sym;
+                }
+            }
+            if (best != nullptr && best->st_name < strtab->sh_size) {
+                copy_name(entry->symbol, names + best->st_name, strtab->sh_size - best->st_name);
+                entry->symbol_offset = static_cast<uint32_t>(entry->module_offset - best->st_value);
+            }
+        }
+    }
+    munmap(map, size);
+}
+
+struct ResolveWalk {
+    sg_caller_stats_t* entries;
+    size_t count;
+    std::vector<sg_caller_stats_t*> found;
+};
+
+int resolve_module(struct dl_phdr_info* info, size_t, void* data) {
+    ResolveWalk* walk = static_cast<ResolveWalk*>(data);
+    walk->found.clear();
+    for (size_t e = 0; e < walk->count; ++e) {
+        sg_caller_stats_t& entry = walk->entries[e];
+        for (ElfW(Half) i = 0; i < info->dlpi_phnum && entry.caller != 0; ++i) {
+            const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+            const uintptr_t start = info->dlpi_addr + ph.p_vaddr;
+            if (ph.p_type == PT_LOAD && entry.caller >= start && entry.caller - start < ph.p_memsz) {
+                entry.module_offset = entry.caller - info->dlpi_addr;
+                walk->found.push_back(&entry);
+                break;
+            }
+        }
+    }
+    if (walk->found.empty()) {
+        return 0;
+    }
+
+    /* The main program has an empty name */
+    char exe[PATH_MAX];
+    const char* path = info->dlpi_name;
+    if (path[0] == '\0') {
+        const ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+        exe[n > 0 ? n : 0] = '\0';
+        path = exe;
+    }
+    for (sg_caller_stats_t* entry : walk->found) {
+        copy_name(entry->module, base_name(path), SIZE_MAX);
+    }
+    if (path[0] == '/') {
+        resolve_in_file(path, walk->found.data(), walk->found.size());
+    }
+    return 0;
+}
+
+#endif /* SG_HAVE_DL_ITERATE_PHDR */
+
+} // anonymous namespace
+
+extern "C" {
+
+void guard_callers_enable(int on) {
+    g_callers_enabled.store(0, std::memory_order_relaxed);
+    if (!on) {
+        return;
+    }
+    for (CallerSlot& slot : g_caller_slots) {
+        clear_slot(slot);
+    }
+    clear_slot(g_caller_overflow);
+    g_callers_enabled.store(1, std::memory_order_release);
+}
+
+int guard_callers_enabled(void) {
+    return g_callers_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t guard_callers_clock(void) {
+    return read_call_counter();
+}
+
+void guard_callers_record(const void* caller, uint32_t call, uint64_t start) {
+    const uint64_t cycles = read_call_counter() - start;
+    CallerSlot* slot = find_slot(reinterpret_cast<uintptr_t>(caller), call);
+    slot->calls.fetch_add(1, std::memory_order_relaxed);
+    slot->cycles.fetch_add(cycles, std::memory_order_relaxed);
+    uint64_t max = slot->max_cycles.load(std::memory_order_relaxed);
+    while (cycles > max &&
+           !slot->max_cycles.compare_exchange_weak(max, cycles, std::memory_order_relaxed)) {
+    }
+}
+
+size_t guard_callers_report(sg_caller_stats_t* out, size_t max) {
+    std::vector<sg_caller_stats_t> sites;
+    sites.reserve(CALLER_SLOTS + 1);
+    for (const CallerSlot& slot : g_caller_slots) {
+        if (slot.caller.load(std::memory_order_acquire) != 0) {
+            sites.emplace_back();
+            copy_slot(slot, &sites.back());
+        }
+    }
+    if (g_caller_overflow.calls.load(std::memory_order_relaxed) != 0) {
+        sites.emplace_back();
+        copy_slot(g_caller_overflow, &sites.back());
+        sites.back().caller = 0;
+    }
+
+    std::sort(sites.begin(), sites.end(), [](const sg_caller_stats_t& a, const sg_caller_stats_t& b) {
+        return a.cycles > b.cycles;
+    });
+    const size_t n = sites.size() < max ? sites.size() : max;
+
+#if defined(SG_HAVE_DL_ITERATE_PHDR)
+    if (n != 0) {
+        ResolveWalk walk;
+        walk.entries = sites.data();
+        walk.count = n;
+        dl_iterate_phdr(resolve_module, &walk);
+    }
+#endif
+
+    if (n != 0) {
+        std::memcpy(out, sites.data(), n * sizeof(*out));
+    }
+    return sites.size();
+}
+
+} // extern "C"
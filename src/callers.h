@@ -0,0 +1,39 @@
+/*
+ * Self-Guard Call-Site Cost Attribution
+ * Internal interface used by the C API layer and the C++ core
+ */
+
+#ifndef SG_INTERNAL_CALLERS_H
+#define SG_INTERNAL_CALLERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "self_guard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* SG_OPT_CALLER_STATS: turning it on clears the table */
+void guard_callers_enable(int on);
+
+int guard_callers_enabled(void);
+
+/* Unserialized counter read taken before the call being accounted */
+uint64_t guard_callers_clock(void);
+
+/* Charge the time since start to the call site that returns to caller */
+void guard_callers_record(const void* caller, uint32_t call, uint64_t start);
+
+/*
+ * Costliest call sites first, with symbols resolved from the modules'
+ * symbol tables. Returns the number of sites recorded, of which the
+ * first max are written.
+ */
+size_t guard_callers_report(sg_caller_stats_t* out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_CALLERS_H */
@@ -0,0 +1,73 @@
+/*
+ * Self-Guard Word-at-a-Time Checksum Kernel
+ * Internal, header-only; shared by the portable backend and the tuner
+ *
+ * Produces exactly the sg_checksum_memory digest (rotate-left-by-1,
+ * XOR byte) without the per-byte dependency chain. Byte i of an
+ * n-byte buffer ends up rotated left by (n - 1 - i) mod 32, so
+ *
+ *   C = rotl(S, (n - 1) mod 32),  S = XOR_i rotr(b_i, i mod 32)
+ *
+ * and S only depends on each byte's position mod 32. The main loop
+ * therefore just XORs 32-byte blocks into 64-bit lanes (endian-neutral,
+ * and a pattern compilers vectorize), then folds the 32 accumulated
+ * bytes once at the end.
+ */
+
+#ifndef SG_INTERNAL_CHECKSUM_WORDS_H
+#define SG_INTERNAL_CHECKSUM_WORDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static inline uint32_t sg_words_rotr32(uint32_t x, unsigned r) {
+    return (x >> r) | (x << ((32u - r) & 31u));
+}
+
+static inline uint32_t sg_checksum_words(const void* start, size_t length) {
+    const uint8_t* data = (const uint8_t*)start;
+
+    if (start == NULL || length == 0) {
+        return 0;
+    }
+
+    /* Two 32-byte lane sets per iteration to keep independent XOR chains */
+    uint64_t lane[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        uint64_t w[8];
+        memcpy(w, data + i, sizeof(w));
+        for (int k = 0; k < 8; k++) {
+            lane[k] ^= w[k];
+        }
+    }
+    for (; i + 32 <= length; i += 32) {
+        uint64_t w[4];
+        memcpy(w, data + i, sizeof(w));
+        for (int k = 0; k < 4; k++) {
+            lane[k] ^= w[k];
+        }
+    }
+    for (int k = 0; k < 4; k++) {
+        lane[k] ^= lane[k + 4];
+    }
+
+    /* Fold: byte j of the accumulator sits at position j mod 32 */
+    uint8_t block[32];
+    memcpy(block, lane, sizeof(block));
+    uint32_t sum = 0;
+    for (unsigned j = 0; j < 32; j++) {
+        sum ^= sg_words_rotr32(block[j], j);
+    }
+
+    /* Tail starts on a 32-byte boundary, so its position is i mod 32 */
+    for (; i < length; i++) {
+        sum ^= sg_words_rotr32(data[i], (unsigned)(i & 31u));
+    }
+
+    unsigned rot = (unsigned)((length - 1) & 31u);
+    return (sum << rot) | (sum >> ((32u - rot) & 31u));
+}
+
+#endif /* SG_INTERNAL_CHECKSUM_WORDS_H */
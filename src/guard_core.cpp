@@ -6,20 +6,54 @@
  * - Security state management
  * - Integrity verification orchestration
  * - Thread-safe access control
+ * - Background monitor scheduling against staleness SLOs
+ * - Mirroring the published state to sg-attestd
  *
  * CRITICAL FIX: All C-callable functions wrapped in extern "C"
  */
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <mutex>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
 #include <new>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 extern "C" {
     #include "self_guard.h"
     #include "self_guard_asm.h"
+    #include "self_guard_asm_inline.h"
+    #include "self_guard_journal.h"
+    #include "self_guard_attest.h"
+    #include "self_guard_signatures.h"
 }
+#include "journal.h"
+#include "attest.h"
+#include "tuning.h"
+#include "pagemap.h"
+#include "verity.h"
+#include "modules.h"
+#include "preload.h"
+#include "heal.h"
+#include "signatures.h"
+#include "threads.h"
+#include "watch.h"
+#include "wheel.h"
+#include "callers.h"
+#include "page_hash.h"
 
 /* ============================================
  * Platform-Specific Code Section Detection
@@ -33,7 +67,39 @@ struct CodeSection {
     bool available;
 };
 
-#if defined(__linux__) && !defined(__ANDROID__)
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SG_BUILD_SHARED)
+/*
+ * Linux ELF shared library: __executable_start/__etext would name
+ * this library (or nothing), so locate the main program's executable
+ * PT_LOAD segment through the loader instead.
+ */
+#include <link.h>
+
+int find_main_text(struct dl_phdr_info* info, size_t, void* data) {
+    CodeSection* section = static_cast<CodeSection*>(data);
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if (ph.p_type == PT_LOAD && (ph.p_flags & PF_X)) {
+            section->start = reinterpret_cast<const void*>(info->dlpi_addr + ph.p_vaddr);
+            section->size = static_cast<size_t>(ph.p_memsz);
+            section->available = true;
+            break;
+        }
+    }
+    /* The main program is always reported first */
+    return 1;
+}
+
+CodeSection get_code_section() {
+    CodeSection section;
+    section.start = nullptr;
+    section.size = 0;
+    section.available = false;
+    dl_iterate_phdr(find_main_text, &section);
+    return section;
+}
+
+#elif defined(__linux__) && !defined(__ANDROID__)
 /* Linux ELF: Use linker-provided symbols */
 extern "C" {
     extern char __executable_start;
@@ -133,6 +199,190 @@ CodeSection get_code_section() {
 }
 #endif
 
+/* ============================================
+ * Debugger Detection Backends
+ * ============================================ */
+
+/*
+ * MOV from DRn is privileged and faults at CPL3 on Linux, so the
+ * TracerPid check is the debugger backend there. Builds for
+ * environments that grant user-mode DRn reads opt in to the register
+ * check with -DSG_DEBUG_REGISTERS.
+ */
+#if defined(SG_DEBUG_REGISTERS) && SG_HAVE_INLINE_ASM
+constexpr bool k_debug_registers = true;
+#else
+constexpr bool k_debug_registers = false;
+#endif
+
+/*
+ * TracerPid from /proc/self/status: 1 if traced, 0 if not,
+ * -1 if unavailable on this platform
+ */
+int tracer_pid_check() {
+#if defined(__linux__)
+    int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char buf[4096];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    const char* line = std::strstr(buf, "TracerPid:");
+    if (line == nullptr) {
+        return -1;
+    }
+    line += 10;
+    while (*line == ' ' || *line == '\t') {
+        ++line;
+    }
+    return (*line >= '1' && *line <= '9') ? 1 : 0;
+#else
+    return -1;
+#endif
+}
+
+/* ============================================
+ * Published State Word
+ *
+ * One 64-bit atomic carries everything a reader needs:
+ *   [63:24] last-verified time, CLOCK_MONOTONIC in 2^16 ns units
+ *           (~65 us resolution, wraps after ~2.2 years; 0 = never)
+ *   [23:4]  check generation (wraps at 2^20)
+ *   [3:0]   sg_security_state_t
+ * ============================================ */
+
+constexpr unsigned STATE_WORD_GEN_SHIFT  = 4;
+constexpr unsigned STATE_WORD_TIME_SHIFT = 24;
+constexpr unsigned STATE_TIME_UNIT_SHIFT = 16;
+constexpr uint64_t STATE_WORD_STATE_MASK = 0xFULL;
+constexpr uint64_t STATE_WORD_GEN_MASK   = (1ULL << 20) - 1;
+constexpr uint64_t STATE_WORD_TIME_MASK  = (1ULL << 40) - 1;
+
+/* sg-attestd decodes the mirrored word with the public macros */
+static_assert(STATE_WORD_GEN_SHIFT == 4 && STATE_WORD_TIME_SHIFT == 24 &&
+              STATE_TIME_UNIT_SHIFT == SG_ATTEST_TIME_UNIT_SHIFT &&
+              STATE_WORD_TIME_MASK == SG_ATTEST_TIME_MASK,
+              "state word packing is part of the attestation protocol");
+
+inline uint64_t make_state_word(sg_security_state_t state, uint64_t generation, uint64_t time_units) {
+    return (static_cast<uint64_t>(state) & STATE_WORD_STATE_MASK) |
+           ((generation & STATE_WORD_GEN_MASK) << STATE_WORD_GEN_SHIFT) |
+           ((time_units & STATE_WORD_TIME_MASK) << STATE_WORD_TIME_SHIFT);
+}
+
+inline sg_security_state_t state_word_state(uint64_t word) {
+    return static_cast<sg_security_state_t>(word & STATE_WORD_STATE_MASK);
+}
+
+inline uint64_t state_word_generation(uint64_t word) {
+    return (word >> STATE_WORD_GEN_SHIFT) & STATE_WORD_GEN_MASK;
+}
+
+inline uint64_t state_word_time(uint64_t word) {
+    return word >> STATE_WORD_TIME_SHIFT;
+}
+
+inline uint64_t monotonic_ns() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/*
+ * Tick-resolution monotonic clock (a few ms): a vDSO read without the
+ * counter, cheap enough for sg_get_security_state
+ */
+inline uint64_t coarse_ns() {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_COARSE)
+    if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) != 0) {
+#else
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+#endif
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/* Current time in state-word units; never 0 so 0 can mean "never verified" */
+inline uint64_t state_time_now() {
+    uint64_t units = (monotonic_ns() >> STATE_TIME_UNIT_SHIFT) & STATE_WORD_TIME_MASK;
+    return units != 0 ? units : 1;
+}
+
+/* Age of a state-word timestamp in nanoseconds, UINT64_MAX if never verified */
+inline uint64_t state_time_age_ns(uint64_t time_units, uint64_t now_units) {
+    if (time_units == 0) {
+        return UINT64_MAX;
+    }
+    return ((now_units - time_units) & STATE_WORD_TIME_MASK) << STATE_TIME_UNIT_SHIFT;
+}
+
+/* Checks in a row a new thread may be found running before it is reported */
+constexpr uint32_t THREAD_RUNNING_LIMIT = 8;
+
+/* SG_CHECK_* bits that name a detector */
+constexpr uint32_t DETECTOR_MASK = (1u << SG_DETECTOR_MAX) - 1;
+
+/* ============================================
+ * Runtime Options (settable before or after sg_init)
+ * ============================================ */
+
+constexpr uint64_t DEFAULT_SLICE_PAGES = 64;
+constexpr uint64_t DEFAULT_MONITOR_STALL_MS = 1000;
+
+std::atomic<uint64_t> g_opt_slice_pages(DEFAULT_SLICE_PAGES);
+std::atomic<uint64_t> g_opt_memory_mode(SG_MEMORY_HASH);
+std::atomic<uint64_t> g_opt_verity(1);
+std::atomic<uint64_t> g_opt_modules(0);
+std::atomic<uint64_t> g_opt_self_heal(SG_HEAL_OFF);
+std::atomic<uint64_t> g_opt_monitor_stall_ms(DEFAULT_MONITOR_STALL_MS);
+std::atomic<uint64_t> g_opt_hash(SG_HASH_ROTXOR);
+std::atomic<uint64_t> g_opt_granule(0);   /* 0: by page size and huge page backing */
+std::atomic<uint64_t> g_opt_digest_bits(0);   /* 0: the hash's full width */
+
+inline bool granule_valid(uint64_t bytes, size_t page_size) {
+    return bytes >= page_size && bytes <= SG_GRANULE_MAX && (bytes & (bytes - 1)) == 0;
+}
+
+/* File mappings indexed per snapshot and the scratch used to read them */
+constexpr size_t MAX_FILE_RANGES = 8;
+
+/* Memory that can vanish mid-scan is copied out in chunks of this size */
+constexpr size_t SCAN_CHUNK = 64 * 1024;
+constexpr size_t SIG_HISTORY = 8;   /* Longest signature window */
+constexpr size_t COLD_READ_BYTES = 64 * 1024;
+
+/* Background monitor: wheel ticks of 2^20 ns (~1 ms) */
+constexpr unsigned MONITOR_TICK_SHIFT = 20;
+
+/*
+ * A private file-backed text page can only differ from the file after
+ * copy-on-write has replaced it with an anonymous page. Swapped pages
+ * are anonymous too. Exclusively mapped file pages are hashed as well:
+ * a MAP_SHARED memfd mapped over the text also reports the file bit.
+ */
+inline bool pagemap_needs_hash(uint64_t entry) {
+    if (entry & SG_PAGEMAP_SWAPPED) {
+        return true;
+    }
+    if (!(entry & SG_PAGEMAP_PRESENT)) {
+        return false;   /* Never touched: reads come from the file */
+    }
+    return !(entry & SG_PAGEMAP_FILE) || (entry & SG_PAGEMAP_EXCLUSIVE);
+}
+
 } /* anonymous namespace */
 
 /* ============================================
@@ -141,7 +391,26 @@ CodeSection get_code_section() {
 
 class SecurityStateManager {
 private:
-    std::atomic<sg_security_state_t> current_state;
+    std::atomic<uint64_t> state_word;
+
+    /*
+     * Per-detector freshness: state-word time of the start of the last
+     * complete verification (0 = never). sg_require_fresh only trusts
+     * the detectors it names; the state word's own timestamp follows
+     * SG_DETECTOR_MEMORY, so a debugger-only check never refreshes it.
+     */
+    std::atomic<uint64_t> fresh_units[SG_DETECTOR_MAX];
+
+    /*
+     * Monitor liveness, beaten by the monitor thread and read by every
+     * sg_get_security_state; its own line so beats do not bounce the
+     * state word or the mutex.
+     */
+    struct alignas(64) Heartbeat {
+        std::atomic<uint64_t> deadline_ns;   /* coarse_ns(); 0 = not enforced */
+        std::atomic<uint64_t> count;
+    } heartbeat;
+
     std::mutex state_mutex;
     
     /* Baseline integrity data */
@@ -149,215 +418,2824 @@ private:
         uint32_t code_checksum;
         uint64_t baseline_tsc;
         uint8_t initialized;
-        uint8_t padding[7]; /* Explicit padding for alignment */
+        uint8_t hw_debug_check;  /* Register check opted in (SG_DEBUG_REGISTERS) */
+        uint8_t padding[6]; /* Explicit padding for alignment */
     } baseline;
 
-    /* Secure memory clearing */
-    static void secure_zero(void* ptr, size_t size) {
-        volatile uint8_t* p = static_cast<volatile uint8_t*>(ptr);
-        for (size_t i = 0; i < size; ++i) {
-            p[i] = 0;
+    /*
+     * Per-block digests of the code section, built by take_snapshot. A
+     * block is one granule (SG_OPT_GRANULE), a whole number of system
+     * pages; pagemap, file and heal bookkeeping stay per system page.
+     */
+    struct PageTable {
+        const uint8_t* start;
+        size_t size;
+        size_t page_size;      /* System page */
+        size_t granule;        /* Bytes per digest, engine.page_size */
+        size_t sweep_cursor;   /* Next block for sliced verification */
+        uint64_t sweep_start_units;   /* state_time_now() when that sweep began */
+        guard_hash_engine_t engine;                /* SG_OPT_HASH, _DIGEST_BITS at the snapshot */
+        std::vector<uint32_t> digests;             /* engine.digest_words per block */
+        uintptr_t map_base;    /* start rounded down to a system page */
+        std::vector<uint64_t> pagemap; /* Entry buffer for PAGEMAP/RESIDENT modes */
+        guard_file_range_t files[MAX_FILE_RANGES]; /* Backing files of the region */
+        size_t file_count;
+        std::vector<uint8_t> cold_buffer;          /* SG_MEMORY_RESIDENT file reads */
+        size_t count;                              /* Blocks in the region */
+        bool verity;                               /* Baseline is the fs-verity tree */
+        guard_verity_info_t verity_info;
+        std::vector<uint8_t> verity_leaves;        /* Leaf hash per system page */
+        std::vector<uint8_t> shadow;               /* SG_HEAL_SHADOW: LZ4 block per system page */
+        std::vector<uint32_t> shadow_offsets;      /* Block k is [offsets[k], offsets[k + 1]) */
+        std::vector<uint8_t> heal_buffer;          /* Original system pages under a block */
+    } pages;
+
+    /* sg_set_region_granule overrides: region start, bytes */
+    std::vector<std::pair<uintptr_t, size_t>> region_granules;
+
+    sg_repair_info_t repair;   /* Last self-healing repair, counted since init */
+
+    /* Shared library text (SG_OPT_MODULES), verified after the main region */
+    struct ModuleRegion {
+        const uint8_t* start;
+        size_t size;
+        size_t granule;         /* Bytes per digest */
+        guard_hash_engine_t engine;   /* pages.engine's hash at this granule */
+        size_t count;           /* Blocks */
+        std::vector<uint32_t> digests;
+        bool vanished;          /* Unloaded since the snapshot; skipped */
+    };
+    std::vector<ModuleRegion> modules;
+    size_t module_pages;       /* Blocks of all modules */
+    bool modules_unreadable;   /* SG_OPT_MODULES set, but no fault-tolerant read here */
+
+    /* Anonymous executable memory, scanned for signatures (SG_CHECK_SIGNATURES) */
+    struct SignatureCursor {
+        std::vector<guard_anon_range_t> ranges;   /* Refreshed when a pass starts */
+        size_t range;                             /* ranges.size() = pass finished */
+        size_t offset;
+        guard_sig_stream_t stream;
+        uint64_t pass_start_units;   /* state_time_now() when ranges were listed */
+    } sigscan;
+
+    /* Executable mappings at snapshot time, diffed against the live ones (SG_CHECK_MAPS) */
+    struct ExecMapIndex {
+        std::vector<guard_exec_mapping_t> baseline;
+        std::vector<guard_exec_mapping_t> current;
+        std::vector<guard_anon_range_t> healed;   /* Pages SG_OPT_SELF_HEAL put back */
+        uint64_t footprint[3];                    /* Status counters when current was read */
+        bool valid;
+        bool stale;                               /* Reread even if the counters agree */
+        uint32_t verdict;                         /* Result of the last diff */
+        guard_exec_mapping_t finding;
+    } exec_maps;
+
+    /* Threads accounted for, diffed against /proc/self/task (SG_CHECK_THREADS) */
+    struct RunningThread {
+        int tid;
+        uint32_t misses;
+    };
+    struct ThreadIndex {
+        std::vector<int> known;   /* Ascending: at snapshot, registered, or vetted */
+        std::vector<int> live;
+        long count;               /* num_threads when live was listed */
+        bool valid;
+        std::vector<RunningThread> running;   /* Ascending: found on a CPU last time */
+        bool pending;             /* Some thread could not be inspected yet */
+        uint32_t verdict;
+        int tid;                  /* Thread behind the verdict */
+        uintptr_t finding;        /* Its unexpected code address, 0 if it never stopped */
+        uintptr_t addr;           /* Set by inspect_thread */
+    } threads;
+
+    /* Copies of module text and anonymous code, read with guard_read_self */
+    std::vector<uint8_t> scan_buffer;
+
+    /* A region or detector the monitor keeps within its staleness SLO */
+    struct SloUnit {
+        guard_wheel_timer_t timer;    /* First member: the wheel hands it back */
+        uint32_t detector;
+        const uint8_t* start;         /* SG_DETECTOR_MEMORY region */
+        size_t len;
+        size_t granule;               /* Bytes per block */
+        size_t first;                 /* Its blocks in sweep order */
+        size_t count;
+        size_t cursor;                /* Next block of the pass in progress */
+        uint64_t slo_ns;
+        uint64_t verified_ns;         /* Start of the last complete pass */
+        uint64_t pass_start_ns;       /* 0 while no pass is in progress */
+        uint64_t deadline_ns;         /* verified_ns + slo_ns */
+        uint64_t pass_wall_ns;        /* Moving average, first slice to last */
+        sg_slo_stats_t stats;
+    };
+
+    /* Background monitor (sg_monitor_start); all of it under state_mutex */
+    struct Monitor {
+        pthread_t thread;
+        std::condition_variable wake;
+        bool running;
+        bool stop;
+        uint64_t detector_slo[SG_DETECTOR_MAX];
+        std::vector<std::pair<uintptr_t, uint64_t>> region_slo;   /* Region start, SLO */
+        std::vector<SloUnit> units;
+        std::vector<SloUnit*> ready;  /* Min-heap on deadline_ns */
+        guard_wheel_t wheel;
+        uint64_t wakeups;
+        uint64_t slices;
+        uint64_t busy_ns;
+        uint64_t beat_ns;             /* coarse_ns() of the last heartbeat */
+        uint64_t stalls;              /* Beats that found the deadline passed */
+    } monitor;
+
+    static int collect_module(const guard_module_info_t* module, void* ctx) {
+        std::vector<guard_module_info_t>* list = static_cast<std::vector<guard_module_info_t>*>(ctx);
+        try {
+            list->push_back(*module);
+        } catch (const std::bad_alloc&) {
+            return 1;
         }
+        return 0;
     }
 
-public:
-    SecurityStateManager() : current_state(SG_COMPROMISED) {
-        secure_zero(&baseline, sizeof(baseline));
+    /*
+     * Baseline every loaded shared object. A module already baselined by
+     * sg_verify_file or by another process (host cache) is not rehashed.
+     */
+    bool build_module_tables() {
+        clear_module_tables();
+        if (g_opt_modules.load(std::memory_order_relaxed) == 0 || pages.page_size == 0) {
+            return true;
+        }
+        /* A plain copy of module text faults on a concurrent dlclose: skip them */
+        if (!guard_read_self_available()) {
+            modules_unreadable = true;
+            return true;
+        }
+
+        std::vector<guard_module_info_t> found;
+        guard_modules_foreach(collect_module, &found);
+
+        /* One smaps read rules out huge pages for the lot in the usual case */
+        uintptr_t lo = UINTPTR_MAX;
+        uintptr_t hi = 0;
+        for (const guard_module_info_t& info : found) {
+            lo = std::min(lo, reinterpret_cast<uintptr_t>(info.start));
+            hi = std::max(hi, reinterpret_cast<uintptr_t>(info.start) + info.size);
+        }
+        const bool huge = !found.empty() && g_opt_granule.load(std::memory_order_relaxed) == 0 &&
+                          guard_maps_huge_bytes(lo, hi) != 0;
+
+        const size_t words = pages.engine.digest_words;
+        /* Preloaded and cached digests are rotate-XOR */
+        const bool shared = pages.engine.hash == SG_HASH_ROTXOR;
+        try {
+            scan_buffer.resize(SCAN_CHUNK + SG_SIG_MAX_LEN + SIG_HISTORY);
+            modules.reserve(found.size());
+            for (const guard_module_info_t& info : found) {
+                ModuleRegion region;
+                region.start = info.start;
+                region.size = info.size;
+                region.vanished = false;
+                region.granule = granule_for(info.start, info.size, pages.page_size, huge);
+                if (guard_hash_engine(pages.engine.hash, region.granule, words, &region.engine) != 0) {
+                    continue;
+                }
+                const size_t granule = region.granule;
+                const size_t count = (info.size + granule - 1) / granule;
+                region.count = count;
+                region.digests.resize(count * words);
+                if (scan_buffer.size() < granule) {
+                    scan_buffer.resize(granule);
+                }
+
+                if (!shared) {
+                    if (!digest_module(region)) {
+                        continue;   /* dlclose'd since the walk */
+                    }
+                } else if (guard_preload_digests(&info, granule, region.digests.data(), count) == 0) {
+                    /* Digested while sg_verify_file streamed it */
+                    (void)guard_baseline_cache_store(&info, granule, region.digests.data(), count);
+                } else if (guard_baseline_cache_load(&info, granule, region.digests.data(), count) != 0) {
+                    if (!digest_module(region)) {
+                        continue;   /* dlclose'd since the walk */
+                    }
+                    (void)guard_baseline_cache_store(&info, granule, region.digests.data(), count);
+                }
+
+                guard_journal_emit(SG_JEV_SNAPSHOT, SG_DETECTOR_MEMORY,
+                                   static_cast<uint8_t>(get_state()),
+                                   reinterpret_cast<uintptr_t>(info.start), info.size,
+                                   count, 0);
+                module_pages += count;
+                modules.push_back(std::move(region));
+            }
+        } catch (const std::bad_alloc&) {
+            clear_module_tables();
+            return false;
+        }
+        return true;
     }
 
-    ~SecurityStateManager() {
-        secure_zero(&baseline, sizeof(baseline));
+    /*
+     * Digest block for the region at start: its sg_set_region_granule
+     * override, else SG_OPT_GRANULE, else one huge page if probe finds
+     * at least half the region mapped with them, else one system page.
+     */
+    size_t granule_for(const uint8_t* start, size_t size, size_t page_size, bool probe) const {
+        for (const auto& entry : region_granules) {
+            if (entry.first == reinterpret_cast<uintptr_t>(start)) {
+                return entry.second;
+            }
+        }
+        const uint64_t option = g_opt_granule.load(std::memory_order_relaxed);
+        if (option != 0) {
+            return granule_valid(option, page_size) ? static_cast<size_t>(option) : page_size;
+        }
+        const uintptr_t lo = reinterpret_cast<uintptr_t>(start);
+        if (probe && page_size < SG_GRANULE_MAX && guard_maps_huge_bytes(lo, lo + size) >= size / 2) {
+            return SG_GRANULE_MAX;
+        }
+        return page_size;
     }
 
-    bool initialize() {
-        std::lock_guard<std::mutex> lock(state_mutex);
-        
-        if (baseline.initialized) {
-            return false;
+    void clear_module_tables() {
+        modules.clear();
+        module_pages = 0;
+        modules_unreadable = false;
+    }
+
+    /*
+     * Block digests of module text, copied out a chunk at a time so a
+     * concurrent dlclose cannot fault the scan. Returns false if the
+     * module went away.
+     */
+    bool digest_module(ModuleRegion& region) {
+        const guard_hash_engine_t& engine = region.engine;
+        const size_t granule = region.granule;
+        const size_t chunk = scan_chunk(granule);
+        for (size_t offset = 0; offset < region.size; offset += chunk) {
+            const size_t len = region.size - offset < chunk ? region.size - offset : chunk;
+            if (guard_read_self(region.start + offset, scan_buffer.data(), len) != len) {
+                return false;
+            }
+            engine.digest(&engine, scan_buffer.data(), len,
+                          region.digests.data() + offset / granule * engine.digest_words);
         }
+        return true;
+    }
 
-        /* Take initial snapshot */
-        baseline.baseline_tsc = sg_get_cycle_counter();
-        baseline.initialized = 1;
-        current_state.store(SG_SAFE, std::memory_order_release);
-        
+    /* Bytes of module text copied out per read: whole blocks, at least one */
+    static size_t scan_chunk(size_t granule) {
+        return granule < SCAN_CHUNK ? SCAN_CHUNK - SCAN_CHUNK % granule : granule;
+    }
+
+    struct ModuleProbe {
+        const ModuleRegion* region;
+        bool found;
+    };
+
+    static int match_module(const guard_module_info_t* module, void* ctx) {
+        ModuleProbe* probe = static_cast<ModuleProbe*>(ctx);
+        probe->found = module->start == probe->region->start && module->size == probe->region->size;
+        return probe->found ? 1 : 0;
+    }
+
+    /* Is the module still loaded where it was? Only asked on a mismatch */
+    static bool module_loaded(const ModuleRegion& region) {
+        ModuleProbe probe = {&region, false};
+        guard_modules_foreach(match_module, &probe);
+        return probe.found;
+    }
+
+    /* Verify global blocks [first, first + n) that fall in the module regions */
+    bool verify_module_pages(sg_detector_result_t& det, sg_check_result_t* out,
+                             size_t first, size_t n) {
+        const size_t total = pages.count + module_pages;
+        size_t base = pages.count;
+        for (ModuleRegion& region : modules) {
+            const guard_hash_engine_t& engine = region.engine;
+            const size_t granule = region.granule;
+            const size_t chunk_pages = scan_chunk(granule) / granule;
+            const size_t count = region.count;
+            size_t lo = first > base ? first - base : 0;
+            size_t hi = first + n - base < count ? first + n - base : count;
+            if (first + n <= base) {
+                break;
+            }
+            for (size_t i = lo; i < hi && !region.vanished; ) {
+                const size_t run = hi - i < chunk_pages ? hi - i : chunk_pages;
+                const size_t offset = i * granule;
+                const size_t len = region.size - offset < run * granule ? region.size - offset
+                                                                       : run * granule;
+                if (guard_read_self(region.start + offset, scan_buffer.data(), len) != len) {
+                    if (!guard_read_self_available()) {
+                        modules_unreadable = true;   /* Not gone; we cannot read it */
+                        return true;
+                    }
+                    region.vanished = true;   /* Unmapped under us: dlclose */
+                    break;
+                }
+                const size_t at = engine.verify(&engine, scan_buffer.data(), len,
+                                                region.digests.data() + i * engine.digest_words) * granule;
+                if (at >= len) {
+                    det.bytes_verified += len;
+                    i += run;
+                    continue;
+                }
+                det.bytes_verified += len - at < granule ? len : at + granule;
+                if (!module_loaded(region)) {
+                    region.vanished = true;   /* Something else is mapped there now */
+                    break;
+                }
+                out->first_mismatch_addr = reinterpret_cast<uintptr_t>(region.start + offset + at);
+                out->pages_remaining = total - (base + i + at / granule) - 1;
+                return false;
+            }
+            base += count;
+        }
         return true;
     }
 
-    bool shutdown() {
-        std::lock_guard<std::mutex> lock(state_mutex);
-        
-        if (!baseline.initialized) {
+    bool build_page_table(const CodeSection& code) {
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t granule = granule_for(static_cast<const uint8_t*>(code.start), code.size,
+                                           page_size, true);
+        const size_t count = (code.size + granule - 1) / granule;
+
+        /* start may not be page aligned, so one extra entry may be spanned */
+        const uintptr_t map_base = reinterpret_cast<uintptr_t>(code.start) & ~(page_size - 1);
+        const size_t map_count = (reinterpret_cast<uintptr_t>(code.start) + code.size -
+                                  map_base + page_size - 1) / page_size;
+
+        guard_hash_engine_t engine;
+        const uint64_t bits = g_opt_digest_bits.load(std::memory_order_relaxed);
+        const uint32_t max_words = bits != 0 ? static_cast<uint32_t>(bits / 32) : GUARD_HASH_MAX_WORDS;
+        if (guard_hash_engine(static_cast<uint32_t>(g_opt_hash.load(std::memory_order_relaxed)),
+                              granule, max_words, &engine) != 0) {
             return false;
         }
 
-        secure_zero(&baseline, sizeof(baseline));
-        current_state.store(SG_COMPROMISED, std::memory_order_release);
-        
-        return true;
-    }
+        std::vector<uint32_t> digests;
+        std::vector<uint64_t> pagemap;
+        std::vector<uint8_t> cold_buffer;
+        std::vector<uint8_t> heal_buffer;
+        try {
+            digests.resize(count * engine.digest_words);
+            pagemap.resize(map_count);
+            /* Grown on first use for blocks larger than these (fit_buffer) */
+            cold_buffer.resize(COLD_READ_BYTES > page_size ? COLD_READ_BYTES : page_size);
+            heal_buffer.resize(2 * page_size);
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
 
-    bool take_snapshot() {
-        std::lock_guard<std::mutex> lock(state_mutex);
-        
-        if (!baseline.initialized) {
+        clear_page_table();
+        pages.start = static_cast<const uint8_t*>(code.start);
+        pages.size = code.size;
+        pages.page_size = page_size;
+        pages.granule = granule;
+        pages.sweep_cursor = 0;
+        pages.engine = engine;
+        pages.digests.swap(digests);
+        pages.map_base = map_base;
+        pages.pagemap.swap(pagemap);
+        pages.cold_buffer.swap(cold_buffer);
+        pages.heal_buffer.swap(heal_buffer);
+        pages.file_count = guard_maps_index(reinterpret_cast<uintptr_t>(code.start),
+                                            reinterpret_cast<uintptr_t>(code.start) + code.size,
+                                            pages.files, MAX_FILE_RANGES);
+        pages.count = count;
+
+        if (g_opt_self_heal.load(std::memory_order_relaxed) == SG_HEAL_SHADOW && !build_shadow()) {
             return false;
         }
 
-        /* Get code section */
-        CodeSection code = get_code_section();
-        
-        if (code.available) {
-            baseline.code_checksum = sg_checksum_memory(code.start, code.size);
-        } else {
-            /* If code section unavailable, checksum our own data structure */
-            baseline.code_checksum = sg_checksum_memory(&baseline, sizeof(baseline));
+        /* fs-verity protected binary: the kernel's tree is the baseline, nothing to hash */
+        if (g_opt_verity.load(std::memory_order_relaxed) != 0 && load_verity_baseline()) {
+            std::vector<uint32_t>().swap(pages.digests);
+            return true;
         }
-        
+
+        /* The baseline covers every page; only RESIDENT changes how cold ones are read */
+        const uint64_t mode = g_opt_memory_mode.load(std::memory_order_relaxed) == SG_MEMORY_RESIDENT
+                                  ? SG_MEMORY_RESIDENT : SG_MEMORY_HASH;
+        const guard_hash_engine_t& hash = pages.engine;
+        scan_pages(0, count, mode, [&](size_t i, const uint8_t* data, size_t len) {
+            hash.digest(&hash, data, len, pages.digests.data() + i * hash.digest_words);
+            return true;
+        });
         return true;
     }
 
-    bool check_integrity(uint32_t flags) {
-        std::lock_guard<std::mutex> lock(state_mutex);
-        
-        if (!baseline.initialized) {
-            return false;
+    void clear_page_table() {
+        if (!pages.digests.empty()) {
+            secure_zero(pages.digests.data(), pages.digests.size() * sizeof(uint32_t));
         }
+        pages.digests.clear();
+        pages.pagemap.clear();
+        pages.cold_buffer.clear();
+        pages.shadow.clear();
+        pages.shadow_offsets.clear();
+        pages.heal_buffer.clear();
+        guard_maps_release(pages.files, pages.file_count);
+        pages.file_count = 0;
+        pages.count = 0;
+        pages.verity = false;
+        pages.verity_leaves.clear();
+        pages.map_base = 0;
+        pages.start = nullptr;
+        pages.size = 0;
+        pages.granule = 0;
+        pages.sweep_cursor = 0;
+    }
 
-        bool suspicious = false;
-        bool compromised = false;
+    /*
+     * Use the fs-verity Merkle tree of the backing file as the baseline.
+     * Requires page-aligned code, tree blocks of one page and every page
+     * mapped from that same file; anything else falls back to hashing.
+     * Leaves stay per system page whatever the granule: a block is
+     * verified as its pages.
+     */
+    bool load_verity_baseline() {
+        if (pages.file_count == 0 ||
+            reinterpret_cast<uintptr_t>(pages.start) % pages.page_size != 0) {
+            return false;
+        }
 
-        /* Debugger detection */
-        if (flags & SG_CHECK_DEBUGGER) {
-            int dbg_result = sg_low_level_check();
-            if (dbg_result > 0) {
-                compromised = true;
-            }
+        guard_verity_info_t info;
+        if (guard_verity_probe(pages.files[0].fd, &info) != 0 || info.block_size != pages.page_size) {
+            return false;
         }
 
-        /* Timing analysis */
-        if (flags & SG_CHECK_TIMING) {
-            int timing_result = sg_timing_check();
-            if (timing_result > 0) {
-                suspicious = true;
+        struct stat first_st;
+        if (fstat(pages.files[0].fd, &first_st) != 0) {
+            return false;
+        }
+        for (size_t r = 1; r < pages.file_count; ++r) {
+            struct stat st;
+            if (fstat(pages.files[r].fd, &st) != 0 ||
+                st.st_ino != first_st.st_ino || st.st_dev != first_st.st_dev) {
+                return false;
             }
         }
 
-        /* Memory integrity */
-        if (flags & SG_CHECK_MEMORY) {
-            CodeSection code = get_code_section();
-            
-            if (code.available) {
-                uint32_t current_checksum = sg_checksum_memory(code.start, code.size);
-                
-                if (current_checksum != baseline.code_checksum) {
-                    compromised = true;
-                }
-            } else {
-                /* Fallback: check our own structure integrity */
-                uint32_t current_checksum = sg_checksum_memory(&baseline, sizeof(baseline));
-                
-                /* This is a weaker check but better than nothing */
-                if (current_checksum != baseline.code_checksum) {
-                    suspicious = true;
-                }
-            }
+        const size_t page_count = (pages.size + pages.page_size - 1) / pages.page_size;
+        std::vector<uint8_t> leaves;
+        std::vector<uint8_t> page_leaves;
+        try {
+            leaves.resize(info.leaf_count * SG_SHA256_DIGEST_SIZE);
+            page_leaves.resize(page_count * SG_SHA256_DIGEST_SIZE);
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        if (guard_verity_read_leaves(pages.files[0].fd, &info, leaves.data()) != 0) {
+            return false;
         }
 
-        /* Update state based on findings */
-        if (compromised) {
-            current_state.store(SG_COMPROMISED, std::memory_order_release);
-        } else if (suspicious) {
-            /* Only downgrade to WARNING if not already COMPROMISED */
-            sg_security_state_t expected = SG_SAFE;
-            current_state.compare_exchange_strong(expected, SG_WARNING, 
-                                                   std::memory_order_release);
+        for (size_t i = 0; i < page_count; ++i) {
+            const uintptr_t addr = reinterpret_cast<uintptr_t>(pages.start) + i * pages.page_size;
+            const guard_file_range_t* range = file_range_for(addr, pages.page_size);
+            if (range == nullptr) {
+                return false;
+            }
+            const uint64_t block = (range->file_offset + (addr - range->start)) / pages.page_size;
+            if (block >= info.leaf_count) {
+                return false;
+            }
+            std::memcpy(page_leaves.data() + i * SG_SHA256_DIGEST_SIZE,
+                        leaves.data() + block * SG_SHA256_DIGEST_SIZE, SG_SHA256_DIGEST_SIZE);
         }
 
+        pages.verity_info = info;
+        pages.verity_leaves.swap(page_leaves);
+        pages.verity = true;
         return true;
     }
 
-    int detect_debugger() const {
-        /* No lock needed - read-only atomic operation */
-        return sg_low_level_check();
+    /*
+     * Whole-region checksum from the block digests. Rotate-XOR is
+     * linear: C(A || B) = rotl(C(A), |B| mod 32) ^ C(B). Other hashes
+     * are not, so their table itself is checksummed.
+     */
+    uint32_t fold_page_digests() const {
+        if (pages.engine.hash != SG_HASH_ROTXOR) {
+            return sg_checksum_memory(pages.digests.data(), pages.digests.size() * sizeof(uint32_t));
+        }
+        uint32_t acc = 0;
+        for (size_t i = 0; i < pages.digests.size(); ++i) {
+            size_t offset = i * pages.granule;
+            size_t len = pages.size - offset < pages.granule ? pages.size - offset : pages.granule;
+            unsigned rot = static_cast<unsigned>(len % 32);
+            if (rot != 0) {
+                acc = (acc << rot) | (acc >> (32 - rot));
+            }
+            acc ^= pages.digests[i];
+        }
+        return acc;
     }
 
-    sg_security_state_t get_state() const {
-        return current_state.load(std::memory_order_acquire);
+    /*
+     * Fetch the pagemap (PAGEMAP) or residency (RESIDENT) entries covering
+     * blocks [first, first + n) in one call. Returns false if every page
+     * must be hashed in memory.
+     */
+    bool load_page_entries(size_t first, size_t n, uint64_t mode) {
+        if (mode == SG_MEMORY_HASH || pages.pagemap.empty()) {
+            return false;
+        }
+        const uintptr_t lo = reinterpret_cast<uintptr_t>(pages.start) + first * pages.granule;
+        const size_t end = (first + n) * pages.granule;
+        const uintptr_t hi = reinterpret_cast<uintptr_t>(pages.start) +
+                             (end < pages.size ? end : pages.size) - 1;
+        const size_t idx_lo = (lo - pages.map_base) / pages.page_size;
+        const size_t idx_hi = (hi - pages.map_base) / pages.page_size;
+        uint64_t* entries = pages.pagemap.data() + idx_lo;
+        const void* addr = reinterpret_cast<const void*>(lo);
+        if (mode == SG_MEMORY_PAGEMAP) {
+            return guard_pagemap_read(addr, idx_hi - idx_lo + 1, entries) == 0;
+        }
+        return guard_residency_read(addr, idx_hi - idx_lo + 1, entries) == 0;
     }
-};
-
-/* Global state manager (singleton pattern) */
-static SecurityStateManager* g_state_manager = nullptr;
-
-/* ============================================
- * C Interface Implementation
- * CRITICAL: extern "C" prevents name mangling
- * ============================================ */
 
-extern "C" {
+    /* True if any system page under [offset, offset + len) matches mask */
+    bool page_entries_any(size_t offset, size_t len, bool (*match)(uint64_t)) const {
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(pages.start) + offset;
+        const size_t idx_lo = (addr - pages.map_base) / pages.page_size;
+        const size_t idx_hi = (addr + len - 1 - pages.map_base) / pages.page_size;
+        for (size_t k = idx_lo; k <= idx_hi; ++k) {
+            if (match(pages.pagemap[k])) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-int guard_core_init(void) {
-    if (g_state_manager != nullptr) {
-        return -1;
+    static bool entry_in_memory(uint64_t entry) {
+        return (entry & (SG_PAGEMAP_PRESENT | SG_PAGEMAP_SWAPPED)) != 0;
     }
 
-    g_state_manager = new(std::nothrow) SecurityStateManager();
-    if (g_state_manager == nullptr) {
-        return -1;
+    static bool entry_cold(uint64_t entry) {
+        return !entry_in_memory(entry);
     }
 
-    if (!g_state_manager->initialize()) {
-        delete g_state_manager;
-        g_state_manager = nullptr;
-        return -1;
+    const guard_file_range_t* file_range_for(uintptr_t addr, size_t len) const {
+        for (size_t r = 0; r < pages.file_count; ++r) {
+            if (addr >= pages.files[r].start && addr + len <= pages.files[r].end) {
+                return &pages.files[r];
+            }
+        }
+        return nullptr;
     }
 
-    return 0;
-}
+    /*
+     * SG_MEMORY_RESIDENT: read a run of cold blocks starting at block i
+     * from the backing file into cold_buffer, without touching the
+     * mapping. Returns the number of blocks read, 0 if block i must be
+     * hashed in memory.
+     */
+    size_t read_cold_run(size_t i, size_t limit) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(pages.start);
+        const size_t granule = pages.granule;
+        size_t offset = i * granule;
+        size_t len = pages.size - offset < granule ? pages.size - offset : granule;
+        const guard_file_range_t* range = file_range_for(base + offset, len);
+        if (range == nullptr || !fit_buffer(pages.cold_buffer, len)) {
+            return 0;
+        }
 
-int guard_core_shutdown(void) {
-    if (g_state_manager == nullptr) {
+        size_t run = 1;
+        size_t bytes = len;
+        while (i + run < limit && bytes + granule <= pages.cold_buffer.size()) {
+            size_t next = (i + run) * granule;
+            size_t next_len = pages.size - next < granule ? pages.size - next : granule;
+            if (page_entries_any(next, next_len, entry_in_memory) ||
+                file_range_for(base + next, next_len) != range) {
+                break;
+            }
+            bytes += next_len;
+            ++run;
+        }
+
+        const off_t file_offset = static_cast<off_t>(range->file_offset + (base + offset - range->start));
+        ssize_t got = pread(range->fd, pages.cold_buffer.data(), bytes, file_offset);
+        return got == static_cast<ssize_t>(bytes) ? run : 0;
+    }
+
+    /*
+     * SG_MEMORY_RESIDENT, block i spanning both resident and cold
+     * pages (granule above the system page): assemble it in
+     * cold_buffer, copying the resident pages and reading the cold ones
+     * from the backing file. False if block i must be hashed in memory.
+     */
+    bool read_mixed_block(size_t i) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(pages.start);
+        const size_t offset = i * pages.granule;
+        const size_t len = run_bytes(i, 1);
+        const guard_file_range_t* range = file_range_for(base + offset, len);
+        if (range == nullptr || !fit_buffer(pages.cold_buffer, len)) {
+            return false;
+        }
+
+        /* One copy or pread per stretch of pages in the same state */
+        for (size_t done = 0; done < len; ) {
+            const uintptr_t addr = base + offset + done;
+            size_t k = (addr - pages.map_base) / pages.page_size;
+            const bool resident = entry_in_memory(pages.pagemap[k]);
+            size_t chunk = pages.map_base + (k + 1) * pages.page_size - addr;
+            while (done + chunk < len && entry_in_memory(pages.pagemap[k + 1]) == resident) {
+                chunk += pages.page_size;
+                ++k;
+            }
+            chunk = chunk < len - done ? chunk : len - done;
+
+            uint8_t* dst = pages.cold_buffer.data() + done;
+            if (resident) {
+                std::memcpy(dst, reinterpret_cast<const void*>(addr), chunk);
+            } else {
+                const off_t file_offset = static_cast<off_t>(range->file_offset + (addr - range->start));
+                if (pread(range->fd, dst, chunk, file_offset) != static_cast<ssize_t>(chunk)) {
+                    return false;
+                }
+            }
+            done += chunk;
+        }
+        return true;
+    }
+
+    /* Grow a scratch buffer to at least bytes; false if memory ran out */
+    static bool fit_buffer(std::vector<uint8_t>& buffer, size_t bytes) {
+        if (buffer.size() >= bytes) {
+            return true;
+        }
+        try {
+            buffer.resize(bytes);
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        return true;
+    }
+
+    /* Bytes of the count blocks starting at block i */
+    size_t run_bytes(size_t i, size_t count) const {
+        const size_t end = (i + count) * pages.granule;
+        return (end < pages.size ? end : pages.size) - i * pages.granule;
+    }
+
+    /*
+     * Hand blocks [first, first + n) to visit(i, data, len) in runs that
+     * the hash engine scans in one call: i is the run's first block and
+     * data its len bytes. visit returns false to stop. In PAGEMAP mode
+     * blocks none of whose pages can differ from their file are left
+     * out; in RESIDENT mode blocks with no page in memory are read from
+     * the backing file and blocks with some are assembled from both, so
+     * nothing is faulted in.
+     */
+    template <typename Visit>
+    bool scan_pages(size_t first, size_t n, uint64_t mode, Visit visit) {
+        const bool have_entries = load_page_entries(first, n, mode);
+        const size_t limit = first + n;
+        size_t run_start = first;   /* Pending run hashed in memory */
+
+        for (size_t i = first; have_entries && i < limit; ) {
+            const size_t offset = i * pages.granule;
+            const size_t len = pages.size - offset < pages.granule ? pages.size - offset : pages.granule;
+            const bool skip = mode == SG_MEMORY_PAGEMAP &&
+                              !page_entries_any(offset, len, pagemap_needs_hash);
+            const bool cold = mode == SG_MEMORY_RESIDENT &&
+                              !page_entries_any(offset, len, entry_in_memory);
+            const bool mixed = mode == SG_MEMORY_RESIDENT && !cold && len > pages.page_size &&
+                               page_entries_any(offset, len, entry_cold);
+            if (!skip && !cold && !mixed) {
+                ++i;
+                continue;
+            }
+            if (run_start < i && !visit(run_start, pages.start + run_start * pages.granule,
+                                        run_bytes(run_start, i - run_start))) {
+                return false;
+            }
+            if (skip) {
+                run_start = ++i;
+                continue;
+            }
+            if (mixed) {
+                if (!read_mixed_block(i)) {
+                    run_start = i++;   /* Not readable from its file: hashed in memory */
+                    continue;
+                }
+                if (!visit(i, pages.cold_buffer.data(), len)) {
+                    return false;
+                }
+                run_start = ++i;
+                continue;
+            }
+            const size_t run = read_cold_run(i, limit);
+            if (run == 0) {
+                run_start = i++;   /* Not readable from its file: hashed in memory */
+                continue;
+            }
+            if (!visit(i, pages.cold_buffer.data(), run_bytes(i, run))) {
+                return false;
+            }
+            i += run;
+            run_start = i;
+        }
+        return run_start >= limit ||
+               visit(run_start, pages.start + run_start * pages.granule, run_bytes(run_start, limit - run_start));
+    }
+
+    /*
+     * SG_HEAL_SHADOW: keep every system page under the region as an
+     * independent LZ4 block, so one page can be restored without the rest.
+     */
+    bool build_shadow() {
+        const size_t page_size = pages.page_size;
+        const size_t map_count = pages.pagemap.size();
+        std::vector<uint8_t> blob;
+        std::vector<uint32_t> offsets;
+        std::vector<uint8_t> block;
+        try {
+            offsets.reserve(map_count + 1);
+            block.resize(page_size);
+            offsets.push_back(0);
+            for (size_t k = 0; k < map_count; ++k) {
+                const uint8_t* page = reinterpret_cast<const uint8_t*>(pages.map_base + k * page_size);
+                /* Anything that does not shrink is stored raw (size == page_size) */
+                size_t n = guard_lz4_compress(page, page_size, block.data(), page_size - 1);
+                if (n == 0) {
+                    blob.insert(blob.end(), page, page + page_size);
+                } else {
+                    blob.insert(blob.end(), block.data(), block.data() + n);
+                }
+                offsets.push_back(static_cast<uint32_t>(blob.size()));
+            }
+            blob.shrink_to_fit();
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        pages.shadow.swap(blob);
+        pages.shadow_offsets.swap(offsets);
+        return true;
+    }
+
+    /* Original bytes of the system page at addr, from the configured source */
+    bool fetch_original(uintptr_t addr, uint64_t source, uint8_t* out) const {
+        const size_t page_size = pages.page_size;
+        if (source == SG_HEAL_SHADOW) {
+            const size_t k = (addr - pages.map_base) / page_size;
+            if (k + 1 >= pages.shadow_offsets.size()) {
+                return false;
+            }
+            const uint8_t* block = pages.shadow.data() + pages.shadow_offsets[k];
+            const size_t n = pages.shadow_offsets[k + 1] - pages.shadow_offsets[k];
+            if (n == page_size) {
+                std::memcpy(out, block, page_size);
+                return true;
+            }
+            return guard_lz4_decompress(block, n, out, page_size) == 0;
+        }
+
+        const guard_file_range_t* range = file_range_for(addr, page_size);
+        if (range == nullptr) {
+            return false;
+        }
+        /* Past EOF the mapping reads as zeros */
+        const off_t offset = static_cast<off_t>(range->file_offset + (addr - range->start));
+        ssize_t got = pread(range->fd, out, page_size, offset);
+        if (got < 0) {
+            return false;
+        }
+        std::memset(out + got, 0, page_size - static_cast<size_t>(got));
+        return true;
+    }
+
+    /* Does this block content reproduce the baseline of block i? */
+    bool matches_baseline(size_t i, const uint8_t* data, size_t len) const {
+        if (pages.verity) {
+            /* Leaf by leaf over the system pages of the block */
+            const size_t page_size = pages.page_size;
+            const uint8_t* leaf = pages.verity_leaves.data() +
+                                  i * (pages.granule / page_size) * SG_SHA256_DIGEST_SIZE;
+            uint8_t hash[SG_SHA256_DIGEST_SIZE];
+            for (size_t at = 0; at < len; at += page_size, leaf += SG_SHA256_DIGEST_SIZE) {
+                guard_verity_hash_block(&pages.verity_info, data + at, page_size, hash);
+                if (std::memcmp(hash, leaf, SG_SHA256_DIGEST_SIZE) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return pages.engine.verify(&pages.engine, data, len,
+                                   pages.digests.data() + i * pages.engine.digest_words) == 1;
+    }
+
+    /*
+     * SG_OPT_SELF_HEAL: restore the system pages under mismatching block
+     * i from the shadow or the file. The original must reproduce the
+     * baseline before anything is written, and the page must match it
+     * afterwards; otherwise the mismatch stands.
+     */
+    bool heal_page(size_t i, sg_check_result_t* out) {
+        const uint64_t source = g_opt_self_heal.load(std::memory_order_relaxed);
+        /* An unaligned block spans one more system page than it holds */
+        if (source == SG_HEAL_OFF || !fit_buffer(pages.heal_buffer, pages.granule + pages.page_size)) {
+            return false;
+        }
+        const uint64_t t0 = monotonic_ns();
+        const uint64_t c0 = sg_get_cycle_counter_inline();
+
+        const size_t page_size = pages.page_size;
+        const size_t offset = i * pages.granule;
+        const size_t len = pages.size - offset < pages.granule ? pages.size - offset : pages.granule;
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(pages.start) + offset;
+        const uintptr_t sys_start = pages.map_base + ((addr - pages.map_base) / page_size) * page_size;
+        const size_t sys_count = (addr + len - sys_start + page_size - 1) / page_size;
+
+        uint8_t* original = pages.heal_buffer.data();
+        for (size_t j = 0; j < sys_count; ++j) {
+            if (file_range_for(sys_start + j * page_size, page_size) == nullptr ||
+                !fetch_original(sys_start + j * page_size, source, original + j * page_size)) {
+                return false;
+            }
+        }
+        if (!matches_baseline(i, original + (addr - sys_start), len)) {
+            return false;   /* The source itself no longer matches the baseline */
+        }
+
+        /* Exact difference, for the report */
+        const uint8_t* current = reinterpret_cast<const uint8_t*>(sys_start);
+        const size_t total = sys_count * page_size;
+        size_t first = total;
+        size_t last = 0;
+        size_t differing = 0;
+        for (size_t b = 0; b < total; ++b) {
+            if (current[b] != original[b]) {
+                first = first == total ? b : first;
+                last = b;
+                ++differing;
+            }
+        }
+        if (differing == 0) {
+            return false;
+        }
+
+        sg_repair_info_t info;
+        std::memset(&info, 0, sizeof(info));
+        info.repairs = repair.repairs + 1;
+        info.first_diff_addr = sys_start + first;
+        info.diff_span = last - first + 1;
+        info.diff_bytes = differing;
+        info.source = static_cast<uint32_t>(source);
+        info.sample_len = static_cast<uint32_t>(total - first < SG_REPAIR_SAMPLE ? total - first
+                                                                                : SG_REPAIR_SAMPLE);
+        std::memcpy(info.expected, original + first, info.sample_len);
+        std::memcpy(info.found, current + first, info.sample_len);
+
+        /* Replace only the system pages that differ */
+        size_t replaced_lo = sys_count;
+        size_t replaced_hi = 0;
+        for (size_t j = 0; j < sys_count; ++j) {
+            const uint8_t* live = current + j * page_size;
+            if (std::memcmp(live, original + j * page_size, page_size) == 0) {
+                continue;
+            }
+            const guard_file_range_t* range = file_range_for(sys_start + j * page_size, page_size);
+            if (guard_page_replace(const_cast<uint8_t*>(live), original + j * page_size,
+                                   page_size, range->prot) != 0) {
+                return false;
+            }
+            replaced_lo = j < replaced_lo ? j : replaced_lo;
+            replaced_hi = j + 1;
+        }
+        if (!matches_baseline(i, pages.start + offset, len)) {
+            return false;
+        }
+
+        info.page_addr = sys_start + replaced_lo * page_size;
+        info.page_len = (replaced_hi - replaced_lo) * page_size;
+        note_healed(info.page_addr, info.page_len);
+        info.restore_ns = monotonic_ns() - t0;
+        repair = info;
+        if (out->first_mismatch_addr == 0) {
+            out->first_mismatch_addr = addr;
+        }
+        guard_journal_emit(SG_JEV_REPAIR, SG_DETECTOR_MEMORY, static_cast<uint8_t>(get_state()),
+                           info.first_diff_addr, info.diff_span, info.diff_bytes,
+                           sg_get_cycle_counter_inline() - c0);
+        return true;
+    }
+
+    /*
+     * fs-verity baseline: hash whole pages the way the Merkle tree hashes
+     * data blocks. Cold pages need no check in RESIDENT mode; the kernel
+     * verifies them against the tree when they are faulted in.
+     */
+    bool verify_pages_verity(sg_detector_result_t& det, sg_check_result_t* out,
+                             size_t first, size_t n) {
+        const uint64_t mode = g_opt_memory_mode.load(std::memory_order_relaxed);
+        const bool have_entries = load_page_entries(first, n, mode);
+        const size_t page_size = pages.page_size;
+        const size_t per_block = pages.granule / page_size;
+        const size_t page_count = (pages.size + page_size - 1) / page_size;
+        const size_t end = (first + n) * per_block < page_count ? (first + n) * per_block : page_count;
+        uint8_t hash[SG_SHA256_DIGEST_SIZE];
+
+        for (size_t k = first * per_block; k < end; ++k) {
+            const size_t offset = k * page_size;
+            if (have_entries && mode == SG_MEMORY_PAGEMAP &&
+                !page_entries_any(offset, page_size, pagemap_needs_hash)) {
+                continue;
+            }
+            if (have_entries && mode == SG_MEMORY_RESIDENT &&
+                !page_entries_any(offset, page_size, entry_in_memory)) {
+                continue;
+            }
+
+            guard_verity_hash_block(&pages.verity_info, pages.start + offset, page_size, hash);
+            det.bytes_verified += page_size;
+            if (std::memcmp(hash, pages.verity_leaves.data() + k * SG_SHA256_DIGEST_SIZE,
+                            SG_SHA256_DIGEST_SIZE) == 0) {
+                continue;
+            }
+            const size_t block = k / per_block;
+            if (!heal_page(block, out)) {
+                out->first_mismatch_addr = reinterpret_cast<uintptr_t>(pages.start + offset);
+                out->pages_remaining = pages.count - block - 1;
+                return false;
+            }
+            k = (block + 1) * per_block - 1;   /* Healing re-verified the whole block */
+        }
+        return true;
+    }
+
+    /* Verify blocks [first, first + n) in order, stopping at the first mismatch */
+    bool verify_pages(sg_detector_result_t& det, sg_check_result_t* out,
+                      size_t first, size_t n) {
+        if (pages.verity) {
+            return verify_pages_verity(det, out, first, n);
+        }
+
+        const size_t count = pages.count;
+        const size_t granule = pages.granule;
+        const guard_hash_engine_t& engine = pages.engine;
+        const uint64_t mode = g_opt_memory_mode.load(std::memory_order_relaxed);
+        return scan_pages(first, n, mode, [&](size_t i, const uint8_t* data, size_t len) {
+            /* Resume after each block healed */
+            for (size_t at = 0; at < len; ) {
+                const size_t bad = at + engine.verify(&engine, data + at, len - at,
+                                                      pages.digests.data() +
+                                                          (i + at / granule) * engine.digest_words) * granule;
+                if (bad >= len) {
+                    det.bytes_verified += len - at;
+                    break;
+                }
+                const size_t next = len - bad < granule ? len : bad + granule;
+                det.bytes_verified += next - at;
+                const size_t block = i + bad / granule;
+                if (!heal_page(block, out)) {
+                    out->first_mismatch_addr = reinterpret_cast<uintptr_t>(pages.start + block * granule);
+                    out->pages_remaining = count - block - 1;
+                    return false;
+                }
+                at = next;
+            }
+            return true;
+        });
+    }
+
+    static bool read_exec_mappings(std::vector<guard_exec_mapping_t>& out) {
+        if (out.size() < 64) {
+            out.resize(64);
+        }
+        size_t found = guard_maps_exec(out.data(), out.size());
+        if (found > out.size()) {
+            out.resize(found + 64);
+            found = guard_maps_exec(out.data(), out.size());
+        }
+        out.resize(found < out.size() ? found : out.size());
+        return found != 0;
+    }
+
+    void build_exec_baseline() {
+        exec_maps.healed.clear();
+        exec_maps.valid = guard_exec_footprint(exec_maps.footprint) == 0 &&
+                          read_exec_mappings(exec_maps.baseline);
+        exec_maps.current = exec_maps.baseline;
+        exec_maps.stale = false;
+        exec_maps.verdict = SG_VERDICT_PASS;
+    }
+
+    /* Whitelist a restored page: it is now an anonymous executable mapping */
+    void note_healed(uintptr_t start, size_t len) {
+        std::vector<guard_anon_range_t>& healed = exec_maps.healed;
+        size_t at = 0;
+        while (at < healed.size() && healed[at].end < start) {
+            ++at;
+        }
+        if (at < healed.size() && healed[at].start <= start + len) {
+            healed[at].start = healed[at].start < start ? healed[at].start : start;
+            healed[at].end = healed[at].end > start + len ? healed[at].end : start + len;
+        } else {
+            guard_anon_range_t range = {start, start + len, PROT_READ | PROT_EXEC};
+            healed.insert(healed.begin() + static_cast<std::ptrdiff_t>(at), range);
+        }
+        exec_maps.stale = true;
+    }
+
+    static bool same_backing(const guard_exec_mapping_t& a, const guard_exec_mapping_t& b) {
+        return a.kind == b.kind && a.dev == b.dev && a.inode == b.inode;
+    }
+
+    /*
+     * Severity of code in a mapping the snapshot does not account for,
+     * shared by SG_CHECK_MAPS and SG_CHECK_THREADS: anonymous memory may
+     * be a JIT's, anything file-like was loaded behind our back.
+     */
+    static uint32_t unexpected_exec_verdict(int kind) {
+        return kind == GUARD_EXEC_ANON ? SG_VERDICT_SUSPICIOUS : SG_VERDICT_TAMPERED;
+    }
+
+    /*
+     * One merge of the live mappings against the snapshot. Mappings
+     * backed by a linked file are expected (dlopen); any other mapping,
+     * or part of one, must have been there at snapshot time with the
+     * same backing, or be a healed page. New anonymous code is what
+     * JITs produce as well, so it is SUSPICIOUS; code running from a
+     * deleted or memfd file is how fileless loaders hide, so TAMPERED.
+     */
+    void diff_exec_mappings() {
+        const std::vector<guard_exec_mapping_t>& base = exec_maps.baseline;
+        const std::vector<guard_anon_range_t>& healed = exec_maps.healed;
+        size_t b = 0;
+        size_t h = 0;
+        exec_maps.verdict = SG_VERDICT_PASS;
+        for (const guard_exec_mapping_t& live : exec_maps.current) {
+            if (live.kind == GUARD_EXEC_FILE) {
+                continue;
+            }
+            while (b < base.size() && base[b].end <= live.start) {
+                ++b;
+            }
+            uintptr_t covered = live.start;
+            for (size_t k = b; k < base.size() && base[k].start <= covered && covered < live.end &&
+                               same_backing(base[k], live); ++k) {
+                covered = base[k].end;
+            }
+            if (covered < live.end && live.kind == GUARD_EXEC_ANON) {
+                while (h < healed.size() && healed[h].end <= covered) {
+                    ++h;
+                }
+                for (size_t k = h; k < healed.size() && healed[k].start <= covered &&
+                                   covered < live.end; ++k) {
+                    covered = healed[k].end;
+                }
+            }
+            if (covered >= live.end) {
+                continue;
+            }
+
+            const uint32_t verdict = unexpected_exec_verdict(live.kind);
+            if (exec_maps.verdict != verdict && exec_maps.verdict != SG_VERDICT_TAMPERED) {
+                exec_maps.verdict = verdict;
+                exec_maps.finding = live;
+            }
+        }
+    }
+
+    /*
+     * SG_CHECK_MAPS: rereads /proc/self/maps only when the status
+     * counters moved; otherwise the last diff stands. Returns the
+     * verdict, or SKIPPED without a snapshot.
+     */
+    uint32_t check_exec_maps() {
+        if (!exec_maps.valid) {
+            return SG_VERDICT_SKIPPED;
+        }
+        uint64_t footprint[3];
+        if (guard_exec_footprint(footprint) != 0) {
+            return SG_VERDICT_SKIPPED;
+        }
+        if (exec_maps.stale || std::memcmp(footprint, exec_maps.footprint, sizeof(footprint)) != 0) {
+            /* Counters first: a change racing the read shows up next time */
+            std::memcpy(exec_maps.footprint, footprint, sizeof(footprint));
+            exec_maps.stale = false;
+            read_exec_mappings(exec_maps.current);
+            diff_exec_mappings();
+        }
+        return exec_maps.verdict;
+    }
+
+    /*
+     * Is addr in executable memory the snapshot accounts for? Sets
+     * *holder to the executable mapping holding it, or null if none.
+     */
+    bool address_expected(uintptr_t addr, const guard_exec_mapping_t** holder) const {
+        const std::vector<guard_exec_mapping_t>& live = exec_maps.current;
+        auto by_start = [](uintptr_t a, const guard_exec_mapping_t& m) { return a < m.start; };
+        auto it = std::upper_bound(live.begin(), live.end(), addr, by_start);
+        if (it == live.begin() || addr >= (it - 1)->end) {
+            *holder = nullptr;
+            return false;
+        }
+        const guard_exec_mapping_t& mapping = *(it - 1);
+        *holder = &mapping;
+        if (mapping.kind == GUARD_EXEC_FILE) {
+            return true;
+        }
+        const std::vector<guard_exec_mapping_t>& base = exec_maps.baseline;
+        auto b = std::upper_bound(base.begin(), base.end(), addr, by_start);
+        if (b != base.begin() && addr < (b - 1)->end && same_backing(*(b - 1), mapping)) {
+            return true;
+        }
+        if (mapping.kind != GUARD_EXEC_ANON) {
+            return false;
+        }
+        for (const guard_anon_range_t& range : exec_maps.healed) {
+            if (addr >= range.start && addr < range.end) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void build_thread_baseline() {
+        threads.known.resize(64);
+        threads.count = guard_thread_count();
+        size_t found = guard_thread_list(threads.known.data(), threads.known.size());
+        if (found > threads.known.size()) {
+            threads.known.resize(found + 64);
+            found = guard_thread_list(threads.known.data(), threads.known.size());
+        }
+        threads.known.resize(found < threads.known.size() ? found : threads.known.size());
+        threads.valid = threads.count > 0 && !threads.known.empty() && exec_maps.valid;
+        threads.running.clear();
+        threads.pending = false;
+        threads.verdict = SG_VERDICT_PASS;
+    }
+
+    void register_thread(int tid) {
+        auto at = std::lower_bound(threads.known.begin(), threads.known.end(), tid);
+        if (at == threads.known.end() || *at != tid) {
+            threads.known.insert(at, tid);
+        }
+    }
+
+    /*
+     * Where is a thread nobody accounted for executing? Its stopped PC
+     * and the return addresses near the top of its stack must all lie
+     * in code the snapshot accounts for. Returns PASS, the verdict for
+     * the unexpected code found (as SG_CHECK_MAPS would rate its
+     * mapping), or SKIPPED if it cannot be told yet: *running is set
+     * when that is because the thread is on a CPU. Only a thread that
+     * has exited passes uninspected; an unreadable context stays pending.
+     */
+    uint32_t inspect_thread(int tid, bool* running) {
+        uintptr_t sp = 0;
+        uintptr_t pc = 0;
+        const int rc = guard_thread_context(tid, &sp, &pc);
+        *running = rc > 0;
+        if (rc != 0) {
+            return rc == -1 ? SG_VERDICT_PASS : SG_VERDICT_SKIPPED;   /* Gone, or not yet known */
+        }
+        check_exec_maps();
+
+        const guard_exec_mapping_t* holder = nullptr;
+        if (!address_expected(pc, &holder)) {
+            if (holder == nullptr) {
+                exec_maps.stale = true;   /* Mapped since the last read */
+                return SG_VERDICT_SKIPPED;
+            }
+            threads.addr = pc;
+            return unexpected_exec_verdict(holder->kind);
+        }
+
+        uintptr_t words[512];
+        const size_t n = guard_read_self(reinterpret_cast<const void*>(sp), words, sizeof(words)) /
+                         sizeof(words[0]);
+        if (n == 0 && !guard_read_self_available()) {
+            return SG_VERDICT_SKIPPED;   /* Stack unreadable without risking a fault */
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (!address_expected(words[i], &holder) && holder != nullptr) {
+                threads.addr = words[i];
+                return unexpected_exec_verdict(holder->kind);
+            }
+        }
+        return SG_VERDICT_PASS;
+    }
+
+    /*
+     * SG_CHECK_THREADS: list the threads only when num_threads moved
+     * (or one is still uninspected); otherwise the last result stands.
+     */
+    uint32_t check_threads() {
+        if (!threads.valid) {
+            return SG_VERDICT_SKIPPED;
+        }
+        const long count = guard_thread_count();
+        if (count <= 0) {
+            return SG_VERDICT_SKIPPED;
+        }
+        if (count == threads.count && !threads.pending) {
+            return threads.verdict;
+        }
+
+        std::vector<int>& live = threads.live;
+        live.resize(static_cast<size_t>(count) + 16);
+        size_t found = guard_thread_list(live.data(), live.size());
+        if (found > live.size()) {
+            live.resize(found + 16);
+            found = guard_thread_list(live.data(), live.size());
+        }
+        live.resize(found < live.size() ? found : live.size());
+        threads.count = count;
+        threads.pending = false;
+        threads.verdict = SG_VERDICT_PASS;
+
+        /* Merge: exited threads drop out of known, vetted ones join it */
+        std::vector<int> known;
+        std::vector<RunningThread> running;
+        known.reserve(live.size());
+        size_t k = 0;
+        size_t r = 0;
+        for (int tid : live) {
+            while (k < threads.known.size() && threads.known[k] < tid) {
+                ++k;
+            }
+            if (k < threads.known.size() && threads.known[k] == tid) {
+                known.push_back(tid);
+                continue;
+            }
+            bool on_cpu = false;
+            uint32_t verdict = inspect_thread(tid, &on_cpu);
+            if (on_cpu) {
+                /* Consecutive checks it could not be stopped for */
+                while (r < threads.running.size() && threads.running[r].tid < tid) {
+                    ++r;
+                }
+                uint32_t misses = 1;
+                if (r < threads.running.size() && threads.running[r].tid == tid) {
+                    misses += threads.running[r].misses;
+                }
+                running.push_back({tid, misses});
+                if (misses >= THREAD_RUNNING_LIMIT) {
+                    /* Never seen off a CPU: stop relisting for it and say so */
+                    threads.addr = 0;
+                    verdict = SG_VERDICT_SUSPICIOUS;
+                }
+            }
+            if (verdict == SG_VERDICT_PASS) {
+                known.push_back(tid);
+            } else if (verdict == SG_VERDICT_SKIPPED) {
+                threads.pending = true;
+            } else if (threads.verdict != SG_VERDICT_TAMPERED && threads.verdict != verdict) {
+                threads.verdict = verdict;
+                threads.tid = tid;
+                threads.finding = threads.addr;
+            }
+        }
+        threads.known.swap(known);
+        threads.running.swap(running);
+        return threads.verdict;
+    }
+
+    /* Re-read /proc/self/maps at the start of a signature pass */
+    void refresh_anon_ranges() {
+        std::vector<guard_anon_range_t>& ranges = sigscan.ranges;
+        if (ranges.size() < 16) {
+            ranges.resize(16);
+        }
+        size_t found = guard_maps_anon_exec(ranges.data(), ranges.size());
+        if (found > ranges.size()) {
+            ranges.resize(found + 16);
+            found = guard_maps_anon_exec(ranges.data(), ranges.size());
+        }
+        ranges.resize(found < ranges.size() ? found : ranges.size());
+        sigscan.range = 0;
+        sigscan.offset = 0;
+        sigscan.pass_start_units = state_time_now();
+    }
+
+    /*
+     * Scan anonymous executable mappings for the loaded signature set,
+     * continuing the current pass. A slice covers at most slice_pages
+     * system pages' worth of bytes. Returns 1 on a match, 0 if clean,
+     * -1 without a signature set or a fault-tolerant way to read it.
+     */
+    int scan_signatures(sg_detector_result_t& det, bool slice, guard_sig_match_t* match) {
+        if (guard_signatures_generation() == 0) {
+            return -1;
+        }
+        if (!slice || sigscan.range >= sigscan.ranges.size()) {
+            refresh_anon_ranges();
+        }
+
+        size_t budget = SIZE_MAX;
+        if (slice) {
+            const long page = sysconf(_SC_PAGESIZE);
+            budget = static_cast<size_t>(g_opt_slice_pages.load(std::memory_order_relaxed)) *
+                     static_cast<size_t>(page > 0 ? page : 4096);
+        }
+
+        /*
+         * Each chunk is copied out with up to SIG_HISTORY bytes before it
+         * (windows that started in the previous chunk) and a signature's
+         * worth after it (matches that run past the chunk).
+         */
+        if (scan_buffer.size() < SCAN_CHUNK + SG_SIG_MAX_LEN + SIG_HISTORY) {
+            scan_buffer.resize(SCAN_CHUNK + SG_SIG_MAX_LEN + SIG_HISTORY);
+        }
+        while (budget != 0 && sigscan.range < sigscan.ranges.size()) {
+            const guard_anon_range_t& r = sigscan.ranges[sigscan.range];
+            const size_t len = r.end - r.start;
+            size_t n = len - sigscan.offset < budget ? len - sigscan.offset : budget;
+            n = n < SCAN_CHUNK ? n : SCAN_CHUNK;
+            const size_t before = sigscan.offset < SIG_HISTORY ? sigscan.offset : SIG_HISTORY;
+            const size_t rest = len - sigscan.offset - n;
+            const size_t after = rest < SG_SIG_MAX_LEN ? rest : SG_SIG_MAX_LEN;
+            const uintptr_t from = r.start + sigscan.offset - before;
+            const size_t got = guard_read_self(reinterpret_cast<const void*>(from), scan_buffer.data(),
+                                               before + n + after);
+            if (got < before + n) {
+                if (!guard_read_self_available()) {
+                    return -1;   /* No fault-tolerant read: report SKIPPED */
+                }
+                ++sigscan.range;   /* Unmapped under us; move on */
+                sigscan.offset = 0;
+                continue;
+            }
+
+            int rc = guard_signatures_scan(&sigscan.stream, scan_buffer.data(), got, before, n, match);
+            if (rc < 0) {
+                if (sigscan.offset == 0) {
+                    return -1;   /* Unloaded meanwhile */
+                }
+                sigscan.offset = 0;   /* New set: restart this mapping */
+                continue;
+            }
+            det.bytes_verified += n;
+            budget -= n;
+            if (rc > 0) {
+                match->addr = match->addr - reinterpret_cast<uintptr_t>(scan_buffer.data()) + from;
+                sigscan.range = sigscan.ranges.size();   /* Start over next time */
+                return 1;
+            }
+            sigscan.offset += n;
+            if (sigscan.offset == len) {
+                ++sigscan.range;
+                sigscan.offset = 0;
+            }
+        }
+        return 0;
+    }
+
+    /* Journal one detector hit; only reached on the detection path */
+    static void journal_detection(uint8_t detector, sg_security_state_t verdict,
+                                  const void* addr, size_t len, uint64_t detail,
+                                  uint64_t check_start) {
+        guard_journal_emit(SG_JEV_DETECTION, detector, static_cast<uint8_t>(verdict),
+                           reinterpret_cast<uintptr_t>(addr), len, detail,
+                           sg_get_cycle_counter_inline() - check_start);
+    }
+
+    /* Secure memory clearing */
+    static void secure_zero(void* ptr, size_t size) {
+        volatile uint8_t* p = static_cast<volatile uint8_t*>(ptr);
+        for (size_t i = 0; i < size; ++i) {
+            p[i] = 0;
+        }
+    }
+
+public:
+    /*
+     * Fold detector findings into the published word.
+     * COMPROMISED is sticky and WARNING never overrides it. The
+     * timestamp only advances, to verified_units, when that is non-zero
+     * (the requested checks covered everything they check, including a
+     * complete sweep that began then); it never moves back.
+     */
+    void publish_state(bool compromised, bool suspicious, uint64_t verified_units) {
+        uint64_t old_word = state_word.load(std::memory_order_acquire);
+        uint64_t new_word;
+        do {
+            sg_security_state_t state = state_word_state(old_word);
+            if (compromised) {
+                state = SG_COMPROMISED;
+            } else if (suspicious && state == SG_SAFE) {
+                state = SG_WARNING;
+            }
+            uint64_t units = state_word_time(old_word);
+            const uint64_t ahead = (verified_units - units) & STATE_WORD_TIME_MASK;
+            if (verified_units != 0 && (units == 0 || (ahead != 0 && ahead <= STATE_WORD_TIME_MASK / 2))) {
+                units = verified_units;
+            }
+            new_word = make_state_word(state, state_word_generation(old_word) + 1, units);
+        } while (!state_word.compare_exchange_weak(old_word, new_word,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire));
+        mirror_state();
+    }
+
+    /*
+     * Advance the published timestamp to a verification that began at
+     * verified_ns (monotonic), keeping the state; never moves it back.
+     */
+    void publish_verified_at(uint64_t verified_ns) {
+        uint64_t units = (verified_ns >> STATE_TIME_UNIT_SHIFT) & STATE_WORD_TIME_MASK;
+        units = units != 0 ? units : 1;
+        uint64_t old_word = state_word.load(std::memory_order_acquire);
+        uint64_t new_word;
+        do {
+            const uint64_t current = state_word_time(old_word);
+            const uint64_t ahead = (units - current) & STATE_WORD_TIME_MASK;
+            if (current != 0 && (ahead == 0 || ahead > STATE_WORD_TIME_MASK / 2)) {
+                return;
+            }
+            new_word = make_state_word(state_word_state(old_word),
+                                       state_word_generation(old_word) + 1, units);
+        } while (!state_word.compare_exchange_weak(old_word, new_word,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire));
+        mirror_state();
+    }
+
+    /*
+     * Copy the published word into sg-attestd's segment. Re-read until
+     * the word held still across the store, so racing publishers cannot
+     * leave an older word behind. Lock-free: the watch trap handler
+     * publishes too.
+     */
+    void mirror_state() const {
+        if (!guard_attest_active()) {
+            return;
+        }
+        uint64_t word = state_word.load(std::memory_order_acquire);
+        for (;;) {
+            guard_attest_state(word);
+            const uint64_t current = state_word.load(std::memory_order_acquire);
+            if (current == word) {
+                return;
+            }
+            word = current;
+        }
+    }
+
+    /* Mirror state, heartbeat and region roots after sg_attest_attach */
+    void publish_attestation() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        mirror_state();
+        guard_attest_heartbeat(heartbeat.deadline_ns.load(std::memory_order_relaxed));
+        publish_attest_roots();
+    }
+
+    uint64_t published_word() const {
+        return state_word.load(std::memory_order_acquire);
+    }
+
+    SecurityStateManager() : state_word(make_state_word(SG_COMPROMISED, 0, 0)) {
+        secure_zero(&baseline, sizeof(baseline));
+        pages.start = nullptr;
+        pages.size = 0;
+        pages.page_size = 0;
+        pages.granule = 0;
+        pages.sweep_cursor = 0;
+        pages.sweep_start_units = 0;
+        pages.map_base = 0;
+        pages.file_count = 0;
+        pages.count = 0;
+        pages.verity = false;
+        std::memset(&pages.engine, 0, sizeof(pages.engine));
+        module_pages = 0;
+        modules_unreadable = false;
+        std::memset(&repair, 0, sizeof(repair));
+        sigscan.range = 0;
+        sigscan.offset = 0;
+        sigscan.pass_start_units = 0;
+        sigscan.stream.generation = 0;
+        sigscan.stream.state = 0;
+        exec_maps.valid = false;
+        exec_maps.stale = false;
+        exec_maps.verdict = SG_VERDICT_SKIPPED;
+        std::memset(exec_maps.footprint, 0, sizeof(exec_maps.footprint));
+        std::memset(&exec_maps.finding, 0, sizeof(exec_maps.finding));
+        threads.count = 0;
+        threads.valid = false;
+        threads.pending = false;
+        threads.verdict = SG_VERDICT_SKIPPED;
+        threads.tid = 0;
+        threads.finding = 0;
+        threads.addr = 0;
+        monitor.running = false;
+        monitor.stop = false;
+        std::memset(monitor.detector_slo, 0, sizeof(monitor.detector_slo));
+        guard_wheel_init(&monitor.wheel, 0);
+        monitor.wakeups = 0;
+        monitor.slices = 0;
+        monitor.busy_ns = 0;
+        monitor.beat_ns = 0;
+        monitor.stalls = 0;
+        heartbeat.deadline_ns.store(0, std::memory_order_relaxed);
+        heartbeat.count.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& fresh : fresh_units) {
+            fresh.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~SecurityStateManager() {
+        secure_zero(&baseline, sizeof(baseline));
+        clear_page_table();
+        clear_module_tables();
+    }
+
+    bool initialize() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        
+        if (baseline.initialized) {
+            return false;
+        }
+
+        /* Take initial snapshot */
+        baseline.baseline_tsc = sg_get_cycle_counter_inline();
+        baseline.hw_debug_check = k_debug_registers ? 1 : 0;
+        baseline.initialized = 1;
+        state_word.store(make_state_word(SG_SAFE, 0, 0), std::memory_order_release);
+        mirror_state();
+        
+        return true;
+    }
+
+    bool shutdown() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        
+        if (!baseline.initialized) {
+            return false;
+        }
+
+        guard_watch_clear();
+        secure_zero(&baseline, sizeof(baseline));
+        clear_page_table();
+        clear_module_tables();
+        sigscan.ranges.clear();
+        sigscan.range = 0;
+        sigscan.offset = 0;
+        exec_maps.baseline.clear();
+        exec_maps.current.clear();
+        exec_maps.healed.clear();
+        exec_maps.valid = false;
+        threads.known.clear();
+        threads.running.clear();
+        threads.valid = false;
+        monitor.units.clear();
+        monitor.ready.clear();
+        monitor.region_slo.clear();
+        state_word.store(make_state_word(SG_COMPROMISED, 0, 0), std::memory_order_release);
+        for (std::atomic<uint64_t>& fresh : fresh_units) {
+            fresh.store(0, std::memory_order_relaxed);
+        }
+        mirror_state();
+        
+        return true;
+    }
+
+    bool take_snapshot() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (!baseline.initialized) {
+            return false;
+        }
+
+        /* Regions may have moved or gone, even when the snapshot fails */
+        const bool taken = snapshot_locked();
+        build_units(monotonic_ns());
+        return taken;
+    }
+
+    bool check_integrity(uint32_t flags, sg_check_result_t* out) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        return check_locked(flags, out, false, true);
+    }
+
+    /*
+     * Freshness-bounded read: one load and a clock read while the
+     * published state is younger than max_age_ns, otherwise one
+     * bounded slice of the requested checks. The fresh path reports
+     * observed_state(), so a stalled monitor reads as WARNING here too.
+     */
+    sg_security_state_t require_fresh(uint64_t max_age_ns, uint32_t flags) {
+        if (detectors_age_ns(flags, state_time_now()) <= max_age_ns) {
+            return observed_state();
+        }
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+
+        /* Another caller may have refreshed them while we waited */
+        if (detectors_age_ns(flags, state_time_now()) <= max_age_ns) {
+            return observed_state();
+        }
+
+        sg_check_result_t result;
+        if (!check_locked(flags, &result, true, true)) {
+            return SG_COMPROMISED;
+        }
+        return static_cast<sg_security_state_t>(result.state);
+    }
+
+    bool register_current_thread() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        const int tid = guard_thread_self();
+        if (!baseline.initialized || tid < 0) {
+            return false;
+        }
+        register_thread(tid);
+        return true;
+    }
+
+    /* 0 started, 1 already running (or stopping), -1 failure */
+    int start_monitor() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (!baseline.initialized) {
+            return -1;
+        }
+        if (monitor.running) {
+            return 1;
+        }
+        build_units(monotonic_ns());
+        monitor.stop = false;
+        monitor.beat_ns = 0;
+        beat_heartbeat(true);
+        if (pthread_create(&monitor.thread, nullptr, monitor_main, this) != 0) {
+            set_heartbeat(0);
+            return -1;
+        }
+        monitor.running = true;
+        return 0;
+    }
+
+    bool stop_monitor() {
+        pthread_t thread;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (!monitor.running || monitor.stop) {
+                return false;
+            }
+            monitor.stop = true;
+            set_heartbeat(0);
+            monitor.wake.notify_all();
+            thread = monitor.thread;
+        }
+        pthread_join(thread, nullptr);
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        monitor.running = false;
+        return true;
+    }
+
+    /* SG_OPT_MONITOR_STALL_MS changed: apply it now rather than at the next beat */
+    void rearm_heartbeat() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (monitor.running && !monitor.stop) {
+            beat_heartbeat(true);
+            monitor.wake.notify_all();
+        }
+    }
+
+    bool set_slo(uint32_t detector, uint64_t max_staleness_ns) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (!baseline.initialized || detector >= SG_DETECTOR_MAX) {
+            return false;
+        }
+        monitor.detector_slo[detector] = max_staleness_ns;
+        build_units(monotonic_ns());
+        return true;
+    }
+
+    bool set_region_slo(const void* addr, uint64_t max_staleness_ns) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        const uint8_t* start = baseline.initialized ? region_containing(addr) : nullptr;
+        if (start == nullptr) {
+            return false;
+        }
+        auto& overrides = monitor.region_slo;
+        auto it = std::find_if(overrides.begin(), overrides.end(), [&](const std::pair<uintptr_t, uint64_t>& entry) {
+            return entry.first == reinterpret_cast<uintptr_t>(start);
+        });
+        if (it != overrides.end()) {
+            overrides.erase(it);
+        }
+        if (max_staleness_ns != 0) {
+            overrides.emplace_back(reinterpret_cast<uintptr_t>(start), max_staleness_ns);
+        }
+        build_units(monotonic_ns());
+        return true;
+    }
+
+    /* Applied by the next snapshot; the tables in use keep their granule */
+    bool set_region_granule(const void* addr, size_t bytes) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        const uint8_t* start = baseline.initialized ? region_containing(addr) : nullptr;
+        if (start == nullptr || (bytes != 0 && !granule_valid(bytes, pages.page_size))) {
+            return false;
+        }
+        auto it = std::find_if(region_granules.begin(), region_granules.end(),
+                               [&](const std::pair<uintptr_t, size_t>& entry) {
+            return entry.first == reinterpret_cast<uintptr_t>(start);
+        });
+        if (it != region_granules.end()) {
+            region_granules.erase(it);
+        }
+        if (bytes != 0) {
+            region_granules.emplace_back(reinterpret_cast<uintptr_t>(start), bytes);
+        }
+        return true;
+    }
+
+    void get_stats(sg_stats_t* out) {
+        std::memset(out, 0, sizeof(*out));
+        std::lock_guard<std::mutex> lock(state_mutex);
+        const uint64_t now = monotonic_ns();
+        out->monitor_running = monitor.running && !monitor.stop ? 1 : 0;
+        out->unit_count = static_cast<uint32_t>(monitor.units.size());
+        out->wakeups = monitor.wakeups;
+        out->slices = monitor.slices;
+        out->busy_ns = monitor.busy_ns;
+        out->heartbeats = heartbeat.count.load(std::memory_order_relaxed);
+        out->stalls = monitor.stalls;
+        for (size_t i = 0; i < monitor.units.size() && i < SG_STATS_MAX_UNITS; ++i) {
+            const SloUnit& unit = monitor.units[i];
+            out->units[i] = unit.stats;
+            out->units[i].staleness_ns = now - unit.verified_ns;
+        }
+    }
+
+    void get_repair_info(sg_repair_info_t* out) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        *out = repair;
+    }
+
+    void get_state_info(sg_state_info_t* out) const {
+        uint64_t word = state_word.load(std::memory_order_acquire);
+        sg_security_state_t state = state_word_state(word);
+        out->state = static_cast<uint32_t>(state == SG_SAFE && heartbeat_missed() ? SG_WARNING : state);
+        out->generation = static_cast<uint32_t>(state_word_generation(word));
+        out->age_ns = state_time_age_ns(state_word_time(word), state_time_now());
+    }
+
+private:
+    /* Rebuild every baseline; caller holds state_mutex */
+    bool snapshot_locked() {
+        /* Get code section */
+        CodeSection code = get_code_section();
+        
+        if (code.available) {
+            if (!build_page_table(code)) {
+                return false;
+            }
+            if (pages.verity) {
+                std::memcpy(&baseline.code_checksum, pages.verity_info.file_digest,
+                            sizeof(baseline.code_checksum));
+            } else {
+                baseline.code_checksum = fold_page_digests();
+            }
+            if (!build_module_tables()) {
+                return false;
+            }
+        } else {
+            /* If code section unavailable, checksum our own data structure */
+            baseline.code_checksum = sg_checksum_memory(&baseline, sizeof(baseline));
+        }
+        build_exec_baseline();
+        build_thread_baseline();
+        publish_attest_roots();
+
+        guard_journal_emit(SG_JEV_SNAPSHOT, SG_DETECTOR_MEMORY,
+                           static_cast<uint8_t>(get_state()),
+                           reinterpret_cast<uintptr_t>(code.start), code.size,
+                           baseline.code_checksum, 0);
+        
+        return true;
+    }
+
+    /* Root of one region's digest table (see sg_attest_region_t) */
+    static sg_attest_region_t attest_region(const uint8_t* start, size_t size, size_t granule,
+                                            uint32_t hash, const std::vector<uint32_t>& digests) {
+        sg_attest_region_t region;
+        std::memset(&region, 0, sizeof(region));
+        region.addr = reinterpret_cast<uintptr_t>(start);
+        region.len = size;
+        region.granule = static_cast<uint32_t>(granule);
+        region.hash = hash;
+
+        uint8_t prefix[16];
+        const uint64_t len = size;
+        for (unsigned i = 0; i < 4; ++i) {
+            prefix[i] = static_cast<uint8_t>(hash >> (8 * i));
+            prefix[4 + i] = static_cast<uint8_t>(region.granule >> (8 * i));
+        }
+        for (unsigned i = 0; i < 8; ++i) {
+            prefix[8 + i] = static_cast<uint8_t>(len >> (8 * i));
+        }
+        guard_sha256_t ctx;
+        guard_sha256_init(&ctx);
+        guard_sha256_update(&ctx, prefix, sizeof(prefix));
+        guard_sha256_update(&ctx, digests.data(), digests.size() * sizeof(uint32_t));
+        guard_sha256_final(&ctx, region.root);
+        return region;
+    }
+
+    /* Hand the baseline's region roots to sg-attestd; caller holds state_mutex */
+    void publish_attest_roots() {
+        if (!guard_attest_active()) {
+            return;
+        }
+        std::vector<sg_attest_region_t> regions;
+        if (pages.start != nullptr) {
+            regions.reserve(1 + modules.size());
+            if (pages.verity) {
+                sg_attest_region_t region;
+                std::memset(&region, 0, sizeof(region));
+                region.addr = reinterpret_cast<uintptr_t>(pages.start);
+                region.len = pages.size;
+                region.granule = static_cast<uint32_t>(pages.granule);
+                region.hash = SG_ATTEST_HASH_FSVERITY;
+                std::memcpy(region.root, pages.verity_info.file_digest, sizeof(region.root));
+                regions.push_back(region);
+            } else {
+                regions.push_back(attest_region(pages.start, pages.size, pages.granule,
+                                                pages.engine.hash, pages.digests));
+            }
+            for (const ModuleRegion& module : modules) {
+                regions.push_back(attest_region(module.start, module.size, module.granule,
+                                                module.engine.hash, module.digests));
+            }
+        }
+        guard_attest_roots(regions.data(), regions.size());
+    }
+
+    /* Fold a check into the published state and journal any transition */
+    void publish_result(sg_check_result_t* out, bool compromised, bool suspicious,
+                        uint64_t verified_units, uint64_t check_start) {
+        sg_security_state_t previous = get_state();
+        publish_state(compromised, suspicious, verified_units);
+
+        sg_security_state_t now = get_state();
+        out->total_cycles = sg_get_cycle_counter_inline() - check_start;
+        out->state = static_cast<uint32_t>(now);
+        if (now != previous) {
+            guard_journal_emit(SG_JEV_STATE, 0xFF, static_cast<uint8_t>(now),
+                               0, 0, static_cast<uint64_t>(previous), out->total_cycles);
+        }
+    }
+
+    /*
+     * Run the requested detectors; caller holds state_mutex.
+     * claim_fresh = false keeps a complete run from advancing the
+     * published timestamp (the monitor accounts for that itself).
+     */
+    bool check_locked(uint32_t flags, sg_check_result_t* out, bool slice, bool claim_fresh) {
+        if (!baseline.initialized) {
+            return false;
+        }
+
+        std::memset(out, 0, sizeof(*out));
+        out->flags_requested = flags;
+
+        bool suspicious = false;
+        bool compromised = false;
+        bool sweep_complete = (flags & SG_CHECK_MEMORY) != 0;
+        const uint64_t check_start = sg_get_cycle_counter_inline();
+        const uint64_t start_units = state_time_now();
+        uint64_t memory_units = start_units;   /* When the completed sweep began */
+        uint64_t sig_units = start_units;      /* When the completed signature pass began */
+
+        /* Debugger detection */
+        if (flags & SG_CHECK_DEBUGGER) {
+            sg_detector_result_t& det = out->detectors[SG_DETECTOR_DEBUGGER];
+            uint64_t t0 = sg_get_cycle_counter_inline();
+            int dbg_result = detect_debugger();
+            det.cycles = sg_get_cycle_counter_inline() - t0;
+            det.verdict = dbg_result > 0 ? SG_VERDICT_TAMPERED :
+                          dbg_result < 0 ? SG_VERDICT_UNAVAILABLE : SG_VERDICT_PASS;
+            if (dbg_result > 0) {
+                compromised = true;
+                journal_detection(SG_DETECTOR_DEBUGGER, SG_COMPROMISED,
+                                  nullptr, 0, static_cast<uint64_t>(dbg_result), check_start);
+            }
+        }
+
+        /* Timing analysis */
+        if (flags & SG_CHECK_TIMING) {
+            sg_detector_result_t& det = out->detectors[SG_DETECTOR_TIMING];
+            uint64_t t0 = sg_get_cycle_counter_inline();
+            int timing_result = sg_timing_check_inline();
+            det.cycles = sg_get_cycle_counter_inline() - t0;
+            det.verdict = timing_result > 0 ? SG_VERDICT_SUSPICIOUS : SG_VERDICT_PASS;
+            if (timing_result > 0) {
+                suspicious = true;
+                journal_detection(SG_DETECTOR_TIMING, SG_WARNING,
+                                  nullptr, 0, static_cast<uint64_t>(timing_result), check_start);
+            }
+        }
+
+        /* Memory integrity */
+        if (flags & SG_CHECK_MEMORY) {
+            sg_detector_result_t& det = out->detectors[SG_DETECTOR_MEMORY];
+            uint64_t t0 = sg_get_cycle_counter_inline();
+            CodeSection code = get_code_section();
+            
+            if (code.available && pages.count != 0) {
+                const uint64_t repairs_before = repair.repairs;
+                const size_t count = pages.count + module_pages;
+                size_t first = 0;
+                size_t n = count;
+                if (slice) {
+                    first = pages.sweep_cursor < count ? pages.sweep_cursor : 0;
+                    n = slice_blocks(first);
+                }
+                if (first == 0) {
+                    pages.sweep_start_units = start_units;
+                }
+                memory_units = pages.sweep_start_units;
+
+                /* Main region first, then the shared libraries */
+                const size_t main_n = first < pages.count
+                    ? (n < pages.count - first ? n : pages.count - first) : 0;
+                bool intact = (main_n == 0 || verify_pages(det, out, first, main_n)) &&
+                              (main_n == n || verify_module_pages(det, out, first, n));
+                if (intact) {
+                    size_t next = first + n;
+                    sweep_complete = (next == count);
+                    pages.sweep_cursor = sweep_complete ? 0 : next;
+                    out->pages_remaining = count - next;
+                } else {
+                    pages.sweep_cursor = 0;
+                }
+
+                if (!intact) {
+                    compromised = true;
+                    det.verdict = SG_VERDICT_TAMPERED;
+                    journal_detection(SG_DETECTOR_MEMORY, SG_COMPROMISED,
+                                      reinterpret_cast<const void*>(out->first_mismatch_addr),
+                                      pages.page_size, det.bytes_verified, check_start);
+                } else if (repair.repairs != repairs_before) {
+                    /* Service continues, but someone wrote to our code */
+                    suspicious = true;
+                    det.verdict = SG_VERDICT_REPAIRED;
+                } else if (modules_unreadable) {
+                    /* Libraries went unverified: do not call the detector clean */
+                    det.verdict = SG_VERDICT_SKIPPED;
+                } else {
+                    det.verdict = SG_VERDICT_PASS;
+                }
+            } else if (code.available) {
+                /* No baseline to compare against: fail secure */
+                sweep_complete = false;
+                compromised = true;
+                det.verdict = SG_VERDICT_TAMPERED;
+                out->first_mismatch_addr = reinterpret_cast<uintptr_t>(code.start);
+                journal_detection(SG_DETECTOR_MEMORY, SG_COMPROMISED,
+                                  code.start, code.size, 0, check_start);
+            } else {
+                /* Fallback: check our own structure integrity */
+                uint32_t current_checksum = sg_checksum_memory(&baseline, sizeof(baseline));
+                det.bytes_verified = sizeof(baseline);
+                det.verdict = SG_VERDICT_PASS;
+                
+                /* This is a weaker check but better than nothing */
+                if (current_checksum != baseline.code_checksum) {
+                    suspicious = true;
+                    det.verdict = SG_VERDICT_SUSPICIOUS;
+                    out->first_mismatch_addr = reinterpret_cast<uintptr_t>(&baseline);
+                    journal_detection(SG_DETECTOR_MEMORY, SG_WARNING,
+                                      &baseline, sizeof(baseline), current_checksum, check_start);
+                }
+            }
+            det.cycles = sg_get_cycle_counter_inline() - t0;
+        }
+
+        /* Known-bad code in anonymous executable memory */
+        if (flags & SG_CHECK_SIGNATURES) {
+            sg_detector_result_t& det = out->detectors[SG_DETECTOR_SIGNATURES];
+            uint64_t t0 = sg_get_cycle_counter_inline();
+            guard_sig_match_t match;
+            int sig_result = scan_signatures(det, slice, &match);
+            det.cycles = sg_get_cycle_counter_inline() - t0;
+            if (sig_result >= 0) {
+                sig_units = sigscan.pass_start_units;
+            }
+            if (sig_result > 0) {
+                compromised = true;
+                det.verdict = SG_VERDICT_TAMPERED;
+                if (out->first_mismatch_addr == 0) {
+                    out->first_mismatch_addr = match.addr;
+                }
+                journal_detection(SG_DETECTOR_SIGNATURES, SG_COMPROMISED,
+                                  reinterpret_cast<const void*>(match.addr), match.len,
+                                  match.id, check_start);
+            } else if (sig_result == 0) {
+                det.verdict = SG_VERDICT_PASS;
+            }
+        }
+
+        /* Executable mappings that were not there at snapshot time */
+        if (flags & SG_CHECK_MAPS) {
+            sg_detector_result_t& det = out->detectors[SG_DETECTOR_MAPS];
+            uint64_t t0 = sg_get_cycle_counter_inline();
+            det.verdict = check_exec_maps();
+            det.cycles = sg_get_cycle_counter_inline() - t0;
+            if (det.verdict == SG_VERDICT_SUSPICIOUS || det.verdict == SG_VERDICT_TAMPERED) {
+                const guard_exec_mapping_t& found = exec_maps.finding;
+                const bool tampered = det.verdict == SG_VERDICT_TAMPERED;
+                compromised = compromised || tampered;
+                suspicious = suspicious || !tampered;
+                if (out->first_mismatch_addr == 0) {
+                    out->first_mismatch_addr = found.start;
+                }
+                journal_detection(SG_DETECTOR_MAPS, tampered ? SG_COMPROMISED : SG_WARNING,
+                                  reinterpret_cast<const void*>(found.start), found.end - found.start,
+                                  static_cast<uint64_t>(found.kind), check_start);
+            }
+        }
+
+        /* Threads that nobody created through a known path */
+        if (flags & SG_CHECK_THREADS) {
+            sg_detector_result_t& det = out->detectors[SG_DETECTOR_THREADS];
+            uint64_t t0 = sg_get_cycle_counter_inline();
+            det.verdict = check_threads();
+            det.cycles = sg_get_cycle_counter_inline() - t0;
+            if (det.verdict == SG_VERDICT_SUSPICIOUS || det.verdict == SG_VERDICT_TAMPERED) {
+                const bool tampered = det.verdict == SG_VERDICT_TAMPERED;
+                compromised = compromised || tampered;
+                suspicious = suspicious || !tampered;
+                if (out->first_mismatch_addr == 0) {
+                    out->first_mismatch_addr = threads.finding;
+                }
+                journal_detection(SG_DETECTOR_THREADS, tampered ? SG_COMPROMISED : SG_WARNING,
+                                  reinterpret_cast<const void*>(threads.finding), 0,
+                                  static_cast<uint64_t>(threads.tid), check_start);
+            }
+        }
+
+        /* Watched words (sg_watch); trapping watches already raised state */
+        if (flags & SG_CHECK_WATCH) {
+            sg_detector_result_t& det = out->detectors[SG_DETECTOR_WATCH];
+            uint64_t t0 = sg_get_cycle_counter_inline();
+            guard_watch_hit_t hit;
+            int tripped = guard_watch_poll(&hit);
+            det.cycles = sg_get_cycle_counter_inline() - t0;
+            if (tripped > 0) {
+                compromised = true;
+                det.verdict = SG_VERDICT_TAMPERED;
+                if (out->first_mismatch_addr == 0) {
+                    out->first_mismatch_addr = hit.addr;
+                }
+                journal_detection(SG_DETECTOR_WATCH, SG_COMPROMISED,
+                                  reinterpret_cast<const void*>(hit.addr), hit.len, hit.hits,
+                                  check_start);
+            } else if (tripped == 0) {
+                det.verdict = SG_VERDICT_PASS;
+            }
+        }
+
+        /* Requested detectors without an implementation on this build */
+        for (uint32_t d = 0; d < SG_DETECTOR_MAX; ++d) {
+            if ((flags & (1u << d)) && out->detectors[d].verdict == SG_VERDICT_SKIPPED) {
+                out->detectors[d].verdict = SG_VERDICT_UNAVAILABLE;
+            }
+        }
+
+        /* Detectors that covered everything they check this time */
+        if (claim_fresh) {
+            uint32_t complete = flags & DETECTOR_MASK;
+            if (!sweep_complete) {
+                complete &= ~SG_CHECK_MEMORY;
+            }
+            if (slice && sigscan.range < sigscan.ranges.size()) {
+                complete &= ~(1u << SG_DETECTOR_SIGNATURES);
+            }
+            if (threads.pending) {
+                complete &= ~(1u << SG_DETECTOR_THREADS);
+            }
+            /* A sliced pass is only as fresh as its first slice */
+            const uint32_t memory_bit = 1u << SG_DETECTOR_MEMORY;
+            const uint32_t sig_bit = 1u << SG_DETECTOR_SIGNATURES;
+            stamp_fresh(complete & ~(memory_bit | sig_bit), start_units);
+            stamp_fresh(complete & memory_bit, memory_units);
+            stamp_fresh(complete & sig_bit, sig_units);
+        }
+
+        /* Update state based on findings */
+        publish_result(out, compromised, suspicious,
+                       sweep_complete && claim_fresh ? memory_units : 0, check_start);
+        return true;
+    }
+
+    /* Move the freshness of detectors forward to units; never back */
+    void stamp_fresh(uint32_t detectors, uint64_t units) {
+        detectors &= DETECTOR_MASK;
+        while (detectors != 0) {
+            const unsigned d = static_cast<unsigned>(__builtin_ctz(detectors));
+            detectors &= detectors - 1;
+            const uint64_t current = fresh_units[d].load(std::memory_order_relaxed);
+            const uint64_t ahead = (units - current) & STATE_WORD_TIME_MASK;
+            if (current == 0 || (ahead != 0 && ahead <= STATE_WORD_TIME_MASK / 2)) {
+                fresh_units[d].store(units, std::memory_order_release);
+            }
+        }
+    }
+
+    /* Age of the stalest detector in flags, UINT64_MAX if one never completed */
+    uint64_t detectors_age_ns(uint32_t flags, uint64_t now_units) const {
+        uint64_t age = 0;
+        flags &= DETECTOR_MASK;
+        while (flags != 0) {
+            const unsigned d = static_cast<unsigned>(__builtin_ctz(flags));
+            flags &= flags - 1;
+            const uint64_t detector_age =
+                state_time_age_ns(fresh_units[d].load(std::memory_order_acquire), now_units);
+            age = detector_age > age ? detector_age : age;
+        }
+        return age;
+    }
+
+    /* Bytes a slice verifies: SG_OPT_SLICE_PAGES system pages */
+    size_t slice_bytes() const {
+        return static_cast<size_t>(g_opt_slice_pages.load(std::memory_order_relaxed)) * pages.page_size;
+    }
+
+    /*
+     * Blocks of the sweep from global block first that fit in
+     * slice_bytes(), crossing into following regions with their own
+     * granules; at least one, so a coarse block is never starved.
+     */
+    size_t slice_blocks(size_t first) const {
+        size_t budget = slice_bytes();
+        size_t n = 0;
+        size_t base = 0;
+        auto take = [&](size_t count, size_t granule) {
+            const size_t at = first + n;
+            if (budget != 0 && at < base + count) {
+                const size_t left = base + count - at;
+                size_t k = std::max<size_t>(budget / granule, n == 0 ? 1 : 0);
+                if (k < left) {
+                    budget = 0;   /* The run must stay contiguous */
+                } else {
+                    k = left;
+                    budget -= std::min(budget, k * granule);
+                }
+                n += k;
+            }
+            base += count;
+        };
+        take(pages.count, pages.granule);
+        for (const ModuleRegion& region : modules) {
+            take(region.count, region.granule);
+        }
+        return n;
+    }
+
+    /* The monitor's SLO for a memory region: its override, else the detector's */
+    uint64_t region_slo_for(const uint8_t* start) const {
+        for (const auto& entry : monitor.region_slo) {
+            if (entry.first == reinterpret_cast<uintptr_t>(start)) {
+                return entry.second;
+            }
+        }
+        return monitor.detector_slo[SG_DETECTOR_MEMORY];
+    }
+
+    /* Start of the snapshot region (main image or module text) holding addr, or nullptr */
+    const uint8_t* region_containing(const void* addr) const {
+        const uint8_t* p = static_cast<const uint8_t*>(addr);
+        if (pages.count != 0 && p >= pages.start && p < pages.start + pages.size) {
+            return pages.start;
+        }
+        for (const ModuleRegion& region : modules) {
+            if (p >= region.start && p < region.start + region.size) {
+                return region.start;
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+     * Queue the next pass of unit to end by its deadline: as late as
+     * twice its recent pass time allows, so an idle unit costs nothing
+     * until then. The SLO/16 margin absorbs units whose deadlines
+     * coincide and queue behind each other. A late unit becomes ready
+     * right away.
+     */
+    void schedule_unit(SloUnit& unit, uint64_t now) {
+        unit.deadline_ns = unit.verified_ns + unit.slo_ns;
+        const uint64_t lead = 2 * unit.pass_wall_ns + unit.slo_ns / 16 + (2ULL << MONITOR_TICK_SHIFT);
+        const uint64_t start = unit.deadline_ns > now + lead ? unit.deadline_ns - lead : now;
+        guard_wheel_add(&monitor.wheel, &unit.timer, start >> MONITOR_TICK_SHIFT);
+    }
+
+    /*
+     * Derive the units from the SLOs and the snapshot regions. Units
+     * that survive keep their statistics and last verification.
+     */
+    void build_units(uint64_t now) {
+        std::vector<SloUnit> previous;
+        previous.swap(monitor.units);
+        monitor.ready.clear();
+        guard_wheel_init(&monitor.wheel, now >> MONITOR_TICK_SHIFT);
+
+        auto add = [&](uint32_t detector, const uint8_t* start, size_t len, size_t granule,
+                       size_t first, size_t count, uint64_t slo) {
+            if (slo == 0) {
+                return;
+            }
+            SloUnit unit{};
+            unit.detector = detector;
+            unit.start = start;
+            unit.len = len;
+            unit.granule = granule;
+            unit.first = first;
+            unit.count = count;
+            unit.slo_ns = slo;
+            unit.verified_ns = now;
+            unit.stats.detector = detector;
+            unit.stats.region_addr = reinterpret_cast<uintptr_t>(start);
+            unit.stats.region_len = len;
+            for (const SloUnit& old : previous) {
+                if (old.detector == detector && old.start == start && old.len == len) {
+                    unit.verified_ns = old.verified_ns;
+                    unit.pass_wall_ns = old.pass_wall_ns;
+                    unit.stats = old.stats;
+                    break;
+                }
+            }
+            unit.stats.slo_ns = slo;
+            unit.stats.granule = static_cast<uint32_t>(granule);
+            monitor.units.push_back(unit);
+        };
+
+        if (pages.count != 0) {
+            add(SG_DETECTOR_MEMORY, pages.start, pages.size, pages.granule, 0, pages.count,
+                region_slo_for(pages.start));
+            size_t base = pages.count;
+            for (const ModuleRegion& region : modules) {
+                add(SG_DETECTOR_MEMORY, region.start, region.size, region.granule, base, region.count,
+                    region_slo_for(region.start));
+                base += region.count;
+            }
+        }
+        for (uint32_t d = 0; d < SG_DETECTOR_MAX; ++d) {
+            if (d != SG_DETECTOR_MEMORY) {
+                add(d, nullptr, 0, 0, 0, 0, monitor.detector_slo[d]);
+            }
+        }
+
+        for (SloUnit& unit : monitor.units) {
+            schedule_unit(unit, now);
+        }
+        monitor.wake.notify_all();
+    }
+
+    /* Verify the next slice of a memory unit's pages */
+    bool verify_region_slice(SloUnit& unit, sg_check_result_t* out) {
+        std::memset(out, 0, sizeof(*out));
+        out->flags_requested = SG_CHECK_MEMORY;
+        const uint64_t check_start = sg_get_cycle_counter_inline();
+        sg_detector_result_t& det = out->detectors[SG_DETECTOR_MEMORY];
+
+        const size_t limit = slice_bytes() / unit.granule != 0 ? slice_bytes() / unit.granule : 1;
+        const size_t n = unit.count - unit.cursor < limit ? unit.count - unit.cursor : limit;
+        const size_t first = unit.first + unit.cursor;
+        const uint64_t repairs_before = repair.repairs;
+        const bool intact = n == 0 ||
+            (first < pages.count ? verify_pages(det, out, first, n)
+                                 : verify_module_pages(det, out, first, n));
+        det.cycles = sg_get_cycle_counter_inline() - check_start;
+
+        bool compromised = false;
+        bool suspicious = false;
+        if (!intact) {
+            /* COMPROMISED is sticky; end the pass rather than re-find it */
+            compromised = true;
+            det.verdict = SG_VERDICT_TAMPERED;
+            unit.cursor = unit.count;
+            journal_detection(SG_DETECTOR_MEMORY, SG_COMPROMISED,
+                              reinterpret_cast<const void*>(out->first_mismatch_addr),
+                              pages.page_size, det.bytes_verified, check_start);
+        } else {
+            unit.cursor += n;
+            suspicious = repair.repairs != repairs_before;
+            det.verdict = suspicious ? SG_VERDICT_REPAIRED :
+                          modules_unreadable && first >= pages.count ? SG_VERDICT_SKIPPED : SG_VERDICT_PASS;
+        }
+        out->pages_remaining = unit.count - unit.cursor;
+        publish_result(out, compromised, suspicious, 0, check_start);
+        return unit.cursor == unit.count;
+    }
+
+    /* One bounded slice of unit's pass; true once the pass is complete */
+    bool run_unit_slice(SloUnit& unit, uint64_t now) {
+        if (unit.pass_start_ns == 0) {
+            unit.pass_start_ns = now;
+            unit.cursor = 0;
+        }
+        sg_check_result_t result;
+        if (unit.detector == SG_DETECTOR_MEMORY) {
+            return verify_region_slice(unit, &result);
+        }
+        check_locked(1u << unit.detector, &result, true, false);
+        return unit.detector != SG_DETECTOR_SIGNATURES || sigscan.range >= sigscan.ranges.size();
+    }
+
+    /*
+     * Account for a complete pass and queue the next one. Staleness is
+     * sampled here, where it peaks: the data it replaces was verified
+     * from the start of the previous pass.
+     */
+    void complete_pass(SloUnit& unit, uint64_t now) {
+        sg_slo_stats_t& stats = unit.stats;
+        const uint64_t staleness = now - unit.verified_ns;
+        const uint64_t bucket = staleness / (unit.slo_ns / 8 != 0 ? unit.slo_ns / 8 : 1);
+        stats.histogram[bucket < SG_SLO_BUCKETS ? bucket : SG_SLO_BUCKETS - 1]++;
+        stats.passes++;
+        if (staleness > unit.slo_ns) {
+            stats.misses++;
+        }
+        if (staleness > stats.max_staleness_ns) {
+            stats.max_staleness_ns = staleness;
+        }
+
+        const uint64_t wall = now - unit.pass_start_ns;
+        unit.pass_wall_ns = unit.pass_wall_ns != 0 ? (3 * unit.pass_wall_ns + wall) / 4 : wall;
+        unit.verified_ns = unit.pass_start_ns;
+        unit.pass_start_ns = 0;
+        schedule_unit(unit, now);
+
+        /* The detector is as fresh as its stalest unit, once all have passed */
+        uint64_t oldest = UINT64_MAX;
+        for (const SloUnit& other : monitor.units) {
+            if (other.detector != unit.detector) {
+                continue;
+            }
+            if (other.stats.passes == 0) {
+                return;
+            }
+            oldest = other.verified_ns < oldest ? other.verified_ns : oldest;
+        }
+        uint64_t units = (oldest >> STATE_TIME_UNIT_SHIFT) & STATE_WORD_TIME_MASK;
+        stamp_fresh(1u << unit.detector, units != 0 ? units : 1);
+        if (unit.detector == SG_DETECTOR_MEMORY) {
+            publish_verified_at(oldest);
+        }
+    }
+
+    /*
+     * Move the heartbeat deadline to now + SG_OPT_MONITOR_STALL_MS, at
+     * most every quarter of it so readers mostly hit the line in their
+     * cache. A deadline already passed is counted and journaled: readers
+     * saw WARNING meanwhile. Returns how long the monitor may sleep
+     * before it is due to beat again, UINT64_MAX if liveness is off.
+     */
+    uint64_t beat_heartbeat(bool force) {
+        const uint64_t stall_ns = g_opt_monitor_stall_ms.load(std::memory_order_relaxed) * 1000000ULL;
+        const uint64_t now = coarse_ns();
+        if (stall_ns == 0) {
+            if (heartbeat.deadline_ns.load(std::memory_order_relaxed) != 0) {
+                set_heartbeat(0);
+            }
+            return UINT64_MAX;
+        }
+
+        const uint64_t interval = stall_ns / 4;
+        if (force || now - monitor.beat_ns >= interval) {
+            const uint64_t deadline = heartbeat.deadline_ns.load(std::memory_order_relaxed);
+            if (deadline != 0 && now > deadline) {
+                monitor.stalls++;
+                journal_detection(SG_DETECTOR_TIMING, SG_WARNING, nullptr, 0,
+                                  now - monitor.beat_ns, sg_get_cycle_counter_inline());
+            }
+            set_heartbeat(now + stall_ns);
+            heartbeat.count.store(heartbeat.count.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+            monitor.beat_ns = now;
+        }
+        return monitor.beat_ns + interval - now;
+    }
+
+    /* Move the deadline readers compare against, here and in sg-attestd's copy */
+    void set_heartbeat(uint64_t deadline_ns) {
+        heartbeat.deadline_ns.store(deadline_ns, std::memory_order_relaxed);
+        guard_attest_heartbeat(deadline_ns);
+    }
+
+    bool heartbeat_missed() const {
+        const uint64_t deadline = heartbeat.deadline_ns.load(std::memory_order_relaxed);
+        return deadline != 0 && coarse_ns() > deadline;
+    }
+
+    static bool deadline_after(const SloUnit* a, const SloUnit* b) {
+        return a->deadline_ns > b->deadline_ns;
+    }
+
+    /*
+     * Monitor thread: move expired timers to the ready heap, run the
+     * ready unit with the earliest deadline one slice at a time, and
+     * sleep until the wheel's next expiry or heartbeat when nothing is
+     * ready.
+     */
+    void monitor_loop() {
+        std::unique_lock<std::mutex> lock(state_mutex);
+        const int tid = guard_thread_self();
+        if (tid >= 0) {
+            register_thread(tid);
+        }
+
+        while (!monitor.stop) {
+            const uint64_t beat_wait = beat_heartbeat(false);
+            uint64_t now = monotonic_ns();
+            guard_wheel_timer_t* expired = guard_wheel_advance(&monitor.wheel, now >> MONITOR_TICK_SHIFT);
+            while (expired != nullptr) {
+                guard_wheel_timer_t* next = expired->next;
+                monitor.ready.push_back(reinterpret_cast<SloUnit*>(expired));
+                std::push_heap(monitor.ready.begin(), monitor.ready.end(), deadline_after);
+                expired = next;
+            }
+
+            if (!monitor.ready.empty()) {
+                std::pop_heap(monitor.ready.begin(), monitor.ready.end(), deadline_after);
+                SloUnit* unit = monitor.ready.back();
+                monitor.ready.pop_back();
+
+                const bool complete = run_unit_slice(*unit, now);
+                const uint64_t end = monotonic_ns();
+                unit->stats.busy_ns += end - now;
+                monitor.busy_ns += end - now;
+                monitor.slices++;
+                if (complete) {
+                    complete_pass(*unit, end);
+                } else {
+                    monitor.ready.push_back(unit);
+                    std::push_heap(monitor.ready.begin(), monitor.ready.end(), deadline_after);
+                }
+
+                /* Let API callers in between slices */
+                lock.unlock();
+                sched_yield();
+                lock.lock();
+                continue;
+            }
+
+            const uint64_t next_tick = guard_wheel_next(&monitor.wheel);
+            uint64_t wait_ns = beat_wait;
+            if (next_tick != UINT64_MAX) {
+                const uint64_t due = next_tick << MONITOR_TICK_SHIFT;
+                const uint64_t until = due > now ? due - now : 0;
+                wait_ns = until < wait_ns ? until : wait_ns;
+            }
+            if (wait_ns == UINT64_MAX) {
+                monitor.wake.wait(lock);
+            } else if (wait_ns != 0) {
+                monitor.wake.wait_for(lock, std::chrono::nanoseconds(wait_ns));
+            }
+            monitor.wakeups++;
+        }
+    }
+
+    static void* monitor_main(void* self) {
+        static_cast<SecurityStateManager*>(self)->monitor_loop();
+        return nullptr;
+    }
+
+public:
+    int detect_debugger() const {
+        /* No lock needed - read-only after initialize() */
+        if (baseline.hw_debug_check) {
+            return sg_low_level_check_inline();
+        }
+        return tracer_pid_check();
+    }
+
+    sg_security_state_t get_state() const {
+        return state_word_state(state_word.load(std::memory_order_acquire));
+    }
+
+    /*
+     * The state reported to callers: SAFE reads as WARNING while a
+     * running monitor is past its heartbeat deadline (stopped, traced,
+     * starved), so suspending it cannot freeze the state at SAFE.
+     * Costs one load of the heartbeat line and a coarse clock read.
+     */
+    sg_security_state_t observed_state() const {
+        const sg_security_state_t state = get_state();
+        return state == SG_SAFE && heartbeat_missed() ? SG_WARNING : state;
+    }
+};
+
+/*
+ * Global state manager (singleton pattern). Atomic because the SIGTRAP
+ * handler of a trapping watch loads it on any thread; shutdown waits
+ * for handlers still inside (g_watch_handlers) before deleting it.
+ */
+static std::atomic<SecurityStateManager*> g_state_manager(nullptr);
+static std::atomic<uint32_t> g_watch_handlers(0);
+
+/* ============================================
+ * C Interface Implementation
+ * CRITICAL: extern "C" prevents name mangling
+ * ============================================ */
+
+extern "C" {
+
+int guard_core_init(void) {
+    if (g_state_manager != nullptr) {
+        return -1;
+    }
+
+    SecurityStateManager* manager = new(std::nothrow) SecurityStateManager();
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    if (!manager->initialize()) {
+        delete manager;
+        return -1;
+    }
+
+    g_state_manager.store(manager, std::memory_order_release);
+    return 0;
+}
+
+int guard_core_shutdown(void) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
         return -1;
     }
 
-    g_state_manager->shutdown();
-    delete g_state_manager;
-    g_state_manager = nullptr;
+    manager->stop_monitor();
+    manager->shutdown();   /* Disarms the watches: no new handlers start */
+    g_state_manager.store(nullptr, std::memory_order_seq_cst);
+
+    /* A handler already running on another thread may still hold it */
+    while (g_watch_handlers.load(std::memory_order_seq_cst) != 0) {
+        sched_yield();
+    }
+    delete manager;
 
     return 0;
 }
 
 int guard_core_snapshot(void) {
-    if (g_state_manager == nullptr) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
         return -1;
     }
 
-    return g_state_manager->take_snapshot() ? 0 : -1;
+    return manager->take_snapshot() ? 0 : -1;
 }
 
 int guard_core_check_integrity(uint32_t flags) {
-    if (g_state_manager == nullptr) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    sg_check_result_t result;
+    return manager->check_integrity(flags, &result) ? 0 : -1;
+}
+
+int guard_core_check_integrity_ex(uint32_t flags, sg_check_result_t* out) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr || out == nullptr) {
         return -1;
     }
 
-    return g_state_manager->check_integrity(flags) ? 0 : -1;
+    return manager->check_integrity(flags, out) ? 0 : -1;
 }
 
 int guard_core_detect_debugger(void) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    return manager->detect_debugger();
+}
+
+int guard_core_require_fresh(uint64_t max_age_ns, uint32_t flags) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return SG_COMPROMISED;
+    }
+
+    return static_cast<int>(manager->require_fresh(max_age_ns, flags));
+}
+
+int guard_core_get_state_info(sg_state_info_t* out) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr || out == nullptr) {
+        return -1;
+    }
+
+    manager->get_state_info(out);
+    return 0;
+}
+
+int guard_core_get_repair_info(sg_repair_info_t* out) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr || out == nullptr) {
+        return -1;
+    }
+
+    manager->get_repair_info(out);
+    return 0;
+}
+
+/*
+ * A trapping watchpoint fired. Runs in the SIGTRAP handler of the
+ * thread that wrote: publish_state and the journal are lock-free.
+ */
+static void watch_tripped(uintptr_t addr, size_t len, uint32_t tid) {
+    g_watch_handlers.fetch_add(1, std::memory_order_seq_cst);
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_seq_cst);
+    if (manager != nullptr) {
+        manager->publish_state(true, false, 0);
+        guard_journal_emit(SG_JEV_DETECTION, SG_DETECTOR_WATCH, static_cast<uint8_t>(SG_COMPROMISED),
+                           addr, len, tid, 0);
+    }
+    g_watch_handlers.fetch_sub(1, std::memory_order_release);
+}
+
+int guard_core_watch(const void* addr, size_t len, uint32_t type) {
     if (g_state_manager == nullptr) {
         return -1;
     }
 
-    return g_state_manager->detect_debugger();
+    return guard_watch_add(addr, len, static_cast<int>(type), watch_tripped) >= 0 ? 0 : -1;
+}
+
+int guard_core_register_thread(void) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    return manager->register_current_thread() ? 0 : -1;
+}
+
+int guard_core_set_slo(uint32_t detector, uint64_t max_staleness_ns) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    return manager->set_slo(detector, max_staleness_ns) ? 0 : -1;
+}
+
+int guard_core_set_region_slo(const void* addr, uint64_t max_staleness_ns) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    return manager->set_region_slo(addr, max_staleness_ns) ? 0 : -1;
+}
+
+int guard_core_set_region_granule(const void* addr, size_t bytes) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    return manager->set_region_granule(addr, bytes) ? 0 : -1;
+}
+
+/*
+ * Register with sg-attestd. Before sg_init the segment reads as the
+ * uninitialized manager does (COMPROMISED); initialize mirrors SAFE.
+ */
+int guard_core_attest_attach(const char* socket_path) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    const uint64_t word = manager != nullptr ? manager->published_word()
+                                             : make_state_word(SG_COMPROMISED, 0, 0);
+    if (guard_attest_attach(socket_path, word) != 0) {
+        return -1;
+    }
+    if (manager != nullptr) {
+        manager->publish_attestation();
+    }
+    return 0;
+}
+
+int guard_core_monitor_start(void) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    return manager->start_monitor();
+}
+
+int guard_core_monitor_stop(void) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
+        return -1;
+    }
+
+    return manager->stop_monitor() ? 0 : -1;
+}
+
+int guard_core_get_stats(sg_stats_t* out) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr || out == nullptr) {
+        return -1;
+    }
+
+    manager->get_stats(out);
+    return 0;
+}
+
+int guard_core_set_option(uint32_t option, uint64_t value) {
+    switch (option) {
+        case SG_OPT_SLICE_PAGES:
+            if (value == 0) {
+                return -1;
+            }
+            g_opt_slice_pages.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_MEMORY_MODE:
+            if (value != SG_MEMORY_HASH && value != SG_MEMORY_PAGEMAP &&
+                value != SG_MEMORY_RESIDENT) {
+                return -1;
+            }
+            if (value == SG_MEMORY_PAGEMAP && guard_pagemap_open() != 0) {
+                return -1;
+            }
+            g_opt_memory_mode.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_MODULES:
+            if (value > 1) {
+                return -1;
+            }
+            g_opt_modules.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_VERITY:
+            if (value > 1) {
+                return -1;
+            }
+            g_opt_verity.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_SELF_HEAL:
+            if (value > SG_HEAL_SHADOW) {
+                return -1;
+            }
+#if !defined(__linux__)
+            /* Page protections come from /proc/self/maps */
+            if (value != SG_HEAL_OFF) {
+                return -1;
+            }
+#endif
+            g_opt_self_heal.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_CALLER_STATS:
+            if (value > 1) {
+                return -1;
+            }
+            guard_callers_enable(value != 0 ? 1 : 0);
+            return 0;
+        case SG_OPT_HASH:
+            if (value > SG_HASH_SHA256) {
+                return -1;
+            }
+            g_opt_hash.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_GRANULE:
+            if (value != 0 && !granule_valid(value, static_cast<size_t>(sysconf(_SC_PAGESIZE)))) {
+                return -1;
+            }
+            g_opt_granule.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_DIGEST_BITS:
+            if (value != 0 && value != 32 && value != 64 && value != 128) {
+                return -1;
+            }
+            g_opt_digest_bits.store(value, std::memory_order_relaxed);
+            return 0;
+        case SG_OPT_MONITOR_STALL_MS:
+            if (value > UINT32_MAX) {
+                return -1;
+            }
+            g_opt_monitor_stall_ms.store(value, std::memory_order_relaxed);
+            if (SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire)) {
+                manager->rearm_heartbeat();
+            }
+            return 0;
+        default:
+            return -1;
+    }
 }
 
 int guard_core_get_state(void) {
-    if (g_state_manager == nullptr) {
+    SecurityStateManager* manager = g_state_manager.load(std::memory_order_acquire);
+    if (manager == nullptr) {
         return SG_COMPROMISED;
     }
 
-    return static_cast<int>(g_state_manager->get_state());
+    return static_cast<int>(manager->observed_state());
 }
 
 } /* extern "C" */
\ No newline at end of file
@@ -0,0 +1,205 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Self-Healing Support
+ *
+ * Responsibilities:
+ * - Compress shadow pages as independent LZ4 blocks and decode them
+ *   with full bounds checks
+ * - Swap restored pages into a live code mapping without a window in
+ *   which they are torn or unexecutable
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "heal.h"
+
+namespace {
+
+/* ============================================
+ * LZ4 Block Format
+ * ============================================ */
+
+constexpr size_t LZ4_MIN_MATCH = 4;
+constexpr size_t LZ4_LAST_LITERALS = 5;   /* The block ends with literals */
+constexpr size_t LZ4_MFLIMIT = 12;        /* No match starts this close to the end */
+constexpr size_t LZ4_MAX_OFFSET = 65535;
+constexpr unsigned LZ4_HASH_BITS = 12;
+
+inline uint32_t load_u32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t lz4_hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+/* 15 in the token nibble, then 255-valued bytes and a final remainder */
+bool put_length(uint8_t* dst, size_t cap, size_t& op, size_t value) {
+    for (; value >= 255; value -= 255) {
+        if (op == cap) {
+            return false;
+        }
+        dst[op++] = 255;
+    }
+    if (op == cap) {
+        return false;
+    }
+    dst[op++] = static_cast<uint8_t>(value);
+    return true;
+}
+
+/* One sequence: literals [anchor, anchor + lit), then a match unless match_len is 0 */
+bool put_sequence(uint8_t* dst, size_t cap, size_t& op, const uint8_t* literals, size_t lit,
+                  size_t offset, size_t match_len) {
+    if (op == cap) {
+        return false;
+    }
+    const size_t token_at = op++;
+    const size_t ml = match_len != 0 ? match_len - LZ4_MIN_MATCH : 0;
+    dst[token_at] = static_cast<uint8_t>(((lit < 15 ? lit : 15) << 4) | (ml < 15 ? ml : 15));
+    if (lit >= 15 && !put_length(dst, cap, op, lit - 15)) {
+        return false;
+    }
+    if (cap - op < lit) {
+        return false;
+    }
+    std::memcpy(dst + op, literals, lit);
+    op += lit;
+    if (match_len == 0) {
+        return true;
+    }
+    if (cap - op < 2) {
+        return false;
+    }
+    dst[op++] = static_cast<uint8_t>(offset);
+    dst[op++] = static_cast<uint8_t>(offset >> 8);
+    return ml < 15 || put_length(dst, cap, op, ml - 15);
+}
+
+/* Extension bytes of a 15-valued nibble */
+bool get_length(const uint8_t* src, size_t len, size_t& ip, size_t& value) {
+    uint8_t b;
+    do {
+        if (ip == len) {
+            return false;
+        }
+        b = src[ip++];
+        value += b;
+    } while (b == 255);
+    return true;
+}
+
+} /* anonymous namespace */
+
+extern "C" {
+
+size_t guard_lz4_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t cap) {
+    uint32_t table[1u << LZ4_HASH_BITS];
+    std::memset(table, 0xFF, sizeof(table));
+
+    size_t op = 0;
+    size_t anchor = 0;
+    if (len > LZ4_MFLIMIT) {
+        const size_t match_limit = len - LZ4_LAST_LITERALS;
+        for (size_t ip = 0; ip < len - LZ4_MFLIMIT; ) {
+            const uint32_t sequence = load_u32(src + ip);
+            const uint32_t h = lz4_hash(sequence);
+            const size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+            if (ref == 0xFFFFFFFFu || ip - ref > LZ4_MAX_OFFSET || load_u32(src + ref) != sequence) {
+                ++ip;
+                continue;
+            }
+
+            size_t match_len = LZ4_MIN_MATCH;
+            while (ip + match_len < match_limit && src[ref + match_len] == src[ip + match_len]) {
+                ++match_len;
+            }
+            if (!put_sequence(dst, cap, op, src + anchor, ip - anchor, ip - ref, match_len)) {
+                return 0;
+            }
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+    if (!put_sequence(dst, cap, op, src + anchor, len - anchor, 0, 0)) {
+        return 0;
+    }
+    return op;
+}
+
+int guard_lz4_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t out_len) {
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < len) {
+        const uint8_t token = src[ip++];
+
+        size_t lit = token >> 4;
+        if (lit == 15 && !get_length(src, len, ip, lit)) {
+            return -1;
+        }
+        if (len - ip < lit || out_len - op < lit) {
+            return -1;
+        }
+        std::memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == len) {
+            break;   /* Last sequence has no match */
+        }
+
+        if (len - ip < 2) {
+            return -1;
+        }
+        const size_t offset = static_cast<size_t>(src[ip]) | (static_cast<size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        size_t match_len = token & 15;
+        if (match_len == 15 && !get_length(src, len, ip, match_len)) {
+            return -1;
+        }
+        match_len += LZ4_MIN_MATCH;
+        if (offset == 0 || offset > op || out_len - op < match_len) {
+            return -1;
+        }
+        /* Byte by byte: the match may overlap its own output */
+        for (size_t k = 0; k < match_len; ++k, ++op) {
+            dst[op] = dst[op - offset];
+        }
+    }
+    return op == out_len ? 0 : -1;
+}
+
+int guard_page_replace(void* page, const void* content, size_t len, int prot) {
+    uint8_t* target = static_cast<uint8_t*>(page);
+
+#if defined(__linux__) && defined(MREMAP_FIXED)
+    void* scratch = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (scratch != MAP_FAILED) {
+        std::memcpy(scratch, content, len);
+        if (mprotect(scratch, len, prot) == 0 &&
+            mremap(scratch, len, len, MREMAP_MAYMOVE | MREMAP_FIXED, page) != MAP_FAILED) {
+            __builtin___clear_cache(reinterpret_cast<char*>(target),
+                                    reinterpret_cast<char*>(target + len));
+            return 0;
+        }
+        munmap(scratch, len);   /* e.g. W^X policy refused PROT_EXEC on anonymous memory */
+    }
+#endif
+
+    if (mprotect(page, len, prot | PROT_WRITE) != 0) {
+        return -1;
+    }
+    std::memcpy(page, content, len);
+    int result = mprotect(page, len, prot);
+    __builtin___clear_cache(reinterpret_cast<char*>(target), reinterpret_cast<char*>(target + len));
+    return result;
+}
+
+} /* extern "C" */
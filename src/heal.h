@@ -0,0 +1,38 @@
+/*
+ * Self-Guard Self-Healing Support
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_HEAL_H
+#define SG_INTERNAL_HEAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compress src into one LZ4 block. Returns the compressed size, or 0
+ * if it does not fit in cap (store the data raw instead).
+ */
+size_t guard_lz4_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t cap);
+
+/* Returns 0 if the block decodes to exactly out_len bytes */
+int guard_lz4_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t out_len);
+
+/*
+ * Replace len bytes of whole pages at page with content and leave them
+ * with prot. On Linux the new pages are prepared in a scratch mapping
+ * and moved in with one mremap, so other threads never see a partial
+ * or non-executable page; elsewhere the pages are written through a
+ * temporary PROT_WRITE window. Returns 0 on success.
+ */
+int guard_page_replace(void* page, const void* content, size_t len, int prot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_HEAL_H */
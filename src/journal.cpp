@@ -0,0 +1,277 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Persistent Forensic Journal
+ *
+ * Responsibilities:
+ * - Map an append-only journal file shared with the page cache
+ * - Reserve record slots lock-free and publish them with a commit word
+ * - Keep detection evidence after the process is killed
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <atomic>
+#include <new>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+extern "C" {
+    #include "self_guard_journal.h"
+}
+#include "journal.h"
+
+static_assert(sizeof(sg_journal_header_t) == 64, "journal header must be one cache line");
+static_assert(sizeof(sg_journal_record_t) == 64, "journal record must be one cache line");
+
+namespace {
+
+struct JournalMapping {
+    sg_journal_header_t* header;
+    sg_journal_record_t* records;
+    size_t map_size;
+};
+
+/* Published mapping; writers only ever load this pointer */
+std::atomic<JournalMapping*> g_journal(nullptr);
+
+/* Serializes open/close against each other (never taken by writers) */
+std::mutex g_journal_mutex;
+
+/* Writers still inside guard_journal_emit; close waits for zero */
+std::atomic<uint32_t> g_journal_writers(0);
+
+uint64_t realtime_ns() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_REALTIME, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/*
+ * Record timestamp: tick resolution (a few ms) is enough to order
+ * evidence against other logs, and the coarse clock is a vDSO read
+ * without the counter
+ */
+uint64_t record_time_ns() {
+    struct timespec ts;
+#if defined(CLOCK_REALTIME_COARSE)
+    if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) != 0) {
+#else
+    if (clock_gettime(CLOCK_REALTIME, &ts) != 0) {
+#endif
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/* getpid and gettid are real syscalls; cache both, 0 = not yet read */
+std::atomic<uint32_t> g_journal_pid(0);
+thread_local uint32_t t_journal_tid = 0;
+
+pthread_once_t g_journal_fork_once = PTHREAD_ONCE_INIT;
+
+/* Runs on the forking thread, the child's only thread */
+void journal_fork_child() {
+    g_journal_pid.store(0, std::memory_order_relaxed);
+    t_journal_tid = 0;
+}
+
+void journal_install_fork_handlers() {
+    pthread_atfork(nullptr, nullptr, journal_fork_child);
+}
+
+uint32_t journal_pid() {
+    uint32_t pid = g_journal_pid.load(std::memory_order_relaxed);
+    if (pid == 0) {
+        pid = static_cast<uint32_t>(getpid());
+        g_journal_pid.store(pid, std::memory_order_relaxed);
+    }
+    return pid;
+}
+
+uint32_t journal_tid() {
+    if (t_journal_tid == 0) {
+#if defined(SYS_gettid)
+        t_journal_tid = static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+        t_journal_tid = journal_pid();
+#endif
+    }
+    return t_journal_tid;
+}
+
+bool header_matches(const sg_journal_header_t* h, uint64_t capacity, size_t file_size) {
+    return h->magic == SG_JOURNAL_MAGIC &&
+           h->version == SG_JOURNAL_VERSION &&
+           h->record_size == sizeof(sg_journal_record_t) &&
+           h->capacity == capacity &&
+           file_size == sizeof(sg_journal_header_t) + capacity * sizeof(sg_journal_record_t);
+}
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_journal_open(const char* path, uint64_t capacity) {
+    pthread_once(&g_journal_fork_once, journal_install_fork_handlers);
+    std::lock_guard<std::mutex> lock(g_journal_mutex);
+
+    if (g_journal.load(std::memory_order_acquire) != nullptr) {
+        return -1;
+    }
+    if (path == nullptr || capacity == 0 ||
+        capacity > (SIZE_MAX - sizeof(sg_journal_header_t)) / sizeof(sg_journal_record_t)) {
+        return -1;
+    }
+
+    const size_t map_size = sizeof(sg_journal_header_t) +
+                            static_cast<size_t>(capacity) * sizeof(sg_journal_record_t);
+
+    /* Never follow a planted symlink onto some other file */
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+
+    /*
+     * Existing journals of this capacity are appended to and empty files
+     * initialized. Anything else is refused, never truncated: it may be
+     * evidence from an earlier run or not a journal at all.
+     */
+    const bool fresh = st.st_size == 0;
+    if (!fresh) {
+        sg_journal_header_t existing;
+        if (static_cast<size_t>(st.st_size) != map_size ||
+            pread(fd, &existing, sizeof(existing), 0) != static_cast<ssize_t>(sizeof(existing)) ||
+            !header_matches(&existing, capacity, map_size)) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    if (fresh && ftruncate(fd, static_cast<off_t>(map_size)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    void* base = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    JournalMapping* mapping = new(std::nothrow) JournalMapping;
+    if (mapping == nullptr) {
+        munmap(base, map_size);
+        return -1;
+    }
+    mapping->header = static_cast<sg_journal_header_t*>(base);
+    mapping->records = reinterpret_cast<sg_journal_record_t*>(
+        static_cast<uint8_t*>(base) + sizeof(sg_journal_header_t));
+    mapping->map_size = map_size;
+
+    if (fresh) {
+        sg_journal_header_t* h = mapping->header;
+        h->version = SG_JOURNAL_VERSION;
+        h->record_size = sizeof(sg_journal_record_t);
+        h->capacity = capacity;
+        h->cursor = 0;
+        h->dropped = 0;
+        h->created_ns = realtime_ns();
+        /* Magic last: a half-initialized header is never accepted */
+        __atomic_store_n(&h->magic, SG_JOURNAL_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    g_journal.store(mapping, std::memory_order_release);
+    guard_journal_emit(SG_JEV_OPEN, 0xFF, 0, 0, 0, 0, 0);
+    return 0;
+}
+
+int guard_journal_close(void) {
+    std::lock_guard<std::mutex> lock(g_journal_mutex);
+
+    JournalMapping* mapping = g_journal.load(std::memory_order_acquire);
+    if (mapping == nullptr) {
+        return -1;
+    }
+
+    guard_journal_emit(SG_JEV_CLOSE, 0xFF, 0, 0, 0, 0, 0);
+    g_journal.store(nullptr, std::memory_order_seq_cst);
+
+    /* Let in-flight writers finish their memcpy before unmapping */
+    while (g_journal_writers.load(std::memory_order_seq_cst) != 0) {
+        sched_yield();
+    }
+
+    msync(mapping->header, mapping->map_size, MS_ASYNC);
+    munmap(mapping->header, mapping->map_size);
+    delete mapping;
+    return 0;
+}
+
+int guard_journal_active(void) {
+    return g_journal.load(std::memory_order_relaxed) != nullptr ? 1 : 0;
+}
+
+void guard_journal_emit(uint16_t type, uint8_t detector, uint8_t state,
+                        uint64_t addr, uint64_t len, uint64_t value,
+                        uint64_t cycles) {
+    if (g_journal.load(std::memory_order_relaxed) == nullptr) {
+        return;
+    }
+
+    g_journal_writers.fetch_add(1, std::memory_order_seq_cst);
+    JournalMapping* mapping = g_journal.load(std::memory_order_seq_cst);
+    if (mapping == nullptr) {
+        g_journal_writers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    sg_journal_header_t* h = mapping->header;
+    uint64_t slot = __atomic_fetch_add(&h->cursor, 1, __ATOMIC_RELAXED);
+    if (slot >= h->capacity) {
+        __atomic_fetch_add(&h->dropped, 1, __ATOMIC_RELAXED);
+        g_journal_writers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    sg_journal_record_t rec;
+    rec.realtime_ns = record_time_ns();
+    rec.cycles = cycles;
+    rec.addr = addr;
+    rec.len = len;
+    rec.value = value;
+    rec.pid = journal_pid();
+    rec.tid = journal_tid();
+    rec.type = type;
+    rec.detector = detector;
+    rec.state = state;
+    std::memset(rec.reserved, 0, sizeof(rec.reserved));
+    rec.commit = 0;
+
+    sg_journal_record_t* dst = &mapping->records[slot];
+    std::memcpy(dst, &rec, offsetof(sg_journal_record_t, commit));
+    __atomic_store_n(&dst->commit, slot + 1, __ATOMIC_RELEASE);
+
+    g_journal_writers.fetch_sub(1, std::memory_order_release);
+}
+
+} /* extern "C" */
@@ -0,0 +1,33 @@
+/*
+ * Self-Guard Forensic Journal
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_JOURNAL_H
+#define SG_INTERNAL_JOURNAL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int guard_journal_open(const char* path, uint64_t capacity);
+int guard_journal_close(void);
+
+/* Non-zero while a journal file is mapped */
+int guard_journal_active(void);
+
+/*
+ * Append one event. Cost when a journal is attached is one atomic
+ * reservation plus a 64-byte memcpy; otherwise a single load.
+ */
+void guard_journal_emit(uint16_t type, uint8_t detector, uint8_t state,
+                        uint64_t addr, uint64_t len, uint64_t value,
+                        uint64_t cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_JOURNAL_H */
@@ -0,0 +1,303 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Shared Library Coverage and Host-Wide Baseline Cache
+ *
+ * Responsibilities:
+ * - Enumerate loaded shared objects and their executable segments
+ * - Extract GNU build-ids from PT_NOTE segments
+ * - Share per-module page digests between processes through a cache
+ *   directory keyed by (build-id, file size, mtime, inode)
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__linux__) || defined(__FreeBSD__)
+#include <link.h>
+#define SG_HAVE_DL_ITERATE_PHDR 1
+#endif
+
+#include "modules.h"
+
+namespace {
+
+/* ============================================
+ * Module Enumeration
+ * ============================================ */
+
+#if defined(SG_HAVE_DL_ITERATE_PHDR)
+
+struct ModuleWalk {
+    guard_module_cb cb;
+    void* ctx;
+};
+
+/* NT_GNU_BUILD_ID from the note segments of a loaded object */
+size_t find_build_id(struct dl_phdr_info* info, uint8_t* out, size_t max) {
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if (ph.p_type != PT_NOTE) {
+            continue;
+        }
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(info->dlpi_addr + ph.p_vaddr);
+        const uint8_t* end = p + ph.p_memsz;
+        while (p + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr)* note = reinterpret_cast<const ElfW(Nhdr)*>(p);
+            const uint8_t* name = p + sizeof(ElfW(Nhdr));
+            const uint8_t* desc = name + ((note->n_namesz + 3) & ~3u);
+            const uint8_t* next = desc + ((note->n_descsz + 3) & ~3u);
+            if (next > end) {
+                break;
+            }
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 &&
+                std::memcmp(name, "GNU", 4) == 0 && note->n_descsz <= max) {
+                std::memcpy(out, desc, note->n_descsz);
+                return note->n_descsz;
+            }
+            p = next;
+        }
+    }
+    return 0;
+}
+
+/* DT_TEXTREL objects patch their text at load time */
+bool has_text_relocations(struct dl_phdr_info* info) {
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if (ph.p_type != PT_DYNAMIC) {
+            continue;
+        }
+        const ElfW(Dyn)* dyn = reinterpret_cast<const ElfW(Dyn)*>(info->dlpi_addr + ph.p_vaddr);
+        for (; dyn->d_tag != DT_NULL; ++dyn) {
+            if (dyn->d_tag == DT_TEXTREL ||
+                (dyn->d_tag == DT_FLAGS && (dyn->d_un.d_val & DF_TEXTREL))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int module_phdr_cb(struct dl_phdr_info* info, size_t, void* data) {
+    ModuleWalk* walk = static_cast<ModuleWalk*>(data);
+
+    /* The main program (empty name) and the vDSO (no path) are not files */
+    if (info->dlpi_name == nullptr || info->dlpi_name[0] != '/') {
+        return 0;
+    }
+
+    guard_module_info_t module;
+    std::memset(&module, 0, sizeof(module));
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if (ph.p_type == PT_LOAD && (ph.p_flags & PF_X)) {
+            module.start = reinterpret_cast<const uint8_t*>(info->dlpi_addr + ph.p_vaddr);
+            module.size = static_cast<size_t>(ph.p_memsz);
+            module.file_offset = ph.p_offset;
+            module.file_exact = ph.p_filesz == ph.p_memsz;
+            break;
+        }
+    }
+    if (module.start == nullptr || module.size == 0 ||
+        std::strlen(info->dlpi_name) >= sizeof(module.path)) {
+        return 0;
+    }
+    std::strcpy(module.path, info->dlpi_name);
+    module.build_id_len = find_build_id(info, module.build_id, sizeof(module.build_id));
+    if (module.file_exact && has_text_relocations(info)) {
+        module.file_exact = 0;
+    }
+
+    return walk->cb(&module, walk->ctx) != 0 ? 1 : 0;
+}
+
+#endif /* SG_HAVE_DL_ITERATE_PHDR */
+
+/* ============================================
+ * Baseline Cache
+ * ============================================ */
+
+constexpr uint32_t CACHE_MAGIC = 0x43424753u;   /* "SGBC" */
+constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t page_size;
+    uint32_t build_id_len;
+    uint64_t text_size;
+    uint64_t count;
+    uint8_t build_id[SG_MODULE_BUILD_ID_MAX];
+    uint64_t checksum;      /* FNV-1a over the header (checksum 0) and digests */
+};
+
+std::mutex g_cache_mutex;
+char g_cache_dir[PATH_MAX];
+
+uint64_t cache_checksum(const CacheHeader& header, const uint32_t* digests, size_t count) {
+    CacheHeader copy = header;
+    copy.checksum = 0;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint8_t* parts[2] = { reinterpret_cast<const uint8_t*>(&copy),
+                                reinterpret_cast<const uint8_t*>(digests) };
+    const size_t sizes[2] = { sizeof(copy), count * sizeof(uint32_t) };
+    for (int k = 0; k < 2; ++k) {
+        for (size_t i = 0; i < sizes[k]; ++i) {
+            hash ^= parts[k][i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+/* Only trust entries nobody else could have planted */
+bool cache_owner_ok(const struct stat& st) {
+    return (st.st_uid == 0 || st.st_uid == geteuid()) && !(st.st_mode & (S_IWGRP | S_IWOTH));
+}
+
+/* <dir>/<build-id>-<size>-<mtime>-<inode>.sgb; false if the module cannot be keyed */
+bool cache_entry_path(const guard_module_info_t* module, char* out, size_t size) {
+    if (module->build_id_len == 0 || g_cache_dir[0] == '\0') {
+        return false;
+    }
+
+    struct stat st;
+    if (stat(module->path, &st) != 0) {
+        return false;
+    }
+
+    char hex[SG_MODULE_BUILD_ID_MAX * 2 + 1];
+    for (size_t i = 0; i < module->build_id_len; ++i) {
+        snprintf(hex + 2 * i, 3, "%02x", module->build_id[i]);
+    }
+#if defined(__APPLE__)
+    const struct timespec& mtime = st.st_mtimespec;
+#else
+    const struct timespec& mtime = st.st_mtim;
+#endif
+    int len = snprintf(out, size, "%s/%s-%llu-%lld.%09ld-%llu.sgb", g_cache_dir, hex,
+                       static_cast<unsigned long long>(st.st_size),
+                       static_cast<long long>(mtime.tv_sec),
+                       static_cast<long>(mtime.tv_nsec),
+                       static_cast<unsigned long long>(st.st_ino));
+    return len > 0 && static_cast<size_t>(len) < size;
+}
+
+} /* anonymous namespace */
+
+extern "C" {
+
+void guard_modules_foreach(guard_module_cb cb, void* ctx) {
+#if defined(SG_HAVE_DL_ITERATE_PHDR)
+    ModuleWalk walk = { cb, ctx };
+    dl_iterate_phdr(module_phdr_cb, &walk);
+#else
+    (void)cb;
+    (void)ctx;
+#endif
+}
+
+int guard_baseline_cache_set(const char* dir) {
+    std::lock_guard<std::mutex> lock(g_cache_mutex);
+    if (dir == nullptr || dir[0] == '\0') {
+        g_cache_dir[0] = '\0';
+        return 0;
+    }
+
+    struct stat st;
+    if (std::strlen(dir) >= sizeof(g_cache_dir) || stat(dir, &st) != 0 ||
+        !S_ISDIR(st.st_mode) || !cache_owner_ok(st)) {
+        return -1;
+    }
+    std::strcpy(g_cache_dir, dir);
+    return 0;
+}
+
+int guard_baseline_cache_load(const guard_module_info_t* module, size_t page_size,
+                              uint32_t* digests, size_t count) {
+    std::lock_guard<std::mutex> lock(g_cache_mutex);
+    char path[PATH_MAX];
+    if (!cache_entry_path(module, path, sizeof(path))) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    const size_t expected = sizeof(CacheHeader) + count * sizeof(uint32_t);
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || !cache_owner_ok(st) ||
+        static_cast<size_t>(st.st_size) != expected) {
+        close(fd);
+        return -1;
+    }
+    void* map = mmap(nullptr, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    const CacheHeader* header = static_cast<const CacheHeader*>(map);
+    const uint32_t* cached = reinterpret_cast<const uint32_t*>(header + 1);
+    bool ok = header->magic == CACHE_MAGIC && header->version == CACHE_VERSION &&
+              header->page_size == page_size && header->text_size == module->size &&
+              header->count == count && header->build_id_len == module->build_id_len &&
+              std::memcmp(header->build_id, module->build_id, module->build_id_len) == 0 &&
+              header->checksum == cache_checksum(*header, cached, count);
+    if (ok) {
+        /* Private copy: the entry may be replaced while we run */
+        std::memcpy(digests, cached, count * sizeof(uint32_t));
+    }
+    munmap(map, expected);
+    return ok ? 0 : -1;
+}
+
+int guard_baseline_cache_store(const guard_module_info_t* module, size_t page_size,
+                               const uint32_t* digests, size_t count) {
+    std::lock_guard<std::mutex> lock(g_cache_mutex);
+    char path[PATH_MAX];
+    char tmp[PATH_MAX + 32];
+    if (!cache_entry_path(module, path, sizeof(path))) {
+        return -1;
+    }
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%ld", path, static_cast<long>(getpid()));
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.page_size = static_cast<uint32_t>(page_size);
+    header.build_id_len = static_cast<uint32_t>(module->build_id_len);
+    header.text_size = module->size;
+    header.count = count;
+    std::memcpy(header.build_id, module->build_id, module->build_id_len);
+    header.checksum = cache_checksum(header, digests, count);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    const size_t bytes = count * sizeof(uint32_t);
+    bool ok = write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) &&
+              write(fd, digests, bytes) == static_cast<ssize_t>(bytes);
+    ok = (close(fd) == 0) && ok;
+
+    /* Readers see the old entry, no entry, or the complete new one */
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+} /* extern "C" */
@@ -0,0 +1,56 @@
+/*
+ * Self-Guard Shared Library Coverage and Baseline Cache
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_MODULES_H
+#define SG_INTERNAL_MODULES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SG_MODULE_PATH_MAX     256
+#define SG_MODULE_BUILD_ID_MAX 32
+
+/* Executable segment of one loaded shared object */
+typedef struct {
+    const uint8_t* start;
+    size_t size;
+    char path[SG_MODULE_PATH_MAX];
+    uint8_t build_id[SG_MODULE_BUILD_ID_MAX];
+    size_t build_id_len;                      /* 0: no NT_GNU_BUILD_ID note */
+    uint64_t file_offset;                     /* p_offset of the segment */
+    int file_exact;                           /* Segment bytes equal the file bytes at
+                                                 file_offset (no bss, no TEXTREL) */
+} guard_module_info_t;
+
+/* Return non-zero from the callback to stop */
+typedef int (*guard_module_cb)(const guard_module_info_t* module, void* ctx);
+
+/* Every file-backed shared object with an executable segment, main program excluded */
+void guard_modules_foreach(guard_module_cb cb, void* ctx);
+
+/*
+ * Directory of per-module page-digest files, shared by every process
+ * on the host. NULL disables the cache. The directory must be owned
+ * by root or this user and not writable by group or others.
+ */
+int guard_baseline_cache_set(const char* dir);
+
+/* Fill count page digests from the cache. Returns 0 on a hit. */
+int guard_baseline_cache_load(const guard_module_info_t* module, size_t page_size,
+                              uint32_t* digests, size_t count);
+
+/* Publish page digests for other processes (write + rename). */
+int guard_baseline_cache_store(const guard_module_info_t* module, size_t page_size,
+                               const uint32_t* digests, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_MODULES_H */
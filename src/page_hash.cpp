@@ -0,0 +1,494 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Page Hash Engines
+ *
+ * Responsibilities:
+ * - Hash policies: rotate-XOR (the autotuned kernel), CRC32C in
+ *   hardware or slice-by-8, keyed SipHash-2-4, SHA-256
+ * - One page-scan loop per policy, page size and digest width, with the
+ *   policy (and the tuned rotate-XOR kernel) inlined and the page size a
+ *   constant where it is known, up to the 2 MiB granule
+ * - Truncated SipHash and SHA-256 digests, for smaller tables
+ * - Pick the instantiation for this host at snapshot time, so the only
+ *   indirect call is the one per scanned run
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define SG_HAVE_CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32) && \
+      __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_acle.h>
+#define SG_HAVE_CRC32C_ARM 1
+#endif
+
+extern "C" {
+    #include "self_guard.h"
+    #include "self_guard_asm.h"
+}
+#include "checksum_words.h"
+#include "page_hash.h"
+#include "tuning.h"
+#include "sha256.h"
+
+namespace {
+
+/* ============================================
+ * Hash Policies
+ *
+ * Each provides kWords (native digest width), a State set up once
+ * per scan, and digest(state, data, len, out[kWords]).
+ * ============================================ */
+
+struct NoState {};
+
+/*
+ * Rotate-XOR through a kernel known at compile time, so the page loop
+ * calls it directly (and inlines the header-only word kernel). Every
+ * kernel yields the same digest; the registry picks the one tuned.
+ */
+template <uint32_t (*Kernel)(const void*, size_t)>
+struct RotXorHash {
+    static constexpr uint32_t kWords = 1;
+    typedef NoState State;
+
+    static State begin() {
+        return State();
+    }
+
+    static void digest(State, const uint8_t* data, size_t len, uint32_t* out) {
+        out[0] = Kernel(data, len);
+    }
+};
+
+/* A tuned kernel without its own instantiation, fetched once per scan */
+struct RotXorTunedHash {
+    static constexpr uint32_t kWords = 1;
+    typedef sg_checksum_fn State;
+
+    static State begin() {
+        return guard_tuning_kernel();
+    }
+
+    static void digest(State kernel, const uint8_t* data, size_t len, uint32_t* out) {
+        out[0] = kernel(data, len);
+    }
+};
+
+uint32_t checksum_words_kernel(const void* start, size_t length) {
+    return sg_checksum_words(start, length);
+}
+
+bool rotxor_native_tuned() {
+    return std::strcmp(guard_tuning_kernel_name(), "native") == 0;
+}
+
+bool rotxor_words_tuned() {
+    return std::strcmp(guard_tuning_kernel_name(), "c-words") == 0;
+}
+
+typedef RotXorHash<sg_checksum_memory> RotXorNativeHash;
+typedef RotXorHash<checksum_words_kernel> RotXorWordsHash;
+
+/* CRC32C (Castagnoli, reflected 0x82F63B78), slice-by-8 tables */
+struct Crc32cTables {
+    uint32_t t[8][256];
+};
+
+constexpr Crc32cTables make_crc32c_tables() {
+    Crc32cTables tables = {};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+        }
+        tables.t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k) {
+            tables.t[k][i] = (tables.t[k - 1][i] >> 8) ^ tables.t[0][tables.t[k - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr Crc32cTables g_crc32c = make_crc32c_tables();
+
+inline uint32_t load_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+struct Crc32cSoftHash {
+    static constexpr uint32_t kWords = 1;
+    typedef NoState State;
+
+    static State begin() {
+        return State();
+    }
+
+    static void digest(State, const uint8_t* data, size_t len, uint32_t* out) {
+        const auto& t = g_crc32c.t;
+        uint32_t crc = 0xFFFFFFFFu;
+        for (; len >= 8; data += 8, len -= 8) {
+            const uint32_t lo = crc ^ load_le32(data);
+            const uint32_t hi = load_le32(data + 4);
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        }
+        for (; len != 0; ++data, --len) {
+            crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+        }
+        out[0] = ~crc;
+    }
+};
+
+#if defined(SG_HAVE_CRC32C_SSE42)
+
+/* Out of line: only this function is built for SSE4.2 */
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(const uint8_t* data, size_t len) {
+    uint64_t crc = 0xFFFFFFFFu;
+    for (; len >= 8; data += 8, len -= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u64(crc, word);
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc);
+    for (; len != 0; ++data, --len) {
+        crc32 = _mm_crc32_u8(crc32, *data);
+    }
+    return ~crc32;
+}
+
+bool crc32c_hw_usable() {
+    return __builtin_cpu_supports("sse4.2");
+}
+
+#elif defined(SG_HAVE_CRC32C_ARM)
+
+uint32_t crc32c_arm(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (; len >= 8; data += 8, len -= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    for (; len != 0; ++data, --len) {
+        crc = __crc32cb(crc, *data);
+    }
+    return ~crc;
+}
+
+bool crc32c_hw_usable() {
+    return true;
+}
+
+#endif
+
+#if defined(SG_HAVE_CRC32C_SSE42) || defined(SG_HAVE_CRC32C_ARM)
+
+struct Crc32cHardHash {
+    static constexpr uint32_t kWords = 1;
+    typedef NoState State;
+
+    static State begin() {
+        return State();
+    }
+
+    static void digest(State, const uint8_t* data, size_t len, uint32_t* out) {
+#if defined(SG_HAVE_CRC32C_SSE42)
+        out[0] = crc32c_sse42(data, len);
+#else
+        out[0] = crc32c_arm(data, len);
+#endif
+    }
+};
+
+#endif
+
+/* SipHash-2-4 under a key drawn once per process */
+struct SipKey {
+    uint64_t k0;
+    uint64_t k1;
+    bool valid;
+};
+
+bool fill_random(void* out, size_t len) {
+#if defined(__linux__)
+    if (getrandom(out, len, 0) == static_cast<ssize_t>(len)) {
+        return true;
+    }
+#endif
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const ssize_t got = read(fd, out, len);
+    close(fd);
+    return got == static_cast<ssize_t>(len);
+}
+
+SipKey draw_sip_key() {
+    uint64_t words[2];
+    SipKey key = {0, 0, false};
+    if (fill_random(words, sizeof(words))) {
+        key.k0 = words[0];
+        key.k1 = words[1];
+        key.valid = true;
+    }
+    return key;
+}
+
+const SipKey& sip_key() {
+    static const SipKey key = draw_sip_key();
+    return key;
+}
+
+inline uint64_t rotl64(uint64_t x, unsigned r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t load_le64(const uint8_t* p) {
+    return static_cast<uint64_t>(load_le32(p)) | (static_cast<uint64_t>(load_le32(p + 4)) << 32);
+}
+
+struct SipHash {
+    static constexpr uint32_t kWords = 2;
+    typedef SipKey State;
+
+    static State begin() {
+        return sip_key();
+    }
+
+    static inline void round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+        v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32);
+        v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32);
+    }
+
+    static void digest(const State& key, const uint8_t* data, size_t len, uint32_t* out) {
+        uint64_t v0 = key.k0 ^ 0x736f6d6570736575ULL;
+        uint64_t v1 = key.k1 ^ 0x646f72616e646f6dULL;
+        uint64_t v2 = key.k0 ^ 0x6c7967656e657261ULL;
+        uint64_t v3 = key.k1 ^ 0x7465646279746573ULL;
+
+        const uint64_t last = static_cast<uint64_t>(len) << 56;
+        for (; len >= 8; data += 8, len -= 8) {
+            const uint64_t m = load_le64(data);
+            v3 ^= m;
+            round(v0, v1, v2, v3);
+            round(v0, v1, v2, v3);
+            v0 ^= m;
+        }
+        uint64_t m = last;
+        for (size_t i = 0; i < len; ++i) {
+            m |= static_cast<uint64_t>(data[i]) << (8 * i);
+        }
+        v3 ^= m;
+        round(v0, v1, v2, v3);
+        round(v0, v1, v2, v3);
+        v0 ^= m;
+
+        v2 ^= 0xFF;
+        for (int i = 0; i < 4; ++i) {
+            round(v0, v1, v2, v3);
+        }
+        const uint64_t h = v0 ^ v1 ^ v2 ^ v3;
+        out[0] = static_cast<uint32_t>(h);
+        out[1] = static_cast<uint32_t>(h >> 32);
+    }
+};
+
+struct Sha256Hash {
+    static constexpr uint32_t kWords = SG_SHA256_DIGEST_SIZE / 4;
+    typedef NoState State;
+
+    static State begin() {
+        return State();
+    }
+
+    static void digest(State, const uint8_t* data, size_t len, uint32_t* out) {
+        uint8_t hash[SG_SHA256_DIGEST_SIZE];
+        guard_sha256(data, len, hash);
+        std::memcpy(out, hash, sizeof(hash));
+    }
+};
+
+static_assert(Sha256Hash::kWords <= GUARD_HASH_MAX_WORDS, "raise GUARD_HASH_MAX_WORDS");
+
+/* ============================================
+ * Page Scan Loops
+ * ============================================ */
+
+/*
+ * PageSize 0 takes the page size from the engine at run time. Words may
+ * be narrower than the hash: digests are then truncated, and the table
+ * shrinks with them.
+ */
+template <typename Hash, size_t PageSize, uint32_t Words = Hash::kWords>
+struct PageScan {
+    static_assert(Words >= 1 && Words <= Hash::kWords, "digest wider than the hash");
+
+    static size_t page_size(const guard_hash_engine_t* engine) {
+        return PageSize != 0 ? PageSize : engine->page_size;
+    }
+
+    static void digest(const guard_hash_engine_t* engine, const uint8_t* data, size_t len,
+                       uint32_t* digests) {
+        const size_t page = page_size(engine);
+        const typename Hash::State state = Hash::begin();
+        uint32_t full[Hash::kWords];
+        for (size_t offset = 0; offset < len; offset += page, digests += Words) {
+            const size_t n = len - offset < page ? len - offset : page;
+            if (Words == Hash::kWords) {
+                Hash::digest(state, data + offset, n, digests);
+            } else {
+                Hash::digest(state, data + offset, n, full);
+                std::memcpy(digests, full, Words * sizeof(uint32_t));
+            }
+        }
+    }
+
+    static size_t verify(const guard_hash_engine_t* engine, const uint8_t* data, size_t len,
+                         const uint32_t* digests) {
+        const size_t page = page_size(engine);
+        const typename Hash::State state = Hash::begin();
+        uint32_t full[Hash::kWords];
+        size_t matched = 0;
+        for (size_t offset = 0; offset < len; offset += page, digests += Words, ++matched) {
+            Hash::digest(state, data + offset, len - offset < page ? len - offset : page, full);
+            uint32_t diff = 0;
+            for (uint32_t w = 0; w < Words; ++w) {
+                diff |= full[w] ^ digests[w];
+            }
+            if (diff != 0) {
+                break;
+            }
+        }
+        return matched;
+    }
+};
+
+/* ============================================
+ * Engine Registry
+ * ============================================ */
+
+struct EngineEntry {
+    guard_hash_engine_t engine;
+    bool (*usable)();
+};
+
+bool always_usable() {
+    return true;
+}
+
+template <typename Hash, size_t PageSize, uint32_t Words = Hash::kWords>
+constexpr EngineEntry make_entry(const char* name, uint32_t hash, bool (*usable)() = always_usable) {
+    return { { name, hash, Words, PageSize,
+               PageScan<Hash, PageSize, Words>::digest, PageScan<Hash, PageSize, Words>::verify },
+             usable };
+}
+
+/*
+ * Every policy at the common page sizes and the 2 MiB granule, then at
+ * any page size; the wide hashes again truncated. The first usable match
+ * of a width wins, so faster implementations of a hash come first.
+ */
+const EngineEntry g_engines[] = {
+    make_entry<RotXorNativeHash, 4096>("rotxor", SG_HASH_ROTXOR, rotxor_native_tuned),
+    make_entry<RotXorNativeHash, 16384>("rotxor", SG_HASH_ROTXOR, rotxor_native_tuned),
+    make_entry<RotXorNativeHash, 65536>("rotxor", SG_HASH_ROTXOR, rotxor_native_tuned),
+    make_entry<RotXorNativeHash, SG_GRANULE_MAX>("rotxor", SG_HASH_ROTXOR, rotxor_native_tuned),
+    make_entry<RotXorNativeHash, 0>("rotxor", SG_HASH_ROTXOR, rotxor_native_tuned),
+    make_entry<RotXorWordsHash, 4096>("rotxor-words", SG_HASH_ROTXOR, rotxor_words_tuned),
+    make_entry<RotXorWordsHash, 16384>("rotxor-words", SG_HASH_ROTXOR, rotxor_words_tuned),
+    make_entry<RotXorWordsHash, 65536>("rotxor-words", SG_HASH_ROTXOR, rotxor_words_tuned),
+    make_entry<RotXorWordsHash, SG_GRANULE_MAX>("rotxor-words", SG_HASH_ROTXOR, rotxor_words_tuned),
+    make_entry<RotXorWordsHash, 0>("rotxor-words", SG_HASH_ROTXOR, rotxor_words_tuned),
+    make_entry<RotXorTunedHash, 0>("rotxor", SG_HASH_ROTXOR),
+#if defined(SG_HAVE_CRC32C_SSE42) || defined(SG_HAVE_CRC32C_ARM)
+    make_entry<Crc32cHardHash, 4096>("crc32c-hw", SG_HASH_CRC32C, crc32c_hw_usable),
+    make_entry<Crc32cHardHash, 16384>("crc32c-hw", SG_HASH_CRC32C, crc32c_hw_usable),
+    make_entry<Crc32cHardHash, 65536>("crc32c-hw", SG_HASH_CRC32C, crc32c_hw_usable),
+    make_entry<Crc32cHardHash, SG_GRANULE_MAX>("crc32c-hw", SG_HASH_CRC32C, crc32c_hw_usable),
+    make_entry<Crc32cHardHash, 0>("crc32c-hw", SG_HASH_CRC32C, crc32c_hw_usable),
+#endif
+    make_entry<Crc32cSoftHash, 4096>("crc32c", SG_HASH_CRC32C),
+    make_entry<Crc32cSoftHash, 16384>("crc32c", SG_HASH_CRC32C),
+    make_entry<Crc32cSoftHash, 65536>("crc32c", SG_HASH_CRC32C),
+    make_entry<Crc32cSoftHash, SG_GRANULE_MAX>("crc32c", SG_HASH_CRC32C),
+    make_entry<Crc32cSoftHash, 0>("crc32c", SG_HASH_CRC32C),
+    make_entry<SipHash, 4096>("siphash-2-4", SG_HASH_SIPHASH),
+    make_entry<SipHash, 16384>("siphash-2-4", SG_HASH_SIPHASH),
+    make_entry<SipHash, 65536>("siphash-2-4", SG_HASH_SIPHASH),
+    make_entry<SipHash, SG_GRANULE_MAX>("siphash-2-4", SG_HASH_SIPHASH),
+    make_entry<SipHash, 0>("siphash-2-4", SG_HASH_SIPHASH),
+    make_entry<SipHash, 4096, 1>("siphash-2-4/32", SG_HASH_SIPHASH),
+    make_entry<SipHash, 16384, 1>("siphash-2-4/32", SG_HASH_SIPHASH),
+    make_entry<SipHash, 65536, 1>("siphash-2-4/32", SG_HASH_SIPHASH),
+    make_entry<SipHash, SG_GRANULE_MAX, 1>("siphash-2-4/32", SG_HASH_SIPHASH),
+    make_entry<SipHash, 0, 1>("siphash-2-4/32", SG_HASH_SIPHASH),
+    make_entry<Sha256Hash, 4096>("sha256", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 16384>("sha256", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 65536>("sha256", SG_HASH_SHA256),
+    make_entry<Sha256Hash, SG_GRANULE_MAX>("sha256", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 0>("sha256", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 4096, 4>("sha256/128", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 16384, 4>("sha256/128", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 65536, 4>("sha256/128", SG_HASH_SHA256),
+    make_entry<Sha256Hash, SG_GRANULE_MAX, 4>("sha256/128", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 0, 4>("sha256/128", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 4096, 2>("sha256/64", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 16384, 2>("sha256/64", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 65536, 2>("sha256/64", SG_HASH_SHA256),
+    make_entry<Sha256Hash, SG_GRANULE_MAX, 2>("sha256/64", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 0, 2>("sha256/64", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 4096, 1>("sha256/32", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 16384, 1>("sha256/32", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 65536, 1>("sha256/32", SG_HASH_SHA256),
+    make_entry<Sha256Hash, SG_GRANULE_MAX, 1>("sha256/32", SG_HASH_SHA256),
+    make_entry<Sha256Hash, 0, 1>("sha256/32", SG_HASH_SHA256),
+};
+
+} // anonymous namespace
+
+extern "C" {
+
+int guard_hash_engine(uint32_t hash, size_t page_size, uint32_t max_words,
+                      guard_hash_engine_t* out) {
+    if (page_size == 0 || max_words == 0 || (hash == SG_HASH_SIPHASH && !sip_key().valid)) {
+        return -1;
+    }
+    /* Widest digest within max_words; the first usable entry of that width */
+    const EngineEntry* best = nullptr;
+    for (const EngineEntry& entry : g_engines) {
+        if (entry.engine.hash != hash || entry.engine.digest_words > max_words ||
+            (best != nullptr && entry.engine.digest_words <= best->engine.digest_words) ||
+            (entry.engine.page_size != 0 && entry.engine.page_size != page_size) ||
+            !entry.usable()) {
+            continue;
+        }
+        best = &entry;
+    }
+    if (best == nullptr) {
+        return -1;
+    }
+    *out = best->engine;
+    out->page_size = page_size;
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,54 @@
+/*
+ * Self-Guard Page Hash Engines
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_PAGE_HASH_H
+#define SG_INTERNAL_PAGE_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "self_guard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GUARD_HASH_MAX_WORDS 8   /* Widest digest (SHA-256) in 32-bit words */
+
+/*
+ * One compiled scan loop per hash, page size and digest width. Digests
+ * are digest_words 32-bit words per page (the hash's leading words when
+ * truncated), pages laid out back to back; a short last page is hashed
+ * as it is. A "page" is the digest block: the caller's granule, a
+ * multiple of the system page.
+ */
+typedef struct guard_hash_engine {
+    const char* name;
+    uint32_t hash;              /* sg_hash_t */
+    uint32_t digest_words;
+    size_t page_size;
+
+    /* Digest every page of data[0, len) */
+    void (*digest)(const struct guard_hash_engine* engine, const uint8_t* data, size_t len,
+                   uint32_t* digests);
+
+    /* Pages of data[0, len) that match digests before the first that does not */
+    size_t (*verify)(const struct guard_hash_engine* engine, const uint8_t* data, size_t len,
+                     const uint32_t* digests);
+} guard_hash_engine_t;
+
+/*
+ * Pick the instantiation for hash (sg_hash_t) and page_size on this
+ * host: the widest digest of at most max_words, a fixed-page-size loop
+ * where one is built, hardware CRC32C when the CPU has it. Returns -1
+ * if hash is unknown or its key cannot be drawn.
+ */
+int guard_hash_engine(uint32_t hash, size_t page_size, uint32_t max_words,
+                      guard_hash_engine_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_PAGE_HASH_H */
@@ -0,0 +1,430 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Page Residency and Backing Queries
+ *
+ * Responsibilities:
+ * - Keep one /proc/self/pagemap descriptor for the process
+ * - Fetch the entries for a page range with a single pread
+ * - Report residency without faulting pages in
+ * - Read memory that may be unmapped under us without faulting
+ * - Index the files backing the code section (/proc/self/maps)
+ * - Tell whether a region is mapped with huge pages (/proc/self/smaps)
+ * - List executable mappings and the cheap counters that reveal new ones
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/sysmacros.h>
+#include <sys/uio.h>
+#endif
+
+#include "pagemap.h"
+
+namespace {
+
+constexpr int PAGEMAP_UNOPENED = -2;
+
+std::atomic<int> g_pagemap_fd(PAGEMAP_UNOPENED);
+std::mutex g_pagemap_mutex;
+
+/* Cleared once process_vm_readv turns out to be filtered or missing */
+std::atomic<bool> g_vm_readv_usable(true);
+
+#if defined(__linux__)
+/* /proc/self/mem, the fallback; reopened in a forked child */
+std::mutex g_self_mem_mutex;
+int g_self_mem_fd = -1;
+pid_t g_self_mem_pid = 0;
+std::atomic<bool> g_self_mem_usable(true);
+
+int self_mem_fd() {
+    /* getpid() every time: a forked child must not read its parent */
+    const pid_t pid = getpid();
+    std::lock_guard<std::mutex> lock(g_self_mem_mutex);
+    if (g_self_mem_fd >= 0 && g_self_mem_pid == pid) {
+        return g_self_mem_fd;
+    }
+    if (g_self_mem_fd >= 0) {
+        close(g_self_mem_fd);
+    }
+    g_self_mem_fd = open("/proc/self/mem", O_RDONLY | O_CLOEXEC);
+    g_self_mem_pid = pid;
+    if (g_self_mem_fd < 0) {
+        g_self_mem_usable.store(false, std::memory_order_relaxed);
+    }
+    return g_self_mem_fd;
+}
+#endif
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_pagemap_open(void) {
+    int fd = g_pagemap_fd.load(std::memory_order_acquire);
+    if (fd != PAGEMAP_UNOPENED) {
+        return fd >= 0 ? 0 : -1;
+    }
+
+    std::lock_guard<std::mutex> lock(g_pagemap_mutex);
+    fd = g_pagemap_fd.load(std::memory_order_relaxed);
+    if (fd == PAGEMAP_UNOPENED) {
+#if defined(__linux__)
+        fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+#else
+        fd = -1;
+#endif
+        g_pagemap_fd.store(fd < 0 ? -1 : fd, std::memory_order_release);
+    }
+    return fd >= 0 ? 0 : -1;
+}
+
+int guard_pagemap_read(const void* addr, size_t npages, uint64_t* entries) {
+    int fd = g_pagemap_fd.load(std::memory_order_acquire);
+    if (fd < 0 || npages == 0) {
+        return -1;
+    }
+
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t bytes = npages * sizeof(uint64_t);
+    const off_t offset = static_cast<off_t>(
+        reinterpret_cast<uintptr_t>(addr) / page_size * sizeof(uint64_t));
+
+    ssize_t n = pread(fd, entries, bytes, offset);
+    return n == static_cast<ssize_t>(bytes) ? 0 : -1;
+}
+
+int guard_residency_read(const void* addr, size_t npages, uint64_t* entries) {
+    if (guard_pagemap_open() == 0 && guard_pagemap_read(addr, npages, entries) == 0) {
+        return 0;
+    }
+
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* base = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(addr) & ~(page_size - 1));
+
+    /*
+     * mincore's byte vector goes in the tail of the entry buffer. Entry i
+     * is written only after byte i is read and never reaches a later byte.
+     */
+#if defined(__APPLE__)
+    char* vec = reinterpret_cast<char*>(entries + npages) - npages;
+#else
+    unsigned char* vec = reinterpret_cast<unsigned char*>(entries + npages) - npages;
+#endif
+    if (mincore(base, npages * page_size, vec) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < npages; ++i) {
+        entries[i] = (vec[i] & 1) ? SG_PAGEMAP_PRESENT : 0;
+    }
+    return 0;
+}
+
+size_t guard_read_self(const void* addr, void* buf, size_t len) {
+    size_t done = 0;
+#if defined(__linux__)
+    while (done < len && g_vm_readv_usable.load(std::memory_order_relaxed)) {
+        /* getpid() every time: a forked child must not read its parent */
+        struct iovec local = {static_cast<uint8_t*>(buf) + done, len - done};
+        struct iovec remote = {const_cast<uint8_t*>(static_cast<const uint8_t*>(addr)) + done,
+                               len - done};
+        ssize_t n = process_vm_readv(getpid(), &local, 1, &remote, 1, 0);
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n < 0 && (errno == ENOSYS || errno == EPERM)) {
+            g_vm_readv_usable.store(false, std::memory_order_relaxed);
+        } else {
+            return done;   /* EFAULT: the page at addr + done is gone */
+        }
+    }
+
+    /* Filtered: the kernel copies for us through /proc/self/mem, EIO where unmapped */
+    while (done < len && g_self_mem_usable.load(std::memory_order_relaxed)) {
+        const int fd = self_mem_fd();
+        if (fd < 0) {
+            break;
+        }
+        ssize_t n = pread(fd, static_cast<uint8_t*>(buf) + done, len - done,
+                          static_cast<off_t>(reinterpret_cast<uintptr_t>(addr) + done));
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n < 0 && (errno == EACCES || errno == EPERM)) {
+            g_self_mem_usable.store(false, std::memory_order_relaxed);
+        } else {
+            return done;   /* EIO: the page at addr + done is gone */
+        }
+    }
+#else
+    (void)addr;
+    (void)buf;
+    (void)len;
+#endif
+    /* No fault-tolerant path: copy nothing rather than risk SIGSEGV */
+    return done;
+}
+
+int guard_read_self_available(void) {
+    static const uint8_t probe = 0;
+    uint8_t byte;
+    return guard_read_self(&probe, &byte, 1) == 1 ? 1 : 0;
+}
+
+size_t guard_maps_index(uintptr_t lo, uintptr_t hi, guard_file_range_t* out, size_t max) {
+    size_t count = 0;
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/maps", "re");
+    if (f == nullptr) {
+        return 0;
+    }
+
+    char line[4096 + 128];
+    while (count < max && fgets(line, sizeof(line), f) != nullptr) {
+        unsigned long start = 0, end = 0, offset = 0, inode = 0;
+        unsigned int dev_major = 0, dev_minor = 0;
+        char perms[5] = {0};
+        int path_pos = 0;
+        if (sscanf(line, "%lx-%lx %4s %lx %x:%x %lu %n", &start, &end, perms, &offset,
+                   &dev_major, &dev_minor, &inode, &path_pos) < 7) {
+            continue;
+        }
+        if (end <= lo || start >= hi || inode == 0 || perms[3] != 'p' || path_pos == 0) {
+            continue;
+        }
+
+        char* path = line + path_pos;
+        path[strcspn(path, "\n")] = '\0';
+        if (path[0] != '/') {
+            continue;
+        }
+
+        /* map_files opens the mapped inode exactly; the path may have been replaced */
+        char map_file[64];
+        snprintf(map_file, sizeof(map_file), "/proc/self/map_files/%lx-%lx", start, end);
+        int fd = open(map_file, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            fd = open(path, O_RDONLY | O_CLOEXEC);
+        }
+        if (fd < 0) {
+            continue;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_ino != static_cast<ino_t>(inode) ||
+            st.st_dev != makedev(dev_major, dev_minor)) {
+            close(fd);
+            continue;
+        }
+
+        out[count].start = start;
+        out[count].end = end;
+        out[count].file_offset = offset;
+        out[count].fd = fd;
+        out[count].prot = (perms[0] == 'r' ? PROT_READ : 0) | (perms[1] == 'w' ? PROT_WRITE : 0) |
+                          (perms[2] == 'x' ? PROT_EXEC : 0);
+        ++count;
+    }
+    fclose(f);
+#else
+    (void)lo;
+    (void)hi;
+    (void)out;
+    (void)max;
+#endif
+    return count;
+}
+
+size_t guard_maps_huge_bytes(uintptr_t lo, uintptr_t hi) {
+    size_t total = 0;
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/smaps", "re");
+    if (f == nullptr) {
+        return 0;
+    }
+
+    static const char* const keys[] = {"AnonHugePages:", "FilePmdMapped:", "ShmemPmdMapped:"};
+    size_t overlap = 0;   /* Of the mapping whose fields follow not yet counted */
+    char line[4096 + 128];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        unsigned long start = 0, end = 0;
+        char perms[5] = {0};
+        if (sscanf(line, "%lx-%lx %4s", &start, &end, perms) == 3) {
+            const uintptr_t from = start > lo ? start : lo;
+            const uintptr_t to = end < hi ? end : hi;
+            overlap = from < to ? to - from : 0;
+            continue;
+        }
+        if (overlap == 0) {
+            continue;
+        }
+        for (const char* key : keys) {
+            const size_t key_len = strlen(key);
+            if (strncmp(line, key, key_len) == 0) {
+                const size_t bytes = static_cast<size_t>(strtoull(line + key_len, nullptr, 10)) * 1024;
+                const size_t counted = bytes < overlap ? bytes : overlap;
+                total += counted;
+                overlap -= counted;
+                break;
+            }
+        }
+    }
+    fclose(f);
+#else
+    (void)lo;
+    (void)hi;
+#endif
+    return total;
+}
+
+size_t guard_maps_anon_exec(guard_anon_range_t* out, size_t max) {
+    size_t count = 0;
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/maps", "re");
+    if (f == nullptr) {
+        return 0;
+    }
+
+    char line[4096 + 128];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        unsigned long start = 0, end = 0, offset = 0, inode = 0;
+        unsigned int dev_major = 0, dev_minor = 0;
+        char perms[5] = {0};
+        int path_pos = 0;
+        if (sscanf(line, "%lx-%lx %4s %lx %x:%x %lu %n", &start, &end, perms, &offset,
+                   &dev_major, &dev_minor, &inode, &path_pos) < 7) {
+            continue;
+        }
+        if (inode != 0 || perms[2] != 'x' || perms[0] != 'r') {
+            continue;
+        }
+
+        /* [vdso], [vsyscall], [uprobes]; [heap], [stack] and [anon:*] are fair game */
+        const char* name = path_pos > 0 ? line + path_pos : "";
+        if (name[0] == '[' && strncmp(name, "[heap]", 6) != 0 &&
+            strncmp(name, "[stack", 6) != 0 && strncmp(name, "[anon:", 6) != 0) {
+            continue;
+        }
+
+        if (count < max) {
+            out[count].start = start;
+            out[count].end = end;
+            out[count].prot = PROT_READ | PROT_EXEC | (perms[1] == 'w' ? PROT_WRITE : 0);
+        }
+        ++count;
+    }
+    fclose(f);
+#else
+    (void)out;
+    (void)max;
+#endif
+    return count;
+}
+
+size_t guard_maps_exec(guard_exec_mapping_t* out, size_t max) {
+    size_t count = 0;
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/maps", "re");
+    if (f == nullptr) {
+        return 0;
+    }
+
+    char line[4096 + 128];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        unsigned long start = 0, end = 0, offset = 0, inode = 0;
+        unsigned int dev_major = 0, dev_minor = 0;
+        char perms[5] = {0};
+        int path_pos = 0;
+        if (sscanf(line, "%lx-%lx %4s %lx %x:%x %lu %n", &start, &end, perms, &offset,
+                   &dev_major, &dev_minor, &inode, &path_pos) < 7) {
+            continue;
+        }
+        if (perms[2] != 'x') {
+            continue;
+        }
+
+        char* name = path_pos > 0 ? line + path_pos : line + strlen(line);
+        name[strcspn(name, "\n")] = '\0';
+        int kind;
+        if (inode == 0) {
+            if (name[0] == '[' && strncmp(name, "[heap]", 6) != 0 &&
+                strncmp(name, "[stack", 6) != 0 && strncmp(name, "[anon:", 6) != 0) {
+                continue;
+            }
+            kind = GUARD_EXEC_ANON;
+        } else if (strncmp(name, "/memfd:", 7) == 0) {
+            kind = GUARD_EXEC_MEMFD;
+        } else {
+            const size_t len = strlen(name);
+            kind = (len >= 10 && strcmp(name + len - 10, " (deleted)") == 0) ? GUARD_EXEC_DELETED
+                                                                             : GUARD_EXEC_FILE;
+        }
+
+        if (count < max) {
+            out[count].start = start;
+            out[count].end = end;
+            out[count].dev = makedev(dev_major, dev_minor);
+            out[count].inode = inode;
+            out[count].prot = (perms[0] == 'r' ? PROT_READ : 0) | (perms[1] == 'w' ? PROT_WRITE : 0) |
+                              PROT_EXEC;
+            out[count].kind = kind;
+        }
+        ++count;
+    }
+    fclose(f);
+#else
+    (void)out;
+    (void)max;
+#endif
+    return count;
+}
+
+int guard_exec_footprint(uint64_t out[3]) {
+#if defined(__linux__)
+    int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    char buf[4096];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    static const char* const keys[3] = {"\nVmExe:", "\nVmLib:", "\nVmData:"};
+    for (int i = 0; i < 3; ++i) {
+        const char* at = strstr(buf, keys[i]);
+        if (at == nullptr) {
+            return -1;
+        }
+        out[i] = strtoull(at + strlen(keys[i]), nullptr, 10);
+    }
+    return 0;
+#else
+    (void)out;
+    return -1;
+#endif
+}
+
+void guard_maps_release(guard_file_range_t* ranges, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (ranges[i].fd >= 0) {
+            close(ranges[i].fd);
+            ranges[i].fd = -1;
+        }
+    }
+}
+
+} /* extern "C" */
@@ -0,0 +1,128 @@
+/*
+ * Self-Guard Page Residency and Backing Queries
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_PAGEMAP_H
+#define SG_INTERNAL_PAGEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* /proc/self/pagemap entry flags (Documentation/admin-guide/mm/pagemap.rst) */
+#define SG_PAGEMAP_EXCLUSIVE  (1ULL << 56)  /* Mapped by this process only */
+#define SG_PAGEMAP_FILE       (1ULL << 61)  /* File page or shared anon */
+#define SG_PAGEMAP_SWAPPED    (1ULL << 62)
+#define SG_PAGEMAP_PRESENT    (1ULL << 63)
+
+/*
+ * Open /proc/self/pagemap once for the life of the process.
+ * Returns 0 if pagemap queries are available.
+ */
+int guard_pagemap_open(void);
+
+/*
+ * One pread of the entries for npages system pages starting at the
+ * page containing addr. Returns 0 on success.
+ */
+int guard_pagemap_read(const void* addr, size_t npages, uint64_t* entries);
+
+/*
+ * Residency of npages system pages starting at the page containing
+ * addr, in pagemap entry format. Uses pagemap when open, otherwise
+ * mincore (which only sets SG_PAGEMAP_PRESENT and reports page-cache
+ * rather than page-table residency). Never faults pages in.
+ */
+int guard_residency_read(const void* addr, size_t npages, uint64_t* entries);
+
+/*
+ * Copy len bytes of this process's memory at addr into buf, through
+ * process_vm_readv: memory unmapped meanwhile (dlclose, a JIT freeing
+ * code) makes the copy stop short instead of raising SIGSEGV. Returns
+ * the bytes copied, all of them up to the first unreadable page. Where
+ * the call is filtered or missing, reads /proc/self/mem instead (EIO
+ * rather than a fault); with neither, copies nothing and returns 0.
+ */
+size_t guard_read_self(const void* addr, void* buf, size_t len);
+
+/* 1 if guard_read_self has a fault-tolerant path here, 0 if it reads nothing */
+int guard_read_self_available(void);
+
+/* A private file mapping backing part of the code section */
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+    uint64_t file_offset;
+    int fd;                 /* The mapped inode itself, O_RDONLY */
+    int prot;               /* PROT_* of the mapping */
+} guard_file_range_t;
+
+/*
+ * Index the private file mappings overlapping [lo, hi) from
+ * /proc/self/maps and open their backing files. A file is only used
+ * if it is still the mapped inode. Returns the number of ranges.
+ */
+size_t guard_maps_index(uintptr_t lo, uintptr_t hi, guard_file_range_t* out, size_t max);
+void guard_maps_release(guard_file_range_t* ranges, size_t count);
+
+/*
+ * Bytes of the mappings overlapping [lo, hi) that are mapped with PMD
+ * (huge) pages: AnonHugePages, FilePmdMapped and ShmemPmdMapped from
+ * /proc/self/smaps. A mapping only partly inside counts at most its
+ * overlap. Returns 0 where smaps is unavailable.
+ */
+size_t guard_maps_huge_bytes(uintptr_t lo, uintptr_t hi);
+
+/* An executable mapping with no backing file (JIT, shellcode, ...) */
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+    int prot;
+} guard_anon_range_t;
+
+/*
+ * Readable executable mappings without an inode, in address order.
+ * The vDSO and other kernel-provided mappings are left out. Returns
+ * the number found, which may exceed max (only max are stored).
+ */
+size_t guard_maps_anon_exec(guard_anon_range_t* out, size_t max);
+
+/* What backs an executable mapping */
+#define GUARD_EXEC_FILE     0   /* A file still linked in the filesystem */
+#define GUARD_EXEC_ANON     1   /* Nothing: JIT output, heap, injected code */
+#define GUARD_EXEC_DELETED  2   /* A file unlinked since it was mapped */
+#define GUARD_EXEC_MEMFD    3   /* A memfd, i.e. a file that never had a path */
+
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+    uint64_t dev;
+    uint64_t inode;
+    int prot;
+    int kind;               /* GUARD_EXEC_* */
+} guard_exec_mapping_t;
+
+/*
+ * Every executable mapping except the kernel-provided ones ([vdso],
+ * [vsyscall], [uprobes]), in address order. Returns the number found,
+ * which may exceed max (only max are stored).
+ */
+size_t guard_maps_exec(guard_exec_mapping_t* out, size_t max);
+
+/*
+ * VmExe, VmLib and VmData (kB) from /proc/self/status. Mapping,
+ * unmapping or mprotect'ing executable memory changes one of them:
+ * read-only executable mappings count towards VmExe/VmLib, writable
+ * ones towards VmData. Returns 0 on success.
+ */
+int guard_exec_footprint(uint64_t out[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_PAGEMAP_H */
@@ -0,0 +1,681 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Pre-load File Verification
+ *
+ * Responsibilities:
+ * - Stream a file in large aligned chunks (io_uring, pread fallback)
+ * - Hash chunks in file order as they complete: SHA-256 of the whole
+ *   file against the caller's manifest, and page digests of the
+ *   executable segment with the tuned checksum kernel
+ * - Retain the segment digests of verified files for module baselines
+ * - Hand the verified descriptor out, so the caller loads that inode
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__linux__) || defined(__FreeBSD__)
+#include <link.h>
+#define SG_HAVE_ELF_HEADERS 1
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+/* IORING_OP_READ arrived with IORING_FEAT_RW_CUR_POS (5.6) */
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(IORING_FEAT_RW_CUR_POS)
+#define SG_HAVE_IO_URING 1
+#endif
+#endif
+
+#include "pagemap.h"
+#include "preload.h"
+#include "sha256.h"
+#include "tuning.h"
+
+namespace {
+
+constexpr size_t VERIFY_CHUNK = 1u << 20;
+constexpr unsigned VERIFY_DEPTH = 4;
+constexpr size_t MAX_RETAINED = 32;
+
+/* ============================================
+ * Retained Segment Digests
+ * ============================================ */
+
+/* Same identity the baseline cache keys on */
+struct FileKey {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_sec;
+    long mtime_nsec;
+
+    bool operator==(const FileKey& other) const {
+        return dev == other.dev && ino == other.ino && size == other.size &&
+               mtime_sec == other.mtime_sec && mtime_nsec == other.mtime_nsec;
+    }
+};
+
+FileKey file_key(const struct stat& st) {
+#if defined(__APPLE__)
+    const struct timespec& mtime = st.st_mtimespec;
+#else
+    const struct timespec& mtime = st.st_mtim;
+#endif
+    FileKey key;
+    key.dev = static_cast<uint64_t>(st.st_dev);
+    key.ino = static_cast<uint64_t>(st.st_ino);
+    key.size = static_cast<uint64_t>(st.st_size);
+    key.mtime_sec = static_cast<int64_t>(mtime.tv_sec);
+    key.mtime_nsec = static_cast<long>(mtime.tv_nsec);
+    return key;
+}
+
+struct RetainedFile {
+    FileKey key;
+    uint64_t segment_offset;
+    uint64_t segment_size;
+    size_t page_size;
+    std::vector<uint32_t> digests;
+};
+
+std::mutex g_retained_mutex;
+std::vector<RetainedFile> g_retained;   /* Oldest first */
+
+void retain_file(RetainedFile&& file) {
+    std::lock_guard<std::mutex> lock(g_retained_mutex);
+    for (RetainedFile& existing : g_retained) {
+        if (existing.key == file.key) {
+            existing = std::move(file);
+            return;
+        }
+    }
+    try {
+        if (g_retained.size() == MAX_RETAINED) {
+            g_retained.erase(g_retained.begin());
+        }
+        g_retained.push_back(std::move(file));
+    } catch (const std::bad_alloc&) {
+        /* Only costs a rehash later */
+    }
+}
+
+/* ============================================
+ * io_uring Reader
+ * ============================================ */
+
+#if defined(SG_HAVE_IO_URING)
+
+/* Minimal raw ring: IORING_OP_READ submissions and completion reaping */
+class UringReader {
+public:
+    UringReader() : ring_fd_(-1), sq_ptr_(MAP_FAILED), cq_ptr_(MAP_FAILED), sqes_(MAP_FAILED),
+                    sq_size_(0), cq_size_(0), sqes_size_(0), to_submit_(0) {}
+
+    ~UringReader() { close(); }
+
+    bool open(unsigned entries) {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd_ < 0) {
+            return false;   /* ENOSYS, or disabled by sysctl or seccomp */
+        }
+        fcntl(ring_fd_, F_SETFD, FD_CLOEXEC);
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            sq_size_ = cq_size_ = sq_size_ > cq_size_ ? sq_size_ : cq_size_;
+        }
+
+        sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) {
+            close();
+            return false;
+        }
+        if (single) {
+            cq_ptr_ = sq_ptr_;
+        } else {
+            cq_ptr_ = mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ptr_ == MAP_FAILED) {
+                close();
+                return false;
+            }
+        }
+        sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) {
+            close();
+            return false;
+        }
+
+        uint8_t* sq = static_cast<uint8_t*>(sq_ptr_);
+        uint8_t* cq = static_cast<uint8_t*>(cq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void close() {
+        if (sqes_ != MAP_FAILED) {
+            munmap(sqes_, sqes_size_);
+        }
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+            munmap(cq_ptr_, cq_size_);
+        }
+        if (sq_ptr_ != MAP_FAILED) {
+            munmap(sq_ptr_, sq_size_);
+        }
+        sq_ptr_ = cq_ptr_ = sqes_ = MAP_FAILED;
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+            ring_fd_ = -1;
+        }
+    }
+
+    int fd() const { return ring_fd_; }
+
+    /* The caller never has more reads queued than ring entries */
+    void queue_read(int fd, void* buf, uint32_t len, uint64_t offset, uint64_t tag) {
+        const unsigned tail = *sq_tail_;
+        const unsigned index = tail & sq_mask_;
+        struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(buf);
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->user_data = tag;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++to_submit_;
+    }
+
+    /* Submit queued reads; with min_complete, block until that many finished */
+    bool enter(unsigned min_complete) {
+        if (to_submit_ == 0 && min_complete == 0) {
+            return true;
+        }
+        for (;;) {
+            long n = syscall(__NR_io_uring_enter, ring_fd_, to_submit_, min_complete,
+                             min_complete != 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (n >= 0) {
+                to_submit_ -= static_cast<unsigned>(n) < to_submit_ ? static_cast<unsigned>(n) : to_submit_;
+                return true;
+            }
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+    template <typename F>
+    void reap(F on_complete) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            on_complete(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    int ring_fd_;
+    void* sq_ptr_;
+    void* cq_ptr_;
+    void* sqes_;
+    size_t sq_size_;
+    size_t cq_size_;
+    size_t sqes_size_;
+    unsigned to_submit_;
+    unsigned* sq_tail_;
+    unsigned sq_mask_;
+    unsigned* sq_array_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    struct io_uring_cqe* cqes_;
+};
+
+#endif /* SG_HAVE_IO_URING */
+
+/* Fill buf from offset; false on error or early EOF */
+bool pread_full(int fd, uint8_t* buf, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+enum SlotState { SLOT_FREE, SLOT_READING, SLOT_DONE };
+
+struct VerifySlot {
+    SlotState state;
+    uint64_t offset;
+    size_t len;
+    int result;           /* Bytes read or -errno */
+};
+
+/* ============================================
+ * Verification Operation
+ * ============================================ */
+
+/* Behind the opaque sg_verify_op_t handle */
+struct VerifyOp {
+    int fd;
+    FileKey key;
+    uint64_t file_size;
+    uint8_t expected[SG_VERIFY_DIGEST_SIZE];
+    int status;                 /* sg_verify_status_t */
+    guard_sha256_t sha;
+
+    /* Executable segment digested page by page, if the file is ELF */
+    bool track;
+    uint64_t segment_offset;
+    uint64_t segment_size;
+    size_t page_size;
+    std::vector<uint32_t> digests;
+    std::vector<uint8_t> carry; /* Page straddling two chunks */
+    size_t carry_len;
+
+    uint8_t* buffers;           /* VERIFY_DEPTH page-aligned chunks */
+    VerifySlot slots[VERIFY_DEPTH];
+    uint64_t next_read;         /* File offset of the next chunk to queue */
+    uint64_t next_hash;         /* File offset of the next chunk to hash */
+    unsigned in_flight;
+#if defined(SG_HAVE_IO_URING)
+    UringReader ring;
+#endif
+    bool use_ring;
+
+    /* Find the first PF_X PT_LOAD, as the module walk does */
+    void find_segment(const uint8_t* data, size_t len) {
+#if defined(SG_HAVE_ELF_HEADERS)
+        if (len < sizeof(ElfW(Ehdr))) {
+            return;
+        }
+        ElfW(Ehdr) ehdr;
+        std::memcpy(&ehdr, data, sizeof(ehdr));
+        if (std::memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+            ehdr.e_ident[EI_CLASS] != (sizeof(void*) == 8 ? ELFCLASS64 : ELFCLASS32) ||
+            ehdr.e_phentsize != sizeof(ElfW(Phdr)) ||
+            ehdr.e_phoff + static_cast<uint64_t>(ehdr.e_phnum) * sizeof(ElfW(Phdr)) > len) {
+            return;
+        }
+        for (ElfW(Half) i = 0; i < ehdr.e_phnum; ++i) {
+            ElfW(Phdr) ph;
+            std::memcpy(&ph, data + ehdr.e_phoff + i * sizeof(ElfW(Phdr)), sizeof(ph));
+            if (ph.p_type != PT_LOAD || !(ph.p_flags & PF_X)) {
+                continue;
+            }
+            if (ph.p_filesz == ph.p_memsz && ph.p_filesz != 0 &&
+                ph.p_offset + ph.p_filesz <= file_size) {
+                try {
+                    digests.resize((ph.p_filesz + page_size - 1) / page_size);
+                    carry.resize(page_size);
+                } catch (const std::bad_alloc&) {
+                    return;
+                }
+                track = true;
+                segment_offset = ph.p_offset;
+                segment_size = ph.p_filesz;
+            }
+            return;
+        }
+#else
+        (void)data;
+        (void)len;
+#endif
+    }
+
+    /* Digest the segment pages covered by one chunk */
+    void digest_segment(const uint8_t* data, uint64_t offset, size_t len) {
+        const uint64_t segment_end = segment_offset + segment_size;
+        uint64_t pos = offset > segment_offset ? offset : segment_offset;
+        const uint64_t end = offset + len < segment_end ? offset + len : segment_end;
+        const sg_checksum_fn checksum = guard_tuning_kernel();
+
+        while (pos < end) {
+            const size_t page = static_cast<size_t>((pos - segment_offset) / page_size);
+            const uint64_t page_start = segment_offset + page * page_size;
+            const uint64_t page_end = page_start + page_size < segment_end ? page_start + page_size : segment_end;
+            const size_t page_len = static_cast<size_t>(page_end - page_start);
+
+            if (carry_len == 0 && pos == page_start && page_end <= end) {
+                digests[page] = checksum(data + (pos - offset), page_len);
+                pos = page_end;
+                continue;
+            }
+            const size_t take = static_cast<size_t>((page_end < end ? page_end : end) - pos);
+            std::memcpy(carry.data() + carry_len, data + (pos - offset), take);
+            carry_len += take;
+            pos += take;
+            if (carry_len == page_len) {
+                digests[page] = checksum(carry.data(), page_len);
+                carry_len = 0;
+            }
+        }
+    }
+
+    void hash_chunk(const uint8_t* data, uint64_t offset, size_t len) {
+        if (offset == 0) {
+            find_segment(data, len);
+        }
+        guard_sha256_update(&sha, data, len);
+        if (track) {
+            digest_segment(data, offset, len);
+        }
+        next_hash = offset + len;
+    }
+
+    void finish() {
+        uint8_t digest[SG_SHA256_DIGEST_SIZE];
+        guard_sha256_final(&sha, digest);
+        /* A write while we streamed it moves the mtime: what we hashed may be torn */
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !(file_key(st) == key)) {
+            status = SG_VERIFY_MISMATCH;
+            return;
+        }
+        if (std::memcmp(digest, expected, sizeof(digest)) != 0) {
+            status = SG_VERIFY_MISMATCH;
+            return;
+        }
+        status = SG_VERIFY_MATCH;
+        if (track) {
+            RetainedFile file;
+            file.key = key;
+            file.segment_offset = segment_offset;
+            file.segment_size = segment_size;
+            file.page_size = page_size;
+            file.digests.swap(digests);
+            retain_file(std::move(file));
+        }
+    }
+
+    size_t chunk_len(uint64_t offset) const {
+        return file_size - offset < VERIFY_CHUNK ? static_cast<size_t>(file_size - offset) : VERIFY_CHUNK;
+    }
+
+    uint8_t* slot_buffer(unsigned slot) const {
+        return buffers + static_cast<size_t>(slot) * VERIFY_CHUNK;
+    }
+
+    /* Synchronous path: one chunk per call */
+    void poll_pread() {
+        const size_t len = chunk_len(next_hash);
+        if (!pread_full(fd, buffers, len, next_hash)) {
+            status = SG_VERIFY_ERROR;
+            return;
+        }
+        hash_chunk(buffers, next_hash, len);
+    }
+
+#if defined(SG_HAVE_IO_URING)
+    /* Keep every slot reading ahead; chunk c always uses slot c % depth */
+    void queue_reads() {
+        while (next_read < file_size) {
+            const unsigned slot = static_cast<unsigned>((next_read / VERIFY_CHUNK) % VERIFY_DEPTH);
+            if (slots[slot].state != SLOT_FREE) {
+                break;
+            }
+            slots[slot].state = SLOT_READING;
+            slots[slot].offset = next_read;
+            slots[slot].len = chunk_len(next_read);
+            ring.queue_read(fd, slot_buffer(slot), static_cast<uint32_t>(slots[slot].len),
+                            next_read, slot);
+            ++in_flight;
+            next_read += slots[slot].len;
+        }
+    }
+
+    void reap() {
+        ring.reap([this](uint64_t tag, int res) {
+            if (tag < VERIFY_DEPTH) {
+                slots[tag].state = SLOT_DONE;
+                slots[tag].result = res;
+                --in_flight;
+            }
+        });
+    }
+
+    void poll_ring(bool wait) {
+        queue_reads();
+        unsigned slot = static_cast<unsigned>((next_hash / VERIFY_CHUNK) % VERIFY_DEPTH);
+        if (!ring.enter(wait && slots[slot].state == SLOT_READING ? 1 : 0)) {
+            status = SG_VERIFY_ERROR;
+            return;
+        }
+        reap();
+
+        /* Hash in file order; later chunks wait in their slots */
+        while (next_hash < file_size && slots[slot].state == SLOT_DONE) {
+            VerifySlot& s = slots[slot];
+            uint8_t* buf = slot_buffer(slot);
+            const size_t got = s.result > 0 ? static_cast<size_t>(s.result) : 0;
+            /* Short reads and unsupported opcodes finish synchronously */
+            if (got < s.len && !pread_full(fd, buf + got, s.len - got, s.offset + got)) {
+                status = SG_VERIFY_ERROR;
+                return;
+            }
+            hash_chunk(buf, s.offset, s.len);
+            s.state = SLOT_FREE;
+            slot = static_cast<unsigned>((next_hash / VERIFY_CHUNK) % VERIFY_DEPTH);
+        }
+        queue_reads();
+        if (!ring.enter(0)) {
+            status = SG_VERIFY_ERROR;
+        }
+    }
+
+    /* Reads into buffers must not outlive them */
+    void drain() {
+        while (in_flight > 0 && ring.enter(in_flight)) {
+            reap();
+        }
+    }
+#endif
+};
+
+/* Is the executable mapping holding addr backed by the file with this key? */
+bool mapped_file_is(const void* addr, const FileKey& key) {
+    std::vector<guard_exec_mapping_t> maps(64);
+    size_t found = guard_maps_exec(maps.data(), maps.size());
+    if (found > maps.size()) {
+        maps.resize(found + 16);
+        found = guard_maps_exec(maps.data(), maps.size());
+    }
+    const uintptr_t at = reinterpret_cast<uintptr_t>(addr);
+    for (size_t i = 0; i < found && i < maps.size(); ++i) {
+        if (at >= maps[i].start && at < maps[i].end) {
+            return maps[i].kind == GUARD_EXEC_FILE && maps[i].dev == key.dev &&
+                   maps[i].inode == key.ino;
+        }
+    }
+    return false;
+}
+
+VerifyOp* to_op(sg_verify_op_t* handle) {
+    return reinterpret_cast<VerifyOp*>(handle);
+}
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_verify_begin(const char* path, const uint8_t expected[SG_VERIFY_DIGEST_SIZE],
+                       sg_verify_op_t** out) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+
+    VerifyOp* op = new (std::nothrow) VerifyOp();
+    void* buffers = nullptr;
+    const long page = sysconf(_SC_PAGESIZE);
+    if (op == nullptr ||
+        posix_memalign(&buffers, page > 0 ? static_cast<size_t>(page) : 4096,
+                       VERIFY_CHUNK * VERIFY_DEPTH) != 0) {
+        delete op;
+        close(fd);
+        return -1;
+    }
+
+    op->fd = fd;
+    op->key = file_key(st);
+    op->file_size = static_cast<uint64_t>(st.st_size);
+    std::memcpy(op->expected, expected, SG_VERIFY_DIGEST_SIZE);
+    op->status = SG_VERIFY_PENDING;
+    guard_sha256_init(&op->sha);
+    op->track = false;
+    op->page_size = page > 0 ? static_cast<size_t>(page) : 4096;
+    op->carry_len = 0;
+    op->buffers = static_cast<uint8_t*>(buffers);
+    for (VerifySlot& slot : op->slots) {
+        slot.state = SLOT_FREE;
+    }
+    op->next_read = 0;
+    op->next_hash = 0;
+    op->in_flight = 0;
+#if defined(SG_HAVE_IO_URING)
+    op->use_ring = op->ring.open(VERIFY_DEPTH);
+    if (op->use_ring) {
+        op->queue_reads();
+        if (!op->ring.enter(0)) {
+            op->status = SG_VERIFY_ERROR;
+        }
+    }
+#else
+    op->use_ring = false;
+#endif
+
+    *out = reinterpret_cast<sg_verify_op_t*>(op);
+    return 0;
+}
+
+int guard_verify_poll(sg_verify_op_t* handle, int wait) {
+    VerifyOp* op = to_op(handle);
+    do {
+        if (op->status != SG_VERIFY_PENDING) {
+            break;
+        }
+        if (op->next_hash >= op->file_size) {
+            op->finish();
+            break;
+        }
+#if defined(SG_HAVE_IO_URING)
+        if (op->use_ring) {
+            op->poll_ring(wait != 0);
+            continue;
+        }
+#endif
+        op->poll_pread();
+    } while (wait || (op->status == SG_VERIFY_PENDING && op->next_hash >= op->file_size));
+    return op->status;
+}
+
+int guard_verify_fd(const sg_verify_op_t* handle) {
+    const VerifyOp* op = reinterpret_cast<const VerifyOp*>(handle);
+#if defined(SG_HAVE_IO_URING)
+    if (op->use_ring) {
+        return op->ring.fd();
+    }
+#endif
+    (void)op;
+    return -1;
+}
+
+int guard_verify_take_fd(sg_verify_op_t* handle) {
+    VerifyOp* op = to_op(handle);
+    if (op->status != SG_VERIFY_MATCH || op->fd < 0) {
+        return -1;
+    }
+    const int fd = op->fd;
+    op->fd = -1;
+    return fd;
+}
+
+void guard_verify_release(sg_verify_op_t* handle) {
+    VerifyOp* op = to_op(handle);
+#if defined(SG_HAVE_IO_URING)
+    if (op->use_ring) {
+        op->drain();
+        op->ring.close();
+    }
+#endif
+    if (op->fd >= 0) {
+        close(op->fd);
+    }
+    free(op->buffers);
+    delete op;
+}
+
+int guard_preload_digests(const guard_module_info_t* module, size_t page_size,
+                          uint32_t* digests, size_t count) {
+    if (!module->file_exact) {
+        return -1;
+    }
+    struct stat st;
+    if (stat(module->path, &st) != 0) {
+        return -1;
+    }
+    const FileKey key = file_key(st);
+
+    {
+        std::lock_guard<std::mutex> lock(g_retained_mutex);
+        auto it = g_retained.begin();
+        while (it != g_retained.end() &&
+               !(it->key == key && it->segment_offset == module->file_offset &&
+                 it->segment_size == module->size && it->page_size == page_size &&
+                 it->digests.size() == count)) {
+            ++it;
+        }
+        if (it == g_retained.end()) {
+            return -1;
+        }
+        std::memcpy(digests, it->digests.data(), count * sizeof(uint32_t));
+    }
+
+    /* The path may name another file than the one mapped: ask the maps */
+    return mapped_file_is(module->start, key) ? 0 : -1;
+}
+
+} /* extern "C" */
@@ -0,0 +1,51 @@
+/*
+ * Self-Guard Pre-load File Verification
+ * Internal interface used by the C API and the C++ core
+ */
+
+#ifndef SG_INTERNAL_PRELOAD_H
+#define SG_INTERNAL_PRELOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "self_guard.h"
+#include "modules.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Open path and start streaming it (io_uring when available, pread
+ * otherwise). Returns 0 and a new operation in *out, -1 if the file
+ * cannot be opened or the buffers cannot be allocated.
+ */
+int guard_verify_begin(const char* path, const uint8_t expected[SG_VERIFY_DIGEST_SIZE],
+                       sg_verify_op_t** out);
+
+/* Hash the chunks that have arrived; wait != 0 runs to completion */
+int guard_verify_poll(sg_verify_op_t* op, int wait);
+
+/* io_uring descriptor to poll for readability, -1 with the pread fallback */
+int guard_verify_fd(const sg_verify_op_t* op);
+
+/* The descriptor of a MATCH, now owned by the caller; -1 otherwise */
+int guard_verify_take_fd(sg_verify_op_t* op);
+
+/* Waits for in-flight reads before freeing their buffers */
+void guard_verify_release(sg_verify_op_t* op);
+
+/*
+ * Page digests of a module's executable segment retained from a file
+ * that matched its expected digest, so the baseline needs no rehash.
+ * Returns 0 if the module's file was verified and is unchanged, and
+ * is the file mapped at the module's address.
+ */
+int guard_preload_digests(const guard_module_info_t* module, size_t page_size,
+                          uint32_t* digests, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_PRELOAD_H */
@@ -6,19 +6,58 @@
  * - Public API implementation
  * - Input validation
  * - C++ core orchestration
+ * - Caller statistics: with SG_OPT_CALLER_STATS the check entry points
+ *   charge the time spent to the address they return to
  */
 
 #include "self_guard.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 /* Forward declarations for C++ core functions */
 extern int guard_core_init(void);
 extern int guard_core_shutdown(void);
 extern int guard_core_snapshot(void);
 extern int guard_core_check_integrity(uint32_t flags);
+extern int guard_core_check_integrity_ex(uint32_t flags, sg_check_result_t* out);
 extern int guard_core_detect_debugger(void);
 extern int guard_core_get_state(void);
+extern int guard_core_require_fresh(uint64_t max_age_ns, uint32_t flags);
+extern int guard_core_get_state_info(sg_state_info_t* out);
+extern int guard_core_set_option(uint32_t option, uint64_t value);
+extern int guard_core_get_repair_info(sg_repair_info_t* out);
+extern int guard_core_register_thread(void);
+extern int guard_core_watch(const void* addr, size_t len, uint32_t type);
+extern int guard_core_set_slo(uint32_t detector, uint64_t max_staleness_ns);
+extern int guard_core_set_region_slo(const void* addr, uint64_t max_staleness_ns);
+extern int guard_core_set_region_granule(const void* addr, size_t bytes);
+extern int guard_core_monitor_start(void);
+extern int guard_core_monitor_stop(void);
+extern int guard_core_get_stats(sg_stats_t* out);
+extern int guard_watch_remove(const void* addr);
+extern int guard_watch_query(const void* addr, int* mode, int* type, uint64_t* hits);
+extern int guard_tuning_load(const char* path);
+extern int guard_autotune(const char* path, sg_tuning_info_t* out);
+extern int guard_tuning_info(sg_tuning_info_t* out);
+extern int guard_baseline_cache_set(const char* dir);
+extern int guard_signatures_load(const char* path);
+extern int guard_verify_begin(const char* path, const uint8_t expected[SG_VERIFY_DIGEST_SIZE],
+                              sg_verify_op_t** out);
+extern int guard_verify_poll(sg_verify_op_t* op, int wait);
+extern int guard_verify_fd(const sg_verify_op_t* op);
+extern int guard_verify_take_fd(sg_verify_op_t* op);
+extern void guard_verify_release(sg_verify_op_t* op);
+extern int guard_journal_open(const char* path, uint64_t capacity);
+extern int guard_journal_close(void);
+extern int guard_journal_active(void);
+extern int guard_core_attest_attach(const char* socket_path);
+extern int guard_attest_detach(void);
+extern int guard_attest_active(void);
+extern int guard_callers_enabled(void);
+extern uint64_t guard_callers_clock(void);
+extern void guard_callers_record(const void* caller, uint32_t call, uint64_t start);
+extern size_t guard_callers_report(sg_caller_stats_t* out, size_t max);
 
 /* Global initialization flag (protected by C++ layer mutex) */
 static volatile int sg_initialized = 0;
@@ -32,6 +71,17 @@ sg_result_t sg_init(void) {
         return SG_ERR_ALREADY_INIT;
     }
 
+    /* Tuning must be active before the baseline digests are taken */
+    const char* tuning_file = getenv("SG_TUNING_FILE");
+    if (tuning_file != NULL && tuning_file[0] != '\0') {
+        (void)guard_tuning_load(tuning_file);
+    }
+
+    const char* cache_dir = getenv("SG_BASELINE_CACHE");
+    if (cache_dir != NULL && cache_dir[0] != '\0') {
+        (void)guard_baseline_cache_set(cache_dir);
+    }
+
     int result = guard_core_init();
     if (result != 0) {
         return SG_ERR_INIT;
@@ -54,7 +104,7 @@ sg_result_t sg_snapshot(void) {
     return SG_OK;
 }
 
-sg_result_t sg_check_integrity(uint32_t flags) {
+static sg_result_t check_integrity(uint32_t flags) {
     if (!sg_initialized) {
         return SG_ERR_NOT_INIT;
     }
@@ -72,7 +122,46 @@ sg_result_t sg_check_integrity(uint32_t flags) {
     return SG_OK;
 }
 
-int sg_detect_debugger(void) {
+sg_result_t sg_check_integrity(uint32_t flags) {
+    if (!guard_callers_enabled()) {
+        return check_integrity(flags);
+    }
+
+    const uint64_t start = guard_callers_clock();
+    sg_result_t result = check_integrity(flags);
+    guard_callers_record(__builtin_return_address(0), SG_CALL_CHECK_INTEGRITY, start);
+    return result;
+}
+
+static sg_result_t check_integrity_ex(uint32_t flags, sg_check_result_t* out) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (flags == 0 || out == NULL) {
+        return SG_ERR_INTERNAL;
+    }
+
+    int result = guard_core_check_integrity_ex(flags, out);
+    if (result != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_check_integrity_ex(uint32_t flags, sg_check_result_t* out) {
+    if (!guard_callers_enabled()) {
+        return check_integrity_ex(flags, out);
+    }
+
+    const uint64_t start = guard_callers_clock();
+    sg_result_t result = check_integrity_ex(flags, out);
+    guard_callers_record(__builtin_return_address(0), SG_CALL_CHECK_INTEGRITY_EX, start);
+    return result;
+}
+
+static int detect_debugger(void) {
     if (!sg_initialized) {
         return -1;
     }
@@ -80,6 +169,17 @@ int sg_detect_debugger(void) {
     return guard_core_detect_debugger();
 }
 
+int sg_detect_debugger(void) {
+    if (!guard_callers_enabled()) {
+        return detect_debugger();
+    }
+
+    const uint64_t start = guard_callers_clock();
+    int result = detect_debugger();
+    guard_callers_record(__builtin_return_address(0), SG_CALL_DETECT_DEBUGGER, start);
+    return result;
+}
+
 sg_security_state_t sg_get_security_state(void) {
     if (!sg_initialized) {
         /* Fail-secure: assume compromised if not initialized */
@@ -96,6 +196,279 @@ sg_security_state_t sg_get_security_state(void) {
     return (sg_security_state_t)state;
 }
 
+static sg_security_state_t require_fresh(uint64_t max_age_ns, uint32_t flags) {
+    if (!sg_initialized || flags == 0) {
+        /* Fail-secure: assume compromised if not initialized */
+        return SG_COMPROMISED;
+    }
+
+    int state = guard_core_require_fresh(max_age_ns, flags);
+
+    if (state < SG_SAFE || state > SG_COMPROMISED) {
+        return SG_COMPROMISED;
+    }
+
+    return (sg_security_state_t)state;
+}
+
+sg_security_state_t sg_require_fresh(uint64_t max_age_ns, uint32_t flags) {
+    if (!guard_callers_enabled()) {
+        return require_fresh(max_age_ns, flags);
+    }
+
+    const uint64_t start = guard_callers_clock();
+    sg_security_state_t result = require_fresh(max_age_ns, flags);
+    guard_callers_record(__builtin_return_address(0), SG_CALL_REQUIRE_FRESH, start);
+    return result;
+}
+
+sg_result_t sg_get_state_info(sg_state_info_t* out) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (out == NULL || guard_core_get_state_info(out) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_set_option(sg_option_t option, uint64_t value) {
+    if (guard_core_set_option((uint32_t)option, value) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_get_repair_info(sg_repair_info_t* out) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (out == NULL || guard_core_get_repair_info(out) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_register_thread(void) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (guard_core_register_thread() != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_watch(const void* addr, size_t len, sg_watch_type_t type) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (guard_core_watch(addr, len, (uint32_t)type) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_unwatch(const void* addr) {
+    if (guard_watch_remove(addr) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_watch_info(const void* addr, sg_watch_info_t* out) {
+    int mode;
+    int type;
+    uint64_t hits;
+    if (out == NULL || guard_watch_query(addr, &mode, &type, &hits) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    out->mode = (uint32_t)mode;
+    out->type = (uint32_t)type;
+    out->hits = hits;
+    return SG_OK;
+}
+
+sg_result_t sg_set_slo(sg_detector_t detector, uint64_t max_staleness_ns) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if ((uint32_t)detector >= SG_DETECTOR_MAX ||
+        guard_core_set_slo((uint32_t)detector, max_staleness_ns) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_set_region_slo(const void* addr, uint64_t max_staleness_ns) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (guard_core_set_region_slo(addr, max_staleness_ns) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_set_region_granule(const void* addr, size_t bytes) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (guard_core_set_region_granule(addr, bytes) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_monitor_start(void) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    int result = guard_core_monitor_start();
+    if (result > 0) {
+        return SG_ERR_ALREADY_INIT;
+    }
+    if (result != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_monitor_stop(void) {
+    if (!sg_initialized || guard_core_monitor_stop() != 0) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_get_stats(sg_stats_t* out) {
+    if (!sg_initialized) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    if (out == NULL || guard_core_get_stats(out) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+size_t sg_get_callers(sg_caller_stats_t* out, size_t max) {
+    if (out == NULL) {
+        max = 0;
+    }
+
+    return guard_callers_report(out, max);
+}
+
+sg_result_t sg_set_baseline_cache(const char* dir) {
+    if (guard_baseline_cache_set(dir) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_load_signatures(const char* path) {
+    if (guard_signatures_load(path) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_autotune(const char* path, sg_tuning_info_t* out) {
+    if (guard_autotune(path, out) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_get_tuning(sg_tuning_info_t* out) {
+    if (out == NULL || guard_tuning_info(out) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_verify_status_t sg_verify_file(const char* path,
+                                  const uint8_t expected[SG_VERIFY_DIGEST_SIZE]) {
+    sg_verify_op_t* op = NULL;
+    if (sg_verify_file_async(path, expected, &op) != SG_OK) {
+        return SG_VERIFY_ERROR;
+    }
+
+    sg_verify_status_t status = sg_verify_poll(op, 1);
+    guard_verify_release(op);
+    return status;
+}
+
+sg_result_t sg_verify_file_async(const char* path,
+                                 const uint8_t expected[SG_VERIFY_DIGEST_SIZE],
+                                 sg_verify_op_t** op) {
+    if (path == NULL || expected == NULL || op == NULL) {
+        return SG_ERR_INTERNAL;
+    }
+
+    if (guard_verify_begin(path, expected, op) != 0) {
+        return SG_ERR_INTERNAL;
+    }
+
+    return SG_OK;
+}
+
+sg_verify_status_t sg_verify_poll(sg_verify_op_t* op, int wait) {
+    if (op == NULL) {
+        return SG_VERIFY_ERROR;
+    }
+
+    return (sg_verify_status_t)guard_verify_poll(op, wait);
+}
+
+int sg_verify_fd(const sg_verify_op_t* op) {
+    if (op == NULL) {
+        return -1;
+    }
+
+    return guard_verify_fd(op);
+}
+
+int sg_verify_take_fd(sg_verify_op_t* op) {
+    if (op == NULL) {
+        return -1;
+    }
+
+    return guard_verify_take_fd(op);
+}
+
+void sg_verify_release(sg_verify_op_t* op) {
+    if (op != NULL) {
+        guard_verify_release(op);
+    }
+}
+
 sg_result_t sg_shutdown(void) {
     if (!sg_initialized) {
         return SG_ERR_NOT_INIT;
@@ -108,5 +481,49 @@ sg_result_t sg_shutdown(void) {
         return SG_ERR_INTERNAL;
     }
 
+    return SG_OK;
+}
+
+sg_result_t sg_journal_open(const char* path, uint64_t capacity) {
+    if (path == NULL || capacity == 0) {
+        return SG_ERR_INIT;
+    }
+
+    if (guard_journal_active()) {
+        return SG_ERR_ALREADY_INIT;
+    }
+
+    if (guard_journal_open(path, capacity) != 0) {
+        return SG_ERR_INIT;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_journal_close(void) {
+    if (guard_journal_close() != 0) {
+        return SG_ERR_NOT_INIT;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_attest_attach(const char* socket_path) {
+    if (guard_attest_active()) {
+        return SG_ERR_ALREADY_INIT;
+    }
+
+    if (guard_core_attest_attach(socket_path) != 0) {
+        return SG_ERR_INIT;
+    }
+
+    return SG_OK;
+}
+
+sg_result_t sg_attest_detach(void) {
+    if (guard_attest_detach() != 0) {
+        return SG_ERR_NOT_INIT;
+    }
+
     return SG_OK;
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Single Translation Unit Amalgamation
+ *
+ * Built instead of the individual sources when SG_UNITY_BUILD is on.
+ * With every layer in one TU the compiler can inline the C API into
+ * the guard_core_* shims and the SecurityStateManager methods, and
+ * fold the repeated initialized/null checks along the way.
+ *
+ * Keep this list in sync with COMMON_SOURCES in CMakeLists.txt.
+ * Assembly backends are still assembled separately.
+ */
+
+#include "guard_core.cpp"
+#include "journal.cpp"
+#include "attest.cpp"
+#include "tuning.cpp"
+#include "pagemap.cpp"
+#include "sha256.cpp"
+#include "verity.cpp"
+#include "modules.cpp"
+#include "preload.cpp"
+#include "heal.cpp"
+#include "signatures.cpp"
+#include "threads.cpp"
+#include "watch.cpp"
+#include "wheel.cpp"
+#include "callers.cpp"
+#include "page_hash.cpp"
+#include "asm_dispatch.c"
+#include "self_guard.c"
@@ -0,0 +1,37 @@
+/*
+ * Self-Guard SHA-256
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_SHA256_H
+#define SG_INTERNAL_SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SG_SHA256_DIGEST_SIZE 32
+#define SG_SHA256_BLOCK_SIZE  64
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;                        /* Bytes absorbed so far */
+    uint8_t buffer[SG_SHA256_BLOCK_SIZE];
+    size_t buffered;
+} guard_sha256_t;
+
+void guard_sha256_init(guard_sha256_t* ctx);
+void guard_sha256_update(guard_sha256_t* ctx, const void* data, size_t len);
+void guard_sha256_final(guard_sha256_t* ctx, uint8_t out[SG_SHA256_DIGEST_SIZE]);
+
+/* One-shot digest */
+void guard_sha256(const void* data, size_t len, uint8_t out[SG_SHA256_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_SHA256_H */
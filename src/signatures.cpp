@@ -0,0 +1,485 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Multi-Pattern Signature Scanner
+ *
+ * Responsibilities:
+ * - Load and validate compiled signature sets
+ * - Filter positions with a bucketed shift-or over hashed two-byte
+ *   characters (the FDR variant of Teddy), eight positions per step
+ *   with SSE2 or NEON
+ * - Confirm candidates exactly through a hash of their first bytes
+ * - Carry matcher state across slices so regions scan incrementally
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__) && defined(__x86_64__)
+#include <emmintrin.h>
+#define SG_SIG_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SG_SIG_NEON 1
+#endif
+
+extern "C" {
+    #include "self_guard_signatures.h"
+}
+#include "signatures.h"
+
+namespace {
+
+/*
+ * reach[h] byte k, bit b is clear when some bucket-b signature has the
+ * two-byte character hashing to h at distance k from the end of its
+ * window (its first min(len, 8) bytes). A position ends a window for
+ * bucket b only if bit b is clear at all eight distances, so every
+ * byte of the window has to agree before anything is verified.
+ */
+constexpr unsigned SIG_DOMAIN_BITS = 12;   /* 32 KiB table: stays in L1 */
+constexpr size_t SIG_DOMAIN = size_t(1) << SIG_DOMAIN_BITS;
+constexpr unsigned SIG_BUCKETS = 8;
+constexpr unsigned SIG_WINDOW = 8;
+constexpr size_t SIG_MAX_FILE = 64u << 20;
+
+inline uint32_t sig_char(uint8_t prev, uint8_t cur) {
+    return ((static_cast<uint32_t>(prev) << 4) ^ cur) & (SIG_DOMAIN - 1);
+}
+
+struct Signature {
+    uint32_t id;
+    uint32_t offset;       /* Into SignatureSet::bytes */
+    uint32_t next;         /* Chain in the verification table, UINT32_MAX ends */
+    uint8_t len;
+    uint8_t bucket;
+    uint64_t key;          /* Window bytes, little-endian, zero-extended */
+};
+
+struct SignatureSet {
+    uint64_t generation;
+    std::vector<uint64_t> reach;
+    uint8_t window[SIG_BUCKETS];    /* Window length of each bucket */
+    uint64_t initial_state;         /* No window may start before the region */
+    std::vector<uint8_t> bytes;
+    std::vector<Signature> sigs;
+    std::vector<uint32_t> heads;    /* (bucket, key) hash -> first signature */
+};
+
+std::mutex g_sig_mutex;
+std::unique_ptr<SignatureSet> g_sigset;
+std::atomic<uint64_t> g_sig_generation(0);
+
+inline uint64_t window_key(const uint8_t* p, size_t w) {
+    uint64_t key = 0;
+    std::memcpy(&key, p, w);   /* Host order; keys never leave the process */
+    return key;
+}
+
+inline size_t verify_slot(uint64_t key, unsigned bucket, size_t mask) {
+    return static_cast<size_t>(((key ^ bucket) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+/* ============================================
+ * Set Construction
+ * ============================================ */
+
+/*
+ * Buckets are split by window length, so a candidate knows where its
+ * signatures start; the most populated lengths get extra buckets.
+ */
+void assign_buckets(SignatureSet& set) {
+    size_t count[SIG_WINDOW + 1] = {0};
+    for (const Signature& sig : set.sigs) {
+        ++count[sig.len < SIG_WINDOW ? sig.len : SIG_WINDOW];
+    }
+
+    unsigned alloc[SIG_WINDOW + 1] = {0};
+    unsigned used = 0;
+    for (unsigned w = SG_SIG_MIN_LEN; w <= SIG_WINDOW; ++w) {
+        if (count[w] != 0) {
+            alloc[w] = 1;
+            ++used;
+        }
+    }
+    for (; used < SIG_BUCKETS; ++used) {
+        unsigned best = 0;
+        for (unsigned w = SG_SIG_MIN_LEN; w <= SIG_WINDOW; ++w) {
+            if (alloc[w] != 0 && (best == 0 || count[w] * alloc[best] > count[best] * alloc[w])) {
+                best = w;
+            }
+        }
+        if (best == 0) {
+            break;
+        }
+        ++alloc[best];
+    }
+
+    unsigned first[SIG_WINDOW + 1] = {0};
+    unsigned next = 0;
+    std::memset(set.window, 0, sizeof(set.window));
+    for (unsigned w = SG_SIG_MIN_LEN; w <= SIG_WINDOW; ++w) {
+        first[w] = next;
+        for (unsigned b = 0; b < alloc[w]; ++b) {
+            set.window[next++] = static_cast<uint8_t>(w);
+        }
+    }
+
+    for (Signature& sig : set.sigs) {
+        const unsigned w = sig.len < SIG_WINDOW ? sig.len : SIG_WINDOW;
+        sig.bucket = static_cast<uint8_t>(first[w] + (sig.key * 0x9E3779B97F4A7C15ULL >> 61) % alloc[w]);
+    }
+}
+
+void build_reach(SignatureSet& set) {
+    set.reach.assign(SIG_DOMAIN, ~uint64_t(0));
+
+    /*
+     * Before the first byte, state byte k stands for distance k from
+     * the byte before the region: a bucket-b window ending k - 1 bytes
+     * in would start outside it if k < window[b].
+     */
+    set.initial_state = 0;
+    for (unsigned b = 0; b < SIG_BUCKETS; ++b) {
+        for (unsigned k = 0; k < set.window[b]; ++k) {
+            set.initial_state |= uint64_t(1) << (8 * k + b);
+        }
+    }
+
+    /* Distances before a bucket's window start match anything */
+    for (unsigned b = 0; b < SIG_BUCKETS; ++b) {
+        if (set.window[b] == 0) {
+            continue;
+        }
+        for (unsigned k = set.window[b]; k < SIG_WINDOW; ++k) {
+            const uint64_t clear = ~(uint64_t(1) << (8 * k + b));
+            for (uint64_t& entry : set.reach) {
+                entry &= clear;
+            }
+        }
+    }
+
+    for (const Signature& sig : set.sigs) {
+        const uint8_t* p = set.bytes.data() + sig.offset;
+        const unsigned w = set.window[sig.bucket];
+        for (unsigned k = 0; k + 1 < w; ++k) {
+            const unsigned at = w - 1 - k;
+            set.reach[sig_char(p[at - 1], p[at])] &= ~(uint64_t(1) << (8 * k + sig.bucket));
+        }
+        /* The first byte may follow anything */
+        const uint64_t clear = ~(uint64_t(1) << (8 * (w - 1) + sig.bucket));
+        for (unsigned prev = 0; prev < 256; ++prev) {
+            set.reach[sig_char(static_cast<uint8_t>(prev), p[0])] &= clear;
+        }
+    }
+}
+
+bool build_verify_table(SignatureSet& set) {
+    size_t size = 16;
+    while (size < set.sigs.size() * 2) {
+        size <<= 1;
+    }
+    set.heads.assign(size, UINT32_MAX);
+    for (size_t i = set.sigs.size(); i-- > 0; ) {
+        Signature& sig = set.sigs[i];
+        const size_t slot = verify_slot(sig.key, sig.bucket, size - 1);
+        sig.next = set.heads[slot];
+        set.heads[slot] = static_cast<uint32_t>(i);
+    }
+    return true;
+}
+
+/* Parse and check a whole file image; false if anything is off */
+bool parse_sigset(const uint8_t* data, size_t size, SignatureSet& set) {
+    sg_sigset_header_t header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != SG_SIGSET_MAGIC || header.version != SG_SIGSET_VERSION ||
+        header.count == 0 || header.count > SG_SIG_MAX_COUNT ||
+        header.payload_size != size - sizeof(header)) {
+        return false;
+    }
+
+    const uint8_t* payload = data + sizeof(header);
+    uint64_t hash = SG_SIGSET_FNV_OFFSET;
+    for (size_t i = 0; i < header.payload_size; ++i) {
+        hash ^= payload[i];
+        hash *= SG_SIGSET_FNV_PRIME;
+    }
+    if (hash != header.checksum) {
+        return false;
+    }
+
+    set.sigs.reserve(header.count);
+    set.bytes.reserve(header.payload_size);
+    size_t pos = 0;
+    for (uint32_t i = 0; i < header.count; ++i) {
+        if (header.payload_size - pos < 5) {
+            return false;
+        }
+        Signature sig;
+        sig.id = static_cast<uint32_t>(payload[pos]) | (static_cast<uint32_t>(payload[pos + 1]) << 8) |
+                 (static_cast<uint32_t>(payload[pos + 2]) << 16) |
+                 (static_cast<uint32_t>(payload[pos + 3]) << 24);
+        sig.len = payload[pos + 4];
+        pos += 5;
+        if (sig.len < SG_SIG_MIN_LEN || header.payload_size - pos < sig.len) {
+            return false;
+        }
+        sig.offset = static_cast<uint32_t>(set.bytes.size());
+        sig.next = UINT32_MAX;
+        sig.bucket = 0;
+        sig.key = window_key(payload + pos, sig.len < SIG_WINDOW ? sig.len : SIG_WINDOW);
+        set.bytes.insert(set.bytes.end(), payload + pos, payload + pos + sig.len);
+        set.sigs.push_back(sig);
+        pos += sig.len;
+    }
+    if (pos != header.payload_size) {
+        return false;
+    }
+
+    assign_buckets(set);
+    build_reach(set);
+    return build_verify_table(set);
+}
+
+/* ============================================
+ * Scanning
+ * ============================================ */
+
+/*
+ * Shift-or over eight positions at once. With s the state before the
+ * block and r_j the reach of position j, the state after position j
+ * is (s >> 8(j + 1)) | OR_{t <= j} (r_t >> 8(j - t)). Placing r_t at
+ * byte t of a 128-bit accumulator lines up byte 0 of every per-position
+ * state in bytes 0..7, and the state after the block in bytes 7..14.
+ * Returns the candidate bytes (bit b of byte j: bucket b at position j).
+ */
+#if defined(SG_SIG_SSE2)
+typedef __m128i block_state_t;
+
+inline block_state_t to_block_state(uint64_t state) {
+    return _mm_cvtsi64_si128(static_cast<long long>(state));
+}
+
+inline uint64_t from_block_state(block_state_t state) {
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(state));
+}
+
+inline __m128i reach_at(const uint64_t* reach, uint32_t idx) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(reach + idx));
+}
+
+/*
+ * The state stays in a vector register between blocks, and the reach
+ * terms are combined as a tree before it joins: the loop-carried chain
+ * is one shift and one OR per eight positions.
+ */
+inline uint64_t shift_or_block(const uint64_t* reach, const uint32_t* idx, __m128i& state) {
+    const __m128i r01 = _mm_or_si128(reach_at(reach, idx[0]), _mm_slli_si128(reach_at(reach, idx[1]), 1));
+    const __m128i r23 = _mm_or_si128(_mm_slli_si128(reach_at(reach, idx[2]), 2),
+                                     _mm_slli_si128(reach_at(reach, idx[3]), 3));
+    const __m128i r45 = _mm_or_si128(_mm_slli_si128(reach_at(reach, idx[4]), 4),
+                                     _mm_slli_si128(reach_at(reach, idx[5]), 5));
+    const __m128i r67 = _mm_or_si128(_mm_slli_si128(reach_at(reach, idx[6]), 6),
+                                     _mm_slli_si128(reach_at(reach, idx[7]), 7));
+    const __m128i block = _mm_or_si128(_mm_or_si128(r01, r23), _mm_or_si128(r45, r67));
+    const __m128i acc = _mm_or_si128(block, _mm_srli_si128(state, 1));
+    state = _mm_move_epi64(_mm_srli_si128(acc, 7));
+    return ~static_cast<uint64_t>(_mm_cvtsi128_si64(acc));
+}
+#else
+typedef uint64_t block_state_t;
+
+inline block_state_t to_block_state(uint64_t state) { return state; }
+inline uint64_t from_block_state(block_state_t state) { return state; }
+
+inline uint64_t shift_or_block(const uint64_t* reach, const uint32_t* idx, uint64_t& state) {
+#if defined(SG_SIG_NEON)
+    const uint8x16_t zero = vdupq_n_u8(0);
+    uint8x16_t acc = vextq_u8(vcombine_u8(vcreate_u8(state), vdup_n_u8(0)), zero, 1);
+    acc = vorrq_u8(acc, vcombine_u8(vcreate_u8(reach[idx[0]]), vdup_n_u8(0)));
+    acc = vorrq_u8(acc, vextq_u8(zero, vcombine_u8(vcreate_u8(reach[idx[1]]), vdup_n_u8(0)), 15));
+    acc = vorrq_u8(acc, vextq_u8(zero, vcombine_u8(vcreate_u8(reach[idx[2]]), vdup_n_u8(0)), 14));
+    acc = vorrq_u8(acc, vextq_u8(zero, vcombine_u8(vcreate_u8(reach[idx[3]]), vdup_n_u8(0)), 13));
+    acc = vorrq_u8(acc, vextq_u8(zero, vcombine_u8(vcreate_u8(reach[idx[4]]), vdup_n_u8(0)), 12));
+    acc = vorrq_u8(acc, vextq_u8(zero, vcombine_u8(vcreate_u8(reach[idx[5]]), vdup_n_u8(0)), 11));
+    acc = vorrq_u8(acc, vextq_u8(zero, vcombine_u8(vcreate_u8(reach[idx[6]]), vdup_n_u8(0)), 10));
+    acc = vorrq_u8(acc, vextq_u8(zero, vcombine_u8(vcreate_u8(reach[idx[7]]), vdup_n_u8(0)), 9));
+    state = vgetq_lane_u64(vreinterpretq_u64_u8(vextq_u8(acc, zero, 7)), 0);
+    return ~vgetq_lane_u64(vreinterpretq_u64_u8(acc), 0);
+#else
+    uint64_t lo = (state >> 8) | reach[idx[0]];
+    uint64_t hi = 0;
+    for (unsigned t = 1; t < 8; ++t) {
+        lo |= reach[idx[t]] << (8 * t);
+        hi |= reach[idx[t]] >> (64 - 8 * t);
+    }
+    state = (lo >> 56) | (hi << 8);
+    return ~lo;
+#endif
+}
+#endif
+
+/* Exact check of bucket `bucket` windows ending at region[end] */
+bool verify_candidate(const SignatureSet& set, const uint8_t* region, size_t region_len,
+                      size_t end, unsigned bucket, guard_sig_match_t* match) {
+    const size_t w = set.window[bucket];
+    if (end + 1 < w) {
+        return false;
+    }
+    const size_t start = end + 1 - w;
+    const uint64_t key = window_key(region + start, w);
+    for (uint32_t i = set.heads[verify_slot(key, bucket, set.heads.size() - 1)];
+         i != UINT32_MAX; i = set.sigs[i].next) {
+        const Signature& sig = set.sigs[i];
+        if (sig.bucket != bucket || sig.key != key || region_len - start < sig.len ||
+            std::memcmp(region + start, set.bytes.data() + sig.offset, sig.len) != 0) {
+            continue;
+        }
+        match->addr = reinterpret_cast<uintptr_t>(region + start);
+        match->id = sig.id;
+        match->len = sig.len;
+        return true;
+    }
+    return false;
+}
+
+/* Resolve every candidate bit of one block; true on the first match */
+bool verify_block(const SignatureSet& set, const uint8_t* region, size_t region_len,
+                  size_t base, uint64_t candidates, guard_sig_match_t* match) {
+    while (candidates != 0) {
+        const unsigned bit = static_cast<unsigned>(__builtin_ctzll(candidates));
+        candidates &= candidates - 1;
+        if (verify_candidate(set, region, region_len, base + bit / 8, bit % 8, match)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_signatures_load(const char* path) {
+    if (path == nullptr) {
+        std::lock_guard<std::mutex> lock(g_sig_mutex);
+        g_sigset.reset();
+        g_sig_generation.store(0, std::memory_order_release);
+        return 0;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        static_cast<uint64_t>(st.st_size) > SIG_MAX_FILE) {
+        close(fd);
+        return -1;
+    }
+
+    std::unique_ptr<SignatureSet> set(new (std::nothrow) SignatureSet());
+    std::vector<uint8_t> image;
+    try {
+        image.resize(static_cast<size_t>(st.st_size));
+    } catch (const std::bad_alloc&) {
+        close(fd);
+        return -1;
+    }
+    size_t got = 0;
+    while (got < image.size()) {
+        ssize_t n = read(fd, image.data() + got, image.size() - got);
+        if (n <= 0) {
+            break;
+        }
+        got += static_cast<size_t>(n);
+    }
+    close(fd);
+    if (set == nullptr || got != image.size()) {
+        return -1;
+    }
+
+    try {
+        if (!parse_sigset(image.data(), image.size(), *set)) {
+            return -1;
+        }
+    } catch (const std::bad_alloc&) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(g_sig_mutex);
+    static uint64_t next_generation = 0;
+    set->generation = ++next_generation;
+    g_sigset = std::move(set);
+    g_sig_generation.store(g_sigset->generation, std::memory_order_release);
+    return 0;
+}
+
+uint64_t guard_signatures_generation(void) {
+    return g_sig_generation.load(std::memory_order_acquire);
+}
+
+int guard_signatures_scan(guard_sig_stream_t* stream, const uint8_t* region, size_t region_len,
+                          size_t offset, size_t len, guard_sig_match_t* match) {
+    std::lock_guard<std::mutex> lock(g_sig_mutex);
+    const SignatureSet* set = g_sigset.get();
+    if (set == nullptr) {
+        return -1;
+    }
+    if (offset == 0) {
+        stream->generation = set->generation;
+        stream->state = set->initial_state;
+    } else if (stream->generation != set->generation) {
+        return -1;
+    }
+
+    const uint64_t* reach = set->reach.data();
+    const size_t end = offset + len;
+    uint64_t state = stream->state;
+    uint8_t prev = offset != 0 ? region[offset - 1] : 0;
+    size_t i = offset;
+
+    uint32_t idx[8];
+    block_state_t block_state = to_block_state(state);
+    for (; i + 8 <= end; i += 8) {
+        const uint8_t* p = region + i;
+        idx[0] = sig_char(prev, p[0]);
+        for (unsigned j = 1; j < 8; ++j) {
+            idx[j] = sig_char(p[j - 1], p[j]);
+        }
+        prev = p[7];
+        const uint64_t candidates = shift_or_block(reach, idx, block_state);
+        if (candidates != 0 && verify_block(*set, region, region_len, i, candidates, match)) {
+            stream->state = from_block_state(block_state);
+            return 1;
+        }
+    }
+    state = from_block_state(block_state);
+    for (; i < end; ++i) {
+        state = (state >> 8) | reach[sig_char(prev, region[i])];
+        prev = region[i];
+        const uint64_t candidates = ~state & 0xFF;
+        if (candidates != 0 && verify_block(*set, region, region_len, i, candidates, match)) {
+            stream->state = state;
+            return 1;
+        }
+    }
+    stream->state = state;
+    return 0;
+}
+
+} /* extern "C" */
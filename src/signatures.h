@@ -0,0 +1,48 @@
+/*
+ * Self-Guard Signature Scanner
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_SIGNATURES_H
+#define SG_INTERNAL_SIGNATURES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Matcher state carried from one slice of a region to the next */
+typedef struct {
+    uint64_t generation;    /* Signature set the scan started with */
+    uint64_t state;         /* Shift-or state after the last scanned byte */
+} guard_sig_stream_t;
+
+typedef struct {
+    uintptr_t addr;
+    uint32_t id;
+    uint32_t len;
+} guard_sig_match_t;
+
+/* Compile a signature set file (self_guard_signatures.h); NULL unloads */
+int guard_signatures_load(const char* path);
+
+/* Non-zero while a set is loaded; changes with every load */
+uint64_t guard_signatures_generation(void);
+
+/*
+ * Scan region bytes [offset, offset + len) for signature occurrences
+ * starting at or after region and ending before region + region_len.
+ * offset 0 starts a new stream; later offsets continue it. Returns 1
+ * with the first match, 0 if none, -1 if no set is loaded or the set
+ * changed since the stream started.
+ */
+int guard_signatures_scan(guard_sig_stream_t* stream, const uint8_t* region, size_t region_len,
+                          size_t offset, size_t len, guard_sig_match_t* match);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_SIGNATURES_H */
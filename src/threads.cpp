@@ -0,0 +1,161 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Thread Enumeration
+ *
+ * Responsibilities:
+ * - Count the process's threads with one small read
+ * - List them with getdents64 instead of a readdir per entry
+ * - Report where a thread is stopped
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include "threads.h"
+
+namespace {
+
+#if defined(__linux__)
+/* Layout returned by getdents64 (no glibc wrapper before 2.30) */
+struct TaskDirent {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+ssize_t read_small(const char* path, char* buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, size - 1);
+    const int saved = errno;   /* Callers tell a gone task from a failure */
+    close(fd);
+    errno = saved;
+    if (n >= 0) {
+        buf[n] = '\0';
+    }
+    return n;
+}
+#endif
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_thread_self(void) {
+#if defined(__linux__)
+    return static_cast<int>(syscall(SYS_gettid));
+#else
+    return -1;
+#endif
+}
+
+long guard_thread_count(void) {
+#if defined(__linux__)
+    char buf[1024];
+    if (read_small("/proc/self/stat", buf, sizeof(buf)) <= 0) {
+        return -1;
+    }
+    /* comm may contain spaces and parentheses; fields resume after the last ')' */
+    const char* p = strrchr(buf, ')');
+    if (p == nullptr) {
+        return -1;
+    }
+    for (int field = 2; field < 20; ++field) {
+        p = strchr(p + 1, ' ');
+        if (p == nullptr) {
+            return -1;
+        }
+    }
+    return strtol(p + 1, nullptr, 10);
+#else
+    return -1;
+#endif
+}
+
+size_t guard_thread_list(int* out, size_t max) {
+    size_t count = 0;
+#if defined(__linux__)
+    int fd = open("/proc/self/task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    alignas(8) char buf[16384];
+    for (;;) {
+        long n = syscall(SYS_getdents64, fd, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        for (long pos = 0; pos < n; ) {
+            const TaskDirent* d = reinterpret_cast<const TaskDirent*>(buf + pos);
+            pos += d->d_reclen;
+            if (d->d_name[0] < '0' || d->d_name[0] > '9') {
+                continue;
+            }
+            if (count < max) {
+                out[count] = atoi(d->d_name);
+            }
+            ++count;
+        }
+    }
+    close(fd);
+    std::sort(out, out + (count < max ? count : max));
+#else
+    (void)out;
+    (void)max;
+#endif
+    return count;
+}
+
+int guard_thread_context(int tid, uintptr_t* sp, uintptr_t* pc) {
+#if defined(__linux__)
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/syscall", tid);
+    char buf[256];
+    const ssize_t n = read_small(path, buf, sizeof(buf));
+    if (n < 0) {
+        return errno == ENOENT || errno == ESRCH ? -1 : -2;
+    }
+    if (n == 0) {
+        return -2;
+    }
+    if (strncmp(buf, "running", 7) == 0) {
+        return 1;
+    }
+    /* "nr arg0 .. arg5 sp pc", or "-1 sp pc" between system calls */
+    const char* fields[9];
+    int count = 0;
+    char* save = nullptr;
+    for (char* tok = strtok_r(buf, " \n", &save); tok != nullptr && count < 9;
+         tok = strtok_r(nullptr, " \n", &save)) {
+        fields[count++] = tok;
+    }
+    if (count != 3 && count != 9) {
+        return -2;
+    }
+    *sp = static_cast<uintptr_t>(strtoull(fields[count - 2], nullptr, 16));
+    *pc = static_cast<uintptr_t>(strtoull(fields[count - 1], nullptr, 16));
+    return 0;
+#else
+    (void)tid;
+    (void)sp;
+    (void)pc;
+    return -2;
+#endif
+}
+
+} /* extern "C" */
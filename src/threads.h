@@ -0,0 +1,41 @@
+/*
+ * Self-Guard Thread Enumeration
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_THREADS_H
+#define SG_INTERNAL_THREADS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Caller's kernel thread id, or -1 where there is none */
+int guard_thread_self(void);
+
+/* Field 20 (num_threads) of /proc/self/stat, or -1 */
+long guard_thread_count(void);
+
+/*
+ * TIDs in /proc/self/task, ascending, read with getdents64 into one
+ * buffer. Returns the number found, which may exceed max (only max
+ * are stored), or 0 if the directory cannot be read.
+ */
+size_t guard_thread_list(int* out, size_t max);
+
+/*
+ * Stack and instruction pointer of a thread stopped in (or between)
+ * system calls, from /proc/self/task/<tid>/syscall. Returns 0 on
+ * success, 1 if the thread is running on a CPU right now, -1 if it
+ * has exited, -2 if the file cannot be read or parsed.
+ */
+int guard_thread_context(int tid, uintptr_t* sp, uintptr_t* pc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_THREADS_H */
@@ -0,0 +1,438 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Checksum Kernel Registry and Autotuner
+ *
+ * Responsibilities:
+ * - Register every checksum kernel built into this library
+ * - Admit only kernels whose digests match the reference exactly
+ * - Benchmark admitted kernels on this host and pick the fastest
+ * - Size sg_require_fresh slices to a latency budget
+ * - Persist and reload the choice, keyed by CPU model and kernel set
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <atomic>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+extern "C" {
+    #include "self_guard.h"
+    #include "self_guard_asm.h"
+}
+#include "tuning.h"
+#include "checksum_words.h"
+
+/* Implemented in guard_core.cpp */
+extern "C" int guard_core_set_option(uint32_t option, uint64_t value);
+
+namespace {
+
+/* ============================================
+ * Kernel Registry
+ * ============================================ */
+
+struct ChecksumKernel {
+    const char* name;
+    sg_checksum_fn fn;
+};
+
+/* Plain C rotate-XOR, unrolled; the reference every kernel must match */
+uint32_t checksum_c_unrolled(const void* start, size_t length) {
+    const uint8_t* data = static_cast<const uint8_t*>(start);
+    uint32_t checksum = 0;
+
+    if (start == nullptr || length == 0) {
+        return 0;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        checksum = ((checksum << 1) | (checksum >> 31)) ^ data[i];
+        checksum = ((checksum << 1) | (checksum >> 31)) ^ data[i + 1];
+        checksum = ((checksum << 1) | (checksum >> 31)) ^ data[i + 2];
+        checksum = ((checksum << 1) | (checksum >> 31)) ^ data[i + 3];
+    }
+    for (; i < length; ++i) {
+        checksum = ((checksum << 1) | (checksum >> 31)) ^ data[i];
+    }
+    return checksum;
+}
+
+const ChecksumKernel g_kernels[] = {
+    { "native",     sg_checksum_memory },
+    { "c-unrolled", checksum_c_unrolled },
+    { "c-words",    sg_checksum_words },
+};
+
+constexpr size_t KERNEL_COUNT = sizeof(g_kernels) / sizeof(g_kernels[0]);
+static_assert(KERNEL_COUNT <= SG_TUNING_MAX_KERNELS, "raise SG_TUNING_MAX_KERNELS");
+
+std::atomic<sg_checksum_fn> g_active_kernel(sg_checksum_memory);
+
+/* Last applied tuning, reported by sg_get_tuning */
+std::mutex g_tuning_mutex;
+sg_tuning_info_t g_tuning_info;
+bool g_tuning_info_valid = false;
+
+const ChecksumKernel* find_kernel(const char* name) {
+    for (size_t i = 0; i < KERNEL_COUNT; ++i) {
+        if (std::strncmp(g_kernels[i].name, name, SG_TUNING_NAME_MAX) == 0) {
+            return &g_kernels[i];
+        }
+    }
+    return nullptr;
+}
+
+/* ============================================
+ * Host and Build Identity
+ * ============================================ */
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+
+/* CPU model fingerprint: vendor, family/model/stepping and brand string */
+uint64_t cpu_signature() {
+    uint64_t hash = FNV_OFFSET;
+
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int regs[4];
+    if (__get_cpuid(0, &regs[0], &regs[1], &regs[2], &regs[3])) {
+        hash = fnv1a(hash, &regs[1], sizeof(unsigned int) * 3);
+    }
+    if (__get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3])) {
+        hash = fnv1a(hash, &regs[0], sizeof(unsigned int));
+    }
+    for (unsigned int leaf = 0x80000002u; leaf <= 0x80000004u; ++leaf) {
+        if (__get_cpuid(leaf, &regs[0], &regs[1], &regs[2], &regs[3])) {
+            hash = fnv1a(hash, regs, sizeof(regs));
+        }
+    }
+#elif defined(__linux__)
+    /* MIDR_EL1 (arm64) or equivalent exported by the kernel */
+    int fd = open("/sys/devices/system/cpu/cpu0/regs/identification/midr_el1",
+                  O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        char buf[64];
+        ssize_t n = read(fd, buf, sizeof(buf));
+        close(fd);
+        if (n > 0) {
+            hash = fnv1a(hash, buf, static_cast<size_t>(n));
+        }
+    }
+#endif
+
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        hash = fnv1a(hash, uts.machine, std::strlen(uts.machine));
+    }
+    return hash;
+}
+
+/* Identifies the kernel set; a file tuned against another set is stale */
+uint64_t kernel_set_signature() {
+    uint64_t hash = fnv1a(FNV_OFFSET, sg_get_implementation(),
+                          std::strlen(sg_get_implementation()));
+    for (size_t i = 0; i < KERNEL_COUNT; ++i) {
+        hash = fnv1a(hash, g_kernels[i].name, std::strlen(g_kernels[i].name) + 1);
+    }
+    return hash;
+}
+
+/* ============================================
+ * Tuning File
+ * ============================================ */
+
+constexpr uint32_t TUNING_MAGIC = 0x4E555447u;   /* "GTUN" */
+constexpr uint32_t TUNING_VERSION = 1;
+
+struct TuningFile {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t cpu_signature;
+    uint64_t kernel_set;
+    char kernel[SG_TUNING_NAME_MAX];
+    uint64_t slice_pages;
+    uint64_t ns_per_kib;
+    uint64_t tuned_realtime_ns;
+    uint64_t checksum;      /* FNV-1a over everything above */
+};
+
+uint64_t tuning_file_checksum(const TuningFile& file) {
+    return fnv1a(FNV_OFFSET, &file, offsetof(TuningFile, checksum));
+}
+
+/* Only trust a file nobody else could have planted, as for the baseline cache */
+bool tuning_owner_ok(const struct stat& st) {
+    return (st.st_uid == 0 || st.st_uid == geteuid()) && !(st.st_mode & (S_IWGRP | S_IWOTH));
+}
+
+bool write_tuning_file(const char* path, const TuningFile& file) {
+    /* Write a sibling and rename, so readers never see a partial file */
+    char tmp[4096];
+    int len = snprintf(tmp, sizeof(tmp), "%s.tmp.%ld", path, static_cast<long>(getpid()));
+    if (len < 0 || static_cast<size_t>(len) >= sizeof(tmp)) {
+        return false;
+    }
+
+    /* A leftover from a crashed run with our pid would fail O_EXCL */
+    unlink(tmp);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, &file, sizeof(file)) == static_cast<ssize_t>(sizeof(file)) &&
+              fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return false;
+    }
+    return true;
+}
+
+/* ============================================
+ * Benchmarking
+ * ============================================ */
+
+/* Buffer larger than typical L2, hashed in page-sized calls like the core */
+constexpr size_t BENCH_BUFFER_SIZE = 4u << 20;
+constexpr size_t BENCH_PAGE = 4096;
+constexpr int BENCH_ROUNDS = 5;
+
+/* Target wall time for one sg_require_fresh slice */
+constexpr uint64_t SLICE_BUDGET_NS = 100000;
+constexpr uint64_t SLICE_PAGES_MAX = 4096;
+
+uint64_t tune_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/* Exact digest agreement over awkward lengths and alignments */
+bool kernel_matches_reference(sg_checksum_fn fn, const uint8_t* buf) {
+    static const size_t lengths[] = {
+        1, 2, 3, 7, 8, 15, 16, 31, 32, 33, 63, 64, 65, 127, 255, 256,
+        1000, 4095, 4096, 4097, 8191, 65536 + 13
+    };
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t len : lengths) {
+            if (fn(buf + offset, len) != checksum_c_unrolled(buf + offset, len)) {
+                return false;
+            }
+        }
+    }
+    return fn(buf, 0) == 0;
+}
+
+/* Best-of-N nanoseconds to hash the whole buffer page by page */
+uint64_t time_kernel(sg_checksum_fn fn, const uint8_t* buf) {
+    volatile uint32_t sink = 0;
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        uint64_t start = tune_now_ns();
+        for (size_t off = 0; off < BENCH_BUFFER_SIZE; off += BENCH_PAGE) {
+            sink = sink ^ fn(buf + off, BENCH_PAGE);
+        }
+        uint64_t elapsed = tune_now_ns() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    (void)sink;
+    return best;
+}
+
+void apply(const ChecksumKernel& kernel, uint64_t slice_pages, uint64_t ns_per_kib,
+           uint32_t source) {
+    g_active_kernel.store(kernel.fn, std::memory_order_release);
+    guard_core_set_option(SG_OPT_SLICE_PAGES, slice_pages);
+
+    std::lock_guard<std::mutex> lock(g_tuning_mutex);
+    std::memset(&g_tuning_info, 0, sizeof(g_tuning_info));
+    std::strncpy(g_tuning_info.kernel, kernel.name, SG_TUNING_NAME_MAX - 1);
+    g_tuning_info.slice_pages = slice_pages;
+    g_tuning_info.ns_per_kib = ns_per_kib;
+    g_tuning_info.source = source;
+    g_tuning_info_valid = true;
+}
+
+} /* anonymous namespace */
+
+extern "C" {
+
+sg_checksum_fn guard_tuning_kernel(void) {
+    return g_active_kernel.load(std::memory_order_acquire);
+}
+
+const char* guard_tuning_kernel_name(void) {
+    const sg_checksum_fn fn = g_active_kernel.load(std::memory_order_acquire);
+    for (size_t i = 0; i < KERNEL_COUNT; ++i) {
+        if (g_kernels[i].fn == fn) {
+            return g_kernels[i].name;
+        }
+    }
+    return g_kernels[0].name;
+}
+
+int guard_tuning_load(const char* path) {
+    if (path == nullptr) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || !tuning_owner_ok(st)) {
+        close(fd);
+        return -1;
+    }
+    TuningFile file;
+    ssize_t n = read(fd, &file, sizeof(file));
+    close(fd);
+
+    if (n != static_cast<ssize_t>(sizeof(file)) ||
+        file.magic != TUNING_MAGIC ||
+        file.version != TUNING_VERSION ||
+        file.checksum != tuning_file_checksum(file)) {
+        return -1;
+    }
+
+    /* Tuned on another CPU model or against another kernel set: keep defaults */
+    if (file.cpu_signature != cpu_signature() || file.kernel_set != kernel_set_signature()) {
+        return -1;
+    }
+
+    file.kernel[SG_TUNING_NAME_MAX - 1] = '\0';
+    const ChecksumKernel* kernel = find_kernel(file.kernel);
+    if (kernel == nullptr || file.slice_pages == 0 || file.slice_pages > SLICE_PAGES_MAX) {
+        return -1;
+    }
+
+    apply(*kernel, file.slice_pages, file.ns_per_kib, SG_TUNING_FROM_FILE);
+    return 0;
+}
+
+int guard_autotune(const char* path, sg_tuning_info_t* out) {
+    uint8_t* buf = new(std::nothrow) uint8_t[BENCH_BUFFER_SIZE];
+    if (buf == nullptr) {
+        return -1;
+    }
+
+    /* Deterministic, non-trivial contents */
+    uint32_t x = 0x9E3779B9u;
+    for (size_t i = 0; i < BENCH_BUFFER_SIZE; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = static_cast<uint8_t>(x);
+    }
+
+    sg_tuning_info_t info;
+    std::memset(&info, 0, sizeof(info));
+
+    const ChecksumKernel* best = nullptr;
+    uint64_t best_ns = UINT64_MAX;
+    for (size_t i = 0; i < KERNEL_COUNT; ++i) {
+        sg_tuning_candidate_t& cand = info.candidates[info.candidate_count++];
+        std::strncpy(cand.name, g_kernels[i].name, SG_TUNING_NAME_MAX - 1);
+        cand.matches_reference = kernel_matches_reference(g_kernels[i].fn, buf) ? 1 : 0;
+        if (!cand.matches_reference) {
+            continue;
+        }
+        uint64_t ns = time_kernel(g_kernels[i].fn, buf);
+        cand.ns_per_kib = ns / (BENCH_BUFFER_SIZE / 1024);
+        if (ns < best_ns) {
+            best_ns = ns;
+            best = &g_kernels[i];
+        }
+    }
+    delete[] buf;
+
+    if (best == nullptr) {
+        if (out != nullptr) {
+            *out = info;
+        }
+        return -1;
+    }
+
+    /* As many pages per slice as fit the latency budget */
+    uint64_t ns_per_page = best_ns / (BENCH_BUFFER_SIZE / BENCH_PAGE);
+    uint64_t slice_pages = ns_per_page != 0 ? SLICE_BUDGET_NS / ns_per_page : SLICE_PAGES_MAX;
+    if (slice_pages == 0) {
+        slice_pages = 1;
+    } else if (slice_pages > SLICE_PAGES_MAX) {
+        slice_pages = SLICE_PAGES_MAX;
+    }
+    uint64_t ns_per_kib = best_ns / (BENCH_BUFFER_SIZE / 1024);
+
+    apply(*best, slice_pages, ns_per_kib, SG_TUNING_FROM_AUTOTUNE);
+
+    int result = 0;
+    if (path != nullptr) {
+        TuningFile file;
+        std::memset(&file, 0, sizeof(file));
+        file.magic = TUNING_MAGIC;
+        file.version = TUNING_VERSION;
+        file.cpu_signature = cpu_signature();
+        file.kernel_set = kernel_set_signature();
+        std::strncpy(file.kernel, best->name, SG_TUNING_NAME_MAX - 1);
+        file.slice_pages = slice_pages;
+        file.ns_per_kib = ns_per_kib;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        file.tuned_realtime_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+                                 static_cast<uint64_t>(ts.tv_nsec);
+        file.checksum = tuning_file_checksum(file);
+        if (!write_tuning_file(path, file)) {
+            result = -1;
+        }
+    }
+
+    if (out != nullptr) {
+        std::strncpy(info.kernel, best->name, SG_TUNING_NAME_MAX - 1);
+        info.slice_pages = slice_pages;
+        info.ns_per_kib = ns_per_kib;
+        info.source = SG_TUNING_FROM_AUTOTUNE;
+        *out = info;
+    }
+    return result;
+}
+
+int guard_tuning_info(sg_tuning_info_t* out) {
+    std::lock_guard<std::mutex> lock(g_tuning_mutex);
+    if (g_tuning_info_valid) {
+        *out = g_tuning_info;
+        return 0;
+    }
+
+    std::memset(out, 0, sizeof(*out));
+    std::strncpy(out->kernel, g_kernels[0].name, SG_TUNING_NAME_MAX - 1);
+    out->slice_pages = 0;
+    out->source = SG_TUNING_DEFAULT;
+    return 0;
+}
+
+} /* extern "C" */
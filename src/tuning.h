@@ -0,0 +1,40 @@
+/*
+ * Self-Guard Kernel Selection and Autotuning
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_TUNING_H
+#define SG_INTERNAL_TUNING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "self_guard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Same contract as sg_checksum_memory */
+typedef uint32_t (*sg_checksum_fn)(const void* start, size_t length);
+
+/* Checksum kernel selected for this host (defaults to sg_checksum_memory) */
+sg_checksum_fn guard_tuning_kernel(void);
+
+/* Registry name of that kernel ("native", "c-unrolled", "c-words") */
+const char* guard_tuning_kernel_name(void);
+
+/*
+ * Apply a tuning file written by sg_autotune. Called from sg_init;
+ * costs one small read. Files from another CPU model or library
+ * build, symlinks, and files another user could write are ignored.
+ */
+int guard_tuning_load(const char* path);
+
+int guard_autotune(const char* path, sg_tuning_info_t* out);
+int guard_tuning_info(sg_tuning_info_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_TUNING_H */
@@ -0,0 +1,198 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * fs-verity Backed Baselines
+ *
+ * Responsibilities:
+ * - Detect fs-verity protected executables (FS_IOC_MEASURE_VERITY)
+ * - Read the descriptor and Merkle tree (FS_IOC_READ_VERITY_METADATA)
+ * - Check the tree against the kernel's measurement before trusting it
+ * - Hash in-memory pages the way the tree hashes data blocks
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/fsverity.h>)
+#include <sys/ioctl.h>
+#include <linux/fsverity.h>
+#if defined(FS_IOC_READ_VERITY_METADATA)
+#define SG_HAVE_FSVERITY 1
+#endif
+#endif
+
+#include "verity.h"
+
+namespace {
+
+#if defined(SG_HAVE_FSVERITY)
+
+constexpr unsigned MAX_LEVELS = 8;
+
+/* Pull `length` bytes of verity metadata, looping over short reads */
+bool read_metadata(int fd, uint64_t type, uint64_t offset, void* buf, uint64_t length) {
+    uint8_t* out = static_cast<uint8_t*>(buf);
+    while (length > 0) {
+        struct fsverity_read_metadata_arg arg;
+        std::memset(&arg, 0, sizeof(arg));
+        arg.metadata_type = type;
+        arg.offset = offset;
+        arg.length = length;
+        arg.buf_ptr = reinterpret_cast<uintptr_t>(out);
+        int n = ioctl(fd, FS_IOC_READ_VERITY_METADATA, &arg);
+        if (n <= 0) {
+            return false;
+        }
+        out += n;
+        offset += static_cast<uint64_t>(n);
+        length -= static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+#endif /* SG_HAVE_FSVERITY */
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_verity_probe(int fd, guard_verity_info_t* info) {
+#if defined(SG_HAVE_FSVERITY)
+    alignas(8) uint8_t measure_buf[sizeof(struct fsverity_digest) + 64];
+    struct fsverity_digest* measured = reinterpret_cast<struct fsverity_digest*>(measure_buf);
+    measured->digest_size = 64;
+    if (ioctl(fd, FS_IOC_MEASURE_VERITY, measured) != 0 ||
+        measured->digest_algorithm != FS_VERITY_HASH_ALG_SHA256 ||
+        measured->digest_size != SG_SHA256_DIGEST_SIZE) {
+        return -1;
+    }
+
+    struct fsverity_descriptor desc;
+    if (!read_metadata(fd, FS_VERITY_METADATA_TYPE_DESCRIPTOR, 0, &desc, sizeof(desc))) {
+        return -1;
+    }
+
+    /* The file digest is the hash of the descriptor; it binds the root hash */
+    uint8_t desc_digest[SG_SHA256_DIGEST_SIZE];
+    guard_sha256(&desc, sizeof(desc), desc_digest);
+    if (std::memcmp(desc_digest, measured->digest, SG_SHA256_DIGEST_SIZE) != 0 ||
+        desc.version != 1 || desc.hash_algorithm != FS_VERITY_HASH_ALG_SHA256 ||
+        desc.log_blocksize < 10 || desc.log_blocksize > 16 ||
+        desc.salt_size > sizeof(desc.salt)) {
+        return -1;
+    }
+
+    std::memset(info, 0, sizeof(*info));
+    info->block_size = 1u << desc.log_blocksize;
+    info->data_size = desc.data_size;
+    info->leaf_count = (desc.data_size + info->block_size - 1) / info->block_size;
+    std::memcpy(info->file_digest, measured->digest, SG_SHA256_DIGEST_SIZE);
+
+    /* The salt is zero padded to one SHA-256 block and prefixed to every hash */
+    guard_sha256_init(&info->salted);
+    if (desc.salt_size != 0) {
+        uint8_t padded[SG_SHA256_BLOCK_SIZE] = {0};
+        std::memcpy(padded, desc.salt, desc.salt_size);
+        guard_sha256_update(&info->salted, padded, sizeof(padded));
+    }
+    return info->leaf_count != 0 ? 0 : -1;
+#else
+    (void)fd;
+    (void)info;
+    return -1;
+#endif
+}
+
+int guard_verity_read_leaves(int fd, const guard_verity_info_t* info, uint8_t* leaves) {
+#if defined(SG_HAVE_FSVERITY)
+    const size_t hash_size = SG_SHA256_DIGEST_SIZE;
+    const uint64_t block_size = info->block_size;
+    const uint64_t per_block = block_size / hash_size;
+
+    struct fsverity_descriptor desc;
+    if (!read_metadata(fd, FS_VERITY_METADATA_TYPE_DESCRIPTOR, 0, &desc, sizeof(desc))) {
+        return -1;
+    }
+    uint8_t check[SG_SHA256_DIGEST_SIZE];
+    guard_sha256(&desc, sizeof(desc), check);
+    if (std::memcmp(check, info->file_digest, hash_size) != 0) {
+        return -1;   /* Descriptor changed since the probe */
+    }
+
+    /* A single data block has no tree: its hash is the root */
+    if (info->leaf_count == 1) {
+        std::memcpy(leaves, desc.root_hash, hash_size);
+        return 0;
+    }
+
+    /* Levels are stored root first; level 0 (leaf hashes) is last */
+    uint64_t level_blocks[MAX_LEVELS];
+    unsigned levels = 0;
+    for (uint64_t blocks = info->leaf_count; blocks > 1; ) {
+        if (levels == MAX_LEVELS) {
+            return -1;
+        }
+        blocks = (blocks + per_block - 1) / per_block;
+        level_blocks[levels++] = blocks;
+    }
+
+    uint64_t level_start[MAX_LEVELS];
+    uint64_t total_blocks = 0;
+    for (unsigned l = levels; l-- > 0; ) {
+        level_start[l] = total_blocks;
+        total_blocks += level_blocks[l];
+    }
+
+    std::vector<uint8_t> tree;
+    try {
+        tree.resize(total_blocks * block_size);
+    } catch (const std::bad_alloc&) {
+        return -1;
+    }
+    if (!read_metadata(fd, FS_VERITY_METADATA_TYPE_MERKLE_TREE, 0, tree.data(), tree.size())) {
+        return -1;
+    }
+
+    /* Every block must hash to its entry one level up, the top one to the root */
+    for (unsigned l = 0; l < levels; ++l) {
+        for (uint64_t b = 0; b < level_blocks[l]; ++b) {
+            const uint8_t* block = tree.data() + (level_start[l] + b) * block_size;
+            const uint8_t* expected = (l + 1 < levels)
+                ? tree.data() + level_start[l + 1] * block_size + b * hash_size
+                : desc.root_hash;
+            guard_verity_hash_block(info, block, block_size, check);
+            if (std::memcmp(check, expected, hash_size) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    std::memcpy(leaves, tree.data() + level_start[0] * block_size, info->leaf_count * hash_size);
+    return 0;
+#else
+    (void)fd;
+    (void)info;
+    (void)leaves;
+    return -1;
+#endif
+}
+
+void guard_verity_hash_block(const guard_verity_info_t* info, const void* data, size_t len,
+                             uint8_t out[SG_SHA256_DIGEST_SIZE]) {
+    static const uint8_t zeros[256] = {0};
+
+    guard_sha256_t ctx = info->salted;
+    guard_sha256_update(&ctx, data, len);
+    for (size_t padded = len; padded < info->block_size; ) {
+        size_t n = info->block_size - padded < sizeof(zeros) ? info->block_size - padded : sizeof(zeros);
+        guard_sha256_update(&ctx, zeros, n);
+        padded += n;
+    }
+    guard_sha256_final(&ctx, out);
+}
+
+} /* extern "C" */
@@ -0,0 +1,46 @@
+/*
+ * Self-Guard fs-verity Baselines
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_VERITY_H
+#define SG_INTERNAL_VERITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sha256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t block_size;
+    uint64_t data_size;
+    uint64_t leaf_count;                      /* Data blocks in the file */
+    guard_sha256_t salted;                    /* State after the padded salt */
+    uint8_t file_digest[SG_SHA256_DIGEST_SIZE]; /* FS_IOC_MEASURE_VERITY */
+} guard_verity_info_t;
+
+/*
+ * Returns 0 if fd has fs-verity enabled with SHA-256 and the
+ * descriptor matches the kernel's measurement; -1 otherwise
+ * (no verity, unsupported filesystem or algorithm).
+ */
+int guard_verity_probe(int fd, guard_verity_info_t* info);
+
+/*
+ * Read the Merkle tree, check every level up to the measured root and
+ * copy the leaf hashes (leaf_count * 32 bytes) into leaves.
+ */
+int guard_verity_read_leaves(int fd, const guard_verity_info_t* info, uint8_t* leaves);
+
+/* Leaf hash of one data block; short blocks are zero padded */
+void guard_verity_hash_block(const guard_verity_info_t* info, const void* data, size_t len,
+                             uint8_t out[SG_SHA256_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_VERITY_H */
@@ -0,0 +1,373 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Hardware Watchpoints
+ *
+ * Responsibilities:
+ * - Arm PERF_TYPE_BREAKPOINT write/execute watchpoints on every thread
+ * - Turn synchronous SIGTRAPs into an immediate state change, chaining
+ *   any other SIGTRAP to the previous handler
+ * - Degrade to counting breakpoints, then to digests, where the kernel
+ *   or the debug registers say no
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+#include <csignal>
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/hw_breakpoint.h>
+#include <linux/perf_event.h>
+#endif
+
+extern "C" {
+    #include "self_guard.h"
+    #include "self_guard_asm.h"
+}
+#include "threads.h"
+#include "watch.h"
+
+#ifndef TRAP_PERF
+#define TRAP_PERF 6
+#endif
+
+namespace {
+
+/*
+ * The handler reads addr/len/trip without a lock, so they are atomics;
+ * everything else is only touched under g_watch_mutex.
+ */
+struct Watch {
+    std::atomic<uintptr_t> addr;
+    std::atomic<uintptr_t> retired; /* Last disarmed addr: late traps for it are dropped */
+    std::atomic<size_t> len;
+    std::atomic<uint64_t> hits;     /* Trapped hits */
+    std::atomic<uint32_t> tid;
+    int type;
+    int mode;                       /* sg_watch_mode_t */
+    std::vector<int> fds;           /* One breakpoint per thread */
+    uint64_t counted;               /* Counter total seen by the last poll */
+    uint32_t digest;                /* SG_WATCH_HASH */
+};
+
+Watch g_watches[SG_WATCH_MAX];
+std::mutex g_watch_mutex;
+std::atomic<guard_watch_trip_fn> g_watch_trip(nullptr);
+
+#if defined(__linux__)
+struct sigaction g_old_sigtrap;
+bool g_sigtrap_installed = false;
+
+void sigtrap_handler(int sig, siginfo_t* info, void* context) {
+    if (info != nullptr && info->si_code == TRAP_PERF) {
+        const uintptr_t at = reinterpret_cast<uintptr_t>(info->si_addr);
+        for (Watch& w : g_watches) {
+            const uintptr_t addr = w.addr.load(std::memory_order_acquire);
+            if (addr == 0 || at != addr) {
+                continue;
+            }
+            const uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+            w.hits.fetch_add(1, std::memory_order_relaxed);
+            w.tid.store(tid, std::memory_order_relaxed);
+            guard_watch_trip_fn trip = g_watch_trip.load(std::memory_order_acquire);
+            if (trip != nullptr) {
+                trip(addr, w.len.load(std::memory_order_relaxed), tid);
+            }
+            return;
+        }
+        /* Raised just before its watch was disarmed: ours, but no longer reported */
+        for (Watch& w : g_watches) {
+            if (w.retired.load(std::memory_order_acquire) == at) {
+                return;
+            }
+        }
+    }
+
+    /* Not ours: behave as if we were never installed */
+    if (g_old_sigtrap.sa_flags & SA_SIGINFO) {
+        if (g_old_sigtrap.sa_sigaction != nullptr) {
+            g_old_sigtrap.sa_sigaction(sig, info, context);
+        }
+    } else if (g_old_sigtrap.sa_handler == SIG_DFL) {
+        signal(SIGTRAP, SIG_DFL);
+        raise(SIGTRAP);
+    } else if (g_old_sigtrap.sa_handler != SIG_IGN && g_old_sigtrap.sa_handler != nullptr) {
+        g_old_sigtrap.sa_handler(sig);
+    }
+}
+
+bool install_sigtrap() {
+    if (g_sigtrap_installed) {
+        return true;
+    }
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sigtrap_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGTRAP, &sa, &g_old_sigtrap) != 0) {
+        return false;
+    }
+    g_sigtrap_installed = true;
+    return true;
+}
+
+long perf_event_open(struct perf_event_attr* attr, int tid) {
+    return syscall(SYS_perf_event_open, attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+/* Thread listings arm_breakpoint makes before giving up on a spawning storm */
+constexpr int ARM_MAX_PASSES = 16;
+
+void close_all(Watch& w) {
+    for (int fd : w.fds) {
+        close(fd);
+    }
+    w.fds.clear();
+}
+
+/*
+ * One breakpoint per thread; inherit extends it to threads they start.
+ * With sigtrap the hitting thread gets a synchronous SIGTRAP (5.13+).
+ */
+bool arm_breakpoint(Watch& w, uintptr_t addr, size_t len, int type, bool sigtrap) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_BREAKPOINT;
+    attr.size = sizeof(attr);
+    attr.bp_type = type == SG_WATCH_EXEC ? HW_BREAKPOINT_X : HW_BREAKPOINT_W;
+    attr.bp_addr = addr;
+    attr.bp_len = type == SG_WATCH_EXEC ? sizeof(long) : len;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+#if defined(PERF_ATTR_SIZE_VER7)
+    if (sigtrap) {
+        attr.sample_period = 1;
+        attr.sample_type = PERF_SAMPLE_ADDR;
+        attr.sigtrap = 1;
+        attr.remove_on_exec = 1;   /* Required by sigtrap */
+    }
+#else
+    if (sigtrap) {
+        return false;
+    }
+#endif
+
+    /*
+     * A thread started by one not yet armed inherits nothing: list the
+     * threads again until a pass finds none we have not tried.
+     */
+    std::vector<int> tried;
+    std::vector<int> tids(64);
+    for (int pass = 0; pass < ARM_MAX_PASSES; ++pass) {
+        size_t n = guard_thread_list(tids.data(), tids.size());
+        if (n > tids.size()) {
+            tids.resize(n + 64);
+            n = guard_thread_list(tids.data(), tids.size());
+        }
+        tids.resize(n < tids.size() ? n : tids.size());
+
+        bool added = false;
+        for (int tid : tids) {
+            auto at = std::lower_bound(tried.begin(), tried.end(), tid);
+            if (at != tried.end() && *at == tid) {
+                continue;
+            }
+            tried.insert(at, tid);
+            added = true;
+            long fd = perf_event_open(&attr, tid);
+            if (fd < 0) {
+                if (errno == ESRCH) {
+                    continue;   /* Exited meanwhile */
+                }
+                close_all(w);
+                return false;
+            }
+            w.fds.push_back(static_cast<int>(fd));
+        }
+        if (!added) {
+            return !w.fds.empty();
+        }
+    }
+
+    /* Threads kept appearing faster than we armed them */
+    close_all(w);
+    return false;
+}
+
+/*
+ * Counting breakpoints have no thread; the count itself is the hit.
+ * read() on an inherited event returns its own count plus that of
+ * every child event, live or exited (perf_event_read_value walks
+ * child_list), so hits in threads started after arming are included
+ * as soon as they happen, not when those threads exit.
+ */
+void read_counters(Watch& w) {
+    uint64_t total = 0;
+    for (int fd : w.fds) {
+        uint64_t count = 0;
+        if (read(fd, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count))) {
+            total += count;
+        }
+    }
+    if (total != w.counted) {
+        w.hits.fetch_add(total - w.counted, std::memory_order_relaxed);
+        w.counted = total;
+    }
+}
+#endif
+
+void disarm(Watch& w) {
+    /* Breakpoints first: a trap must never find its watch already gone */
+    for (int fd : w.fds) {
+        close(fd);
+    }
+    w.fds.clear();
+    const uintptr_t addr = w.addr.load(std::memory_order_relaxed);
+    if (addr != 0) {
+        w.retired.store(addr, std::memory_order_release);
+    }
+    w.addr.store(0, std::memory_order_release);
+    w.len.store(0, std::memory_order_relaxed);
+    w.hits.store(0, std::memory_order_relaxed);
+    w.tid.store(0, std::memory_order_relaxed);
+    w.counted = 0;
+    w.digest = 0;
+}
+
+Watch* find_watch(uintptr_t addr) {
+    for (Watch& w : g_watches) {
+        if (addr != 0 && w.addr.load(std::memory_order_relaxed) == addr) {
+            return &w;
+        }
+    }
+    return nullptr;
+}
+
+} /* anonymous namespace */
+
+extern "C" {
+
+int guard_watch_add(const void* addr, size_t len, int type, guard_watch_trip_fn trip) {
+    const uintptr_t at = reinterpret_cast<uintptr_t>(addr);
+    if (at == 0 || len == 0 || (type != SG_WATCH_WRITE && type != SG_WATCH_EXEC)) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    if (find_watch(at) != nullptr) {
+        return -1;
+    }
+    Watch* slot = nullptr;
+    for (Watch& w : g_watches) {
+        if (w.addr.load(std::memory_order_relaxed) == 0) {
+            slot = &w;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        return -1;
+    }
+    g_watch_trip.store(trip, std::memory_order_release);
+
+    Watch& w = *slot;
+    w.type = type;
+    w.len.store(len, std::memory_order_relaxed);
+    w.mode = SG_WATCH_HASH;
+    w.digest = sg_checksum_memory(addr, len);
+
+#if defined(__linux__)
+    /* Debug registers take 1, 2, 4 or 8 aligned bytes; exec takes one instruction */
+    const bool hw_shape = type == SG_WATCH_EXEC ||
+                          ((len == 1 || len == 2 || len == 4 || len == 8) && at % len == 0);
+    if (hw_shape) {
+        if (install_sigtrap() && arm_breakpoint(w, at, len, type, true)) {
+            w.mode = SG_WATCH_SIGNAL;
+        } else if (arm_breakpoint(w, at, len, type, false)) {
+            w.mode = SG_WATCH_COUNTER;
+        }
+    }
+#endif
+    w.addr.store(at, std::memory_order_release);
+    return w.mode;
+}
+
+int guard_watch_remove(const void* addr) {
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    Watch* w = find_watch(reinterpret_cast<uintptr_t>(addr));
+    if (w == nullptr) {
+        return -1;
+    }
+    disarm(*w);
+    return 0;
+}
+
+int guard_watch_query(const void* addr, int* mode, int* type, uint64_t* hits) {
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    Watch* w = find_watch(reinterpret_cast<uintptr_t>(addr));
+    if (w == nullptr) {
+        return -1;
+    }
+#if defined(__linux__)
+    if (w->mode == SG_WATCH_COUNTER) {
+        read_counters(*w);
+    }
+#endif
+    *mode = w->mode;
+    *type = w->type;
+    *hits = w->hits.load(std::memory_order_relaxed);
+    return 0;
+}
+
+int guard_watch_poll(guard_watch_hit_t* hit) {
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    int armed = 0;
+    int tripped = 0;
+    for (Watch& w : g_watches) {
+        const uintptr_t addr = w.addr.load(std::memory_order_relaxed);
+        if (addr == 0) {
+            continue;
+        }
+        ++armed;
+        const size_t len = w.len.load(std::memory_order_relaxed);
+#if defined(__linux__)
+        if (w.mode == SG_WATCH_COUNTER) {
+            read_counters(w);
+        }
+#endif
+        if (w.mode == SG_WATCH_HASH &&
+            sg_checksum_memory(reinterpret_cast<const void*>(addr), len) != w.digest) {
+            /* A digest sees the change but not how many writes made it */
+            w.hits.store(1, std::memory_order_relaxed);
+        }
+        const uint64_t hits = w.hits.load(std::memory_order_relaxed);
+        if (hits == 0) {
+            continue;
+        }
+        if (tripped++ == 0) {
+            hit->addr = addr;
+            hit->len = len;
+            hit->hits = hits;
+            hit->tid = w.tid.load(std::memory_order_relaxed);
+        }
+    }
+    return armed != 0 ? tripped : -1;
+}
+
+void guard_watch_clear(void) {
+    std::lock_guard<std::mutex> lock(g_watch_mutex);
+    for (Watch& w : g_watches) {
+        disarm(w);
+    }
+    g_watch_trip.store(nullptr, std::memory_order_release);
+}
+
+} /* extern "C" */
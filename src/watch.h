@@ -0,0 +1,55 @@
+/*
+ * Self-Guard Hardware Watchpoints
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_WATCH_H
+#define SG_INTERNAL_WATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Called from the SIGTRAP handler: must be async-signal-safe */
+typedef void (*guard_watch_trip_fn)(uintptr_t addr, size_t len, uint32_t tid);
+
+typedef struct {
+    uintptr_t addr;
+    size_t len;
+    uint64_t hits;
+    uint32_t tid;           /* Thread of the last hit, 0 if unknown */
+} guard_watch_hit_t;
+
+/*
+ * Watch [addr, addr + len) for writes or execution (SG_WATCH_*).
+ * Tries a hardware breakpoint on every thread that traps synchronously
+ * (calling trip), then one that only counts, then falls back to a
+ * digest compared on poll. Returns the sg_watch_mode_t used, or -1 if
+ * the table is full or the range is already watched.
+ */
+int guard_watch_add(const void* addr, size_t len, int type, guard_watch_trip_fn trip);
+
+/* Returns 0 if addr was watched */
+int guard_watch_remove(const void* addr);
+
+/* Mode, type and hits of the watch at addr; returns 0 if found */
+int guard_watch_query(const void* addr, int* mode, int* type, uint64_t* hits);
+
+/*
+ * Collect hits since the watches were armed: trapped and counted
+ * breakpoints, and digests that no longer match. Returns the number
+ * of tripped watches with the first in *hit, or -1 if none is armed.
+ */
+int guard_watch_poll(guard_watch_hit_t* hit);
+
+/* Disarm everything */
+void guard_watch_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_WATCH_H */
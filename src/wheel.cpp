@@ -0,0 +1,161 @@
+/*
+ * Self-Guard Runtime Integrity Protection Library
+ * Hierarchical Timer Wheel
+ *
+ * Responsibilities:
+ * - Queue and dequeue intrusive timers in O(1)
+ * - Cascade coarse slots into finer ones as their time comes up
+ * - Tell the caller how long it may sleep, skipping idle ticks
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "wheel.h"
+
+namespace {
+
+constexpr unsigned WHEEL_LEVELS = GUARD_WHEEL_LEVELS;
+constexpr unsigned WHEEL_BITS = GUARD_WHEEL_BITS;
+constexpr uint64_t WHEEL_SLOT_MASK = GUARD_WHEEL_SLOTS - 1;
+constexpr uint64_t WHEEL_HORIZON = 1ULL << (WHEEL_BITS * WHEEL_LEVELS);
+
+inline unsigned level_shift(unsigned level) {
+    return WHEEL_BITS * level;
+}
+
+void link_timer(guard_wheel_t* wheel, guard_wheel_timer_t* timer, unsigned level, unsigned slot) {
+    guard_wheel_timer_t** head = &wheel->slots[level][slot];
+    timer->next = *head;
+    if (*head != nullptr) {
+        (*head)->pprev = &timer->next;
+    }
+    *head = timer;
+    timer->pprev = head;
+    timer->bucket = level * GUARD_WHEEL_SLOTS + slot;
+    wheel->occupied[level] |= 1ULL << slot;
+}
+
+/*
+ * Queue relative to wheel->now: the level is the one whose slots are
+ * just fine enough for the distance, so the slot comes up (and
+ * cascades) before the timer is due and never a lap early.
+ * Returns false if the timer is already due.
+ */
+bool place_timer(guard_wheel_t* wheel, guard_wheel_timer_t* timer) {
+    if (timer->expires <= wheel->now) {
+        return false;
+    }
+    const uint64_t delta = timer->expires - wheel->now < WHEEL_HORIZON
+        ? timer->expires - wheel->now : WHEEL_HORIZON - 1;
+    const uint64_t at = wheel->now + delta;
+
+    unsigned level = 0;
+    while (level + 1 < WHEEL_LEVELS && delta >= (1ULL << level_shift(level + 1))) {
+        ++level;
+    }
+    link_timer(wheel, timer, level, static_cast<unsigned>((at >> level_shift(level)) & WHEEL_SLOT_MASK));
+    return true;
+}
+
+/* Detach a whole slot; its timers still point into it until requeued */
+guard_wheel_timer_t* take_slot(guard_wheel_t* wheel, unsigned level, unsigned slot) {
+    guard_wheel_timer_t* list = wheel->slots[level][slot];
+    wheel->slots[level][slot] = nullptr;
+    wheel->occupied[level] &= ~(1ULL << slot);
+    return list;
+}
+
+/* Requeue a detached list, collecting what is due into *expired */
+void requeue(guard_wheel_t* wheel, guard_wheel_timer_t* list, guard_wheel_timer_t** expired) {
+    while (list != nullptr) {
+        guard_wheel_timer_t* next = list->next;
+        if (!place_timer(wheel, list)) {
+            list->pprev = nullptr;
+            list->next = *expired;
+            *expired = list;
+        }
+        list = next;
+    }
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+void guard_wheel_init(guard_wheel_t* wheel, uint64_t now) {
+    std::memset(wheel, 0, sizeof(*wheel));
+    wheel->now = now;
+}
+
+void guard_wheel_add(guard_wheel_t* wheel, guard_wheel_timer_t* timer, uint64_t expires) {
+    if (timer->pprev != nullptr) {
+        guard_wheel_remove(wheel, timer);
+    }
+    timer->expires = expires > wheel->now ? expires : wheel->now + 1;
+    place_timer(wheel, timer);
+}
+
+void guard_wheel_remove(guard_wheel_t* wheel, guard_wheel_timer_t* timer) {
+    if (timer->pprev == nullptr) {
+        return;
+    }
+    *timer->pprev = timer->next;
+    if (timer->next != nullptr) {
+        timer->next->pprev = timer->pprev;
+    }
+    const unsigned level = timer->bucket / GUARD_WHEEL_SLOTS;
+    const unsigned slot = timer->bucket % GUARD_WHEEL_SLOTS;
+    if (wheel->slots[level][slot] == nullptr) {
+        wheel->occupied[level] &= ~(1ULL << slot);
+    }
+    timer->next = nullptr;
+    timer->pprev = nullptr;
+}
+
+guard_wheel_timer_t* guard_wheel_advance(guard_wheel_t* wheel, uint64_t now) {
+    guard_wheel_timer_t* expired = nullptr;
+
+    /* Jump straight to each tick that has a slot to process */
+    while (wheel->now < now) {
+        const uint64_t tick = guard_wheel_next(wheel);
+        if (tick > now) {
+            wheel->now = now;
+            break;
+        }
+        wheel->now = tick;
+
+        /* Coarsest first, so a cascade can land in a finer slot due now */
+        for (unsigned level = WHEEL_LEVELS - 1; level > 0; --level) {
+            const unsigned shift = level_shift(level);
+            if ((tick & ((1ULL << shift) - 1)) == 0) {
+                requeue(wheel, take_slot(wheel, level,
+                                         static_cast<unsigned>((tick >> shift) & WHEEL_SLOT_MASK)),
+                        &expired);
+            }
+        }
+        requeue(wheel, take_slot(wheel, 0, static_cast<unsigned>(tick & WHEEL_SLOT_MASK)), &expired);
+    }
+    return expired;
+}
+
+uint64_t guard_wheel_next(const guard_wheel_t* wheel) {
+    uint64_t best = UINT64_MAX;
+    for (unsigned level = 0; level < WHEEL_LEVELS; ++level) {
+        const uint64_t occupied = wheel->occupied[level];
+        if (occupied == 0) {
+            continue;
+        }
+        /* First tick after now at which this level processes a slot, and its index */
+        const unsigned shift = level_shift(level);
+        const uint64_t base = ((wheel->now >> shift) + 1) << shift;
+        const unsigned index = static_cast<unsigned>((base >> shift) & WHEEL_SLOT_MASK);
+        const uint64_t rotated = (occupied >> index) | (occupied << ((GUARD_WHEEL_SLOTS - index) & WHEEL_SLOT_MASK));
+        const uint64_t tick = base + (static_cast<uint64_t>(__builtin_ctzll(rotated)) << shift);
+        best = tick < best ? tick : best;
+    }
+    return best;
+}
+
+} // extern "C"
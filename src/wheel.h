@@ -0,0 +1,59 @@
+/*
+ * Self-Guard Timer Wheel
+ * Internal interface used by the C++ core
+ */
+
+#ifndef SG_INTERNAL_WHEEL_H
+#define SG_INTERNAL_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GUARD_WHEEL_LEVELS  4
+#define GUARD_WHEEL_BITS    6
+#define GUARD_WHEEL_SLOTS   (1u << GUARD_WHEEL_BITS)
+
+/* Embedded in the owner's record; the wheel never allocates */
+typedef struct guard_wheel_timer {
+    struct guard_wheel_timer* next;
+    struct guard_wheel_timer** pprev;   /* NULL while not queued */
+    uint64_t expires;                   /* Tick */
+    uint32_t bucket;                    /* level * GUARD_WHEEL_SLOTS + slot */
+} guard_wheel_timer_t;
+
+/*
+ * Level L slots are 64^L ticks wide; timers cascade one level down
+ * when their slot comes up, so queueing and expiry are O(1) and the
+ * horizon is 64^4 ticks (later expiries are requeued at the horizon).
+ */
+typedef struct {
+    uint64_t now;                                   /* Last tick processed */
+    uint64_t occupied[GUARD_WHEEL_LEVELS];          /* Bit per non-empty slot */
+    guard_wheel_timer_t* slots[GUARD_WHEEL_LEVELS][GUARD_WHEEL_SLOTS];
+} guard_wheel_t;
+
+void guard_wheel_init(guard_wheel_t* wheel, uint64_t now);
+
+/* (Re)queue timer; expiries not after now fire on the next advance */
+void guard_wheel_add(guard_wheel_t* wheel, guard_wheel_timer_t* timer, uint64_t expires);
+
+void guard_wheel_remove(guard_wheel_t* wheel, guard_wheel_timer_t* timer);
+
+/*
+ * Process ticks up to now. Expired timers are dequeued and returned
+ * as a list linked through next, or NULL if none expired.
+ */
+guard_wheel_timer_t* guard_wheel_advance(guard_wheel_t* wheel, uint64_t now);
+
+/* Earliest tick at which advance can return a timer; UINT64_MAX if empty */
+uint64_t guard_wheel_next(const guard_wheel_t* wheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SG_INTERNAL_WHEEL_H */
@@ -0,0 +1,678 @@
+/*
+ * sg-attestd: Self-Guard local attestation daemon
+ *
+ * Usage: sg-attestd [-s socket] [-m mode] [-n max-processes]
+ *        sg-attestd -q [-s socket] [-r] [-b count] [pid...]
+ *
+ * Processes that call sg_attest_attach register a shared segment
+ * holding their state word, heartbeat and Merkle roots. The daemon
+ * maps each segment read-only and answers QUERY / REGIONS requests
+ * from it: a query costs a few loads per process and never reaches
+ * the process itself. A registration ends when its socket closes.
+ *
+ * Single-threaded epoll loop. A client that stops reading its
+ * replies is disconnected rather than buffered for.
+ *
+ * -q runs the bundled client instead: print the records of the given
+ * pids (all registered processes if none), -r their region roots,
+ * -b repeat the query count times and report the rate.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "self_guard_attest.h"
+
+typedef struct {
+    uint32_t pid;
+    int fd;                              /* Registration connection */
+    const sg_attest_segment_t* segment;  /* Read-only mapping */
+} attest_process_t;
+
+/* Registered processes, sorted by pid */
+static attest_process_t* g_procs = NULL;
+static size_t g_proc_count = 0;
+static size_t g_proc_capacity = 0;
+static size_t g_proc_max = 65536;
+
+/* Connection fd -> registered pid (0 = plain client) */
+static uint32_t* g_fd_pid = NULL;
+static size_t g_fd_capacity = 0;
+
+static int g_epoll = -1;
+static volatile sig_atomic_t g_stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+static const char* state_to_string(uint32_t state) {
+    switch (state) {
+        case 0:  return "SAFE";
+        case 1:  return "WARNING";
+        case 2:  return "COMPROMISED";
+        default: return "UNKNOWN";
+    }
+}
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ============================================
+ * Process Table
+ * ============================================ */
+
+/* Index of pid, or of where it would be inserted */
+static size_t find_process(uint32_t pid) {
+    size_t lo = 0;
+    size_t hi = g_proc_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (g_procs[mid].pid < pid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static const attest_process_t* lookup_process(uint32_t pid) {
+    size_t i = find_process(pid);
+    return i < g_proc_count && g_procs[i].pid == pid ? &g_procs[i] : NULL;
+}
+
+static void remove_process(size_t i) {
+    munmap((void*)g_procs[i].segment, sizeof(sg_attest_segment_t));
+    if ((size_t)g_procs[i].fd < g_fd_capacity) {
+        g_fd_pid[g_procs[i].fd] = 0;
+    }
+    memmove(&g_procs[i], &g_procs[i + 1], (g_proc_count - i - 1) * sizeof(attest_process_t));
+    g_proc_count--;
+}
+
+static int track_fd(int fd) {
+    if ((size_t)fd < g_fd_capacity) {
+        g_fd_pid[fd] = 0;
+        return 0;
+    }
+    size_t capacity = g_fd_capacity != 0 ? g_fd_capacity : 256;
+    while (capacity <= (size_t)fd) {
+        capacity *= 2;
+    }
+    uint32_t* grown = realloc(g_fd_pid, capacity * sizeof(uint32_t));
+    if (grown == NULL) {
+        return -1;
+    }
+    memset(grown + g_fd_capacity, 0, (capacity - g_fd_capacity) * sizeof(uint32_t));
+    g_fd_pid = grown;
+    g_fd_capacity = capacity;
+    return 0;
+}
+
+static void close_connection(int fd) {
+    epoll_ctl(g_epoll, EPOLL_CTL_DEL, fd, NULL);
+    uint32_t pid = g_fd_pid[fd];
+    if (pid != 0) {
+        size_t i = find_process(pid);
+        if (i < g_proc_count && g_procs[i].pid == pid && g_procs[i].fd == fd) {
+            remove_process(i);
+        }
+        g_fd_pid[fd] = 0;
+    }
+    close(fd);
+}
+
+/* ============================================
+ * Segment Reads
+ * ============================================ */
+
+/*
+ * Copy the roots block under its seqlock. The writer is the guarded
+ * process, so a sequence stuck odd gives up instead of spinning.
+ */
+static int read_roots(const sg_attest_segment_t* seg, uint8_t root[SG_ATTEST_ROOT_SIZE],
+                      uint32_t* total, sg_attest_region_t* regions, uint32_t* count) {
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        uint32_t seq = __atomic_load_n(&seg->roots_seq, __ATOMIC_ACQUIRE);
+        if (seq & 1u) {
+            continue;
+        }
+        memcpy(root, seg->root, SG_ATTEST_ROOT_SIZE);
+        *total = seg->region_total;
+        if (regions != NULL) {
+            uint32_t n = seg->region_count;
+            *count = n < SG_ATTEST_MAX_REGIONS ? n : SG_ATTEST_MAX_REGIONS;
+            memcpy(regions, seg->regions, *count * sizeof(sg_attest_region_t));
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&seg->roots_seq, __ATOMIC_RELAXED) == seq) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+typedef struct {
+    uint64_t units;     /* CLOCK_MONOTONIC in state-word units */
+    uint64_t coarse;    /* CLOCK_MONOTONIC_COARSE, the heartbeat's clock */
+} attest_now_t;
+
+static void fill_record(uint32_t pid, const attest_process_t* proc, const attest_now_t* now,
+                        sg_attest_record_t* rec) {
+    memset(rec, 0, sizeof(*rec));
+    rec->pid = pid;
+    if (proc == NULL) {
+        rec->flags = SG_ATTEST_R_UNKNOWN;
+        return;
+    }
+
+    const sg_attest_segment_t* seg = proc->segment;
+    uint64_t word = __atomic_load_n(&seg->state_word, __ATOMIC_ACQUIRE);
+    uint64_t deadline = __atomic_load_n(&seg->heartbeat_ns, __ATOMIC_RELAXED);
+    uint64_t verified = SG_ATTEST_WORD_TIME(word);
+
+    rec->state = SG_ATTEST_WORD_STATE(word);
+    rec->generation = SG_ATTEST_WORD_GENERATION(word);
+    rec->age_ns = verified == 0 ? UINT64_MAX
+                : ((now->units - verified) & SG_ATTEST_TIME_MASK) << SG_ATTEST_TIME_UNIT_SHIFT;
+
+    /* Same rule as sg_get_security_state: a stalled monitor cannot vouch for SAFE */
+    if (deadline != 0 && now->coarse > deadline) {
+        rec->flags |= SG_ATTEST_R_STALLED;
+        if (rec->state == 0) {
+            rec->state = 1;
+        }
+    }
+
+    if (read_roots(seg, rec->root, &rec->region_total, NULL, NULL) != 0 ||
+        rec->region_total == 0) {
+        rec->flags |= SG_ATTEST_R_NO_ROOTS;
+    }
+}
+
+/* ============================================
+ * Requests
+ * ============================================ */
+
+typedef union {
+    sg_attest_msg_t header;
+    struct {
+        sg_attest_msg_t header;
+        sg_attest_record_t records[SG_ATTEST_MAX_BATCH];
+    } query;
+    struct {
+        sg_attest_msg_t header;
+        sg_attest_region_t regions[SG_ATTEST_MAX_REGIONS];
+    } roots;
+} attest_reply_t;
+
+static int send_packet(int fd, const void* data, size_t len) {
+    return send(fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT) == (ssize_t)len ? 0 : -1;
+}
+
+static int send_status(int fd, const sg_attest_msg_t* request, uint32_t status) {
+    sg_attest_msg_t reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.type = (uint16_t)(request->type | SG_ATTEST_MSG_REPLY);
+    reply.tag = request->tag;
+    reply.status = status;
+    return send_packet(fd, &reply, sizeof(reply));
+}
+
+static int handle_register(int fd, const sg_attest_msg_t* request, int memfd) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    struct stat st;
+
+    if (memfd < 0) {
+        return send_status(fd, request, EINVAL);
+    }
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || cred.pid <= 0) {
+        return send_status(fd, request, EPERM);
+    }
+    if (g_fd_pid[fd] != 0) {
+        return send_status(fd, request, EALREADY);
+    }
+
+    /* Without the shrink seal the process could truncate the file under our mapping */
+    int seals = fcntl(memfd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK) ||
+        fstat(memfd, &st) != 0 || (size_t)st.st_size < sizeof(sg_attest_segment_t)) {
+        return send_status(fd, request, EINVAL);
+    }
+
+    void* base = mmap(NULL, sizeof(sg_attest_segment_t), PROT_READ, MAP_SHARED, memfd, 0);
+    if (base == MAP_FAILED) {
+        return send_status(fd, request, ENOMEM);
+    }
+    const sg_attest_segment_t* seg = base;
+    if (__atomic_load_n(&seg->magic, __ATOMIC_ACQUIRE) != SG_ATTEST_MAGIC ||
+        seg->version != SG_ATTEST_VERSION || seg->size != sizeof(sg_attest_segment_t)) {
+        munmap(base, sizeof(sg_attest_segment_t));
+        return send_status(fd, request, EPROTO);
+    }
+
+    const uint32_t pid = (uint32_t)cred.pid;
+    size_t i = find_process(pid);
+    if (i < g_proc_count && g_procs[i].pid == pid) {
+        /* Re-registered before we saw the old connection close */
+        munmap((void*)g_procs[i].segment, sizeof(sg_attest_segment_t));
+        g_fd_pid[g_procs[i].fd] = 0;
+    } else {
+        if (g_proc_count == g_proc_max) {
+            munmap(base, sizeof(sg_attest_segment_t));
+            return send_status(fd, request, ENOSPC);
+        }
+        if (g_proc_count == g_proc_capacity) {
+            size_t capacity = g_proc_capacity != 0 ? g_proc_capacity * 2 : 64;
+            attest_process_t* grown = realloc(g_procs, capacity * sizeof(attest_process_t));
+            if (grown == NULL) {
+                munmap(base, sizeof(sg_attest_segment_t));
+                return send_status(fd, request, ENOMEM);
+            }
+            g_procs = grown;
+            g_proc_capacity = capacity;
+        }
+        memmove(&g_procs[i + 1], &g_procs[i], (g_proc_count - i) * sizeof(attest_process_t));
+        g_proc_count++;
+    }
+
+    g_procs[i].pid = pid;
+    g_procs[i].fd = fd;
+    g_procs[i].segment = seg;
+    g_fd_pid[fd] = pid;
+    return send_status(fd, request, 0);
+}
+
+static int handle_query(int fd, const sg_attest_msg_t* request, const uint32_t* pids) {
+    static attest_reply_t reply;
+    attest_now_t now;
+    now.units = (clock_ns(CLOCK_MONOTONIC) >> SG_ATTEST_TIME_UNIT_SHIFT) & SG_ATTEST_TIME_MASK;
+    now.coarse = clock_ns(CLOCK_MONOTONIC_COARSE);
+
+    memset(&reply.header, 0, sizeof(reply.header));
+    reply.header.type = SG_ATTEST_MSG_QUERY | SG_ATTEST_MSG_REPLY;
+    reply.header.tag = request->tag;
+
+    if (request->count != 0) {
+        for (uint32_t i = 0; i < request->count; ++i) {
+            fill_record(pids[i], lookup_process(pids[i]), &now, &reply.query.records[i]);
+        }
+        reply.header.count = request->count;
+        return send_packet(fd, &reply,
+                           sizeof(sg_attest_msg_t) + request->count * sizeof(sg_attest_record_t));
+    }
+
+    /* Every registered process, one batch per packet */
+    size_t i = 0;
+    do {
+        uint32_t n = 0;
+        while (n < SG_ATTEST_MAX_BATCH && i < g_proc_count) {
+            fill_record(g_procs[i].pid, &g_procs[i], &now, &reply.query.records[n++]);
+            i++;
+        }
+        reply.header.count = n;
+        reply.header.flags = i < g_proc_count ? SG_ATTEST_F_MORE : 0;
+        if (send_packet(fd, &reply, sizeof(sg_attest_msg_t) + n * sizeof(sg_attest_record_t)) != 0) {
+            return -1;
+        }
+    } while (i < g_proc_count);
+    return 0;
+}
+
+static int handle_regions(int fd, const sg_attest_msg_t* request, const uint32_t* pids) {
+    static attest_reply_t reply;
+    uint8_t root[SG_ATTEST_ROOT_SIZE];
+    uint32_t total;
+    uint32_t count;
+
+    if (request->count != 1) {
+        return send_status(fd, request, EINVAL);
+    }
+    const attest_process_t* proc = lookup_process(pids[0]);
+    if (proc == NULL) {
+        return send_status(fd, request, ESRCH);
+    }
+    if (read_roots(proc->segment, root, &total, reply.roots.regions, &count) != 0) {
+        return send_status(fd, request, EAGAIN);
+    }
+
+    memset(&reply.header, 0, sizeof(reply.header));
+    reply.header.type = SG_ATTEST_MSG_REGIONS | SG_ATTEST_MSG_REPLY;
+    reply.header.tag = request->tag;
+    reply.header.count = count;
+    return send_packet(fd, &reply, sizeof(sg_attest_msg_t) + count * sizeof(sg_attest_region_t));
+}
+
+/* Drain pending requests on fd; returns -1 when the connection must close */
+static int serve_connection(int fd) {
+    struct {
+        sg_attest_msg_t header;
+        uint32_t pids[SG_ATTEST_MAX_BATCH];
+    } request;
+    union {
+        char buf[CMSG_SPACE(4 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    for (;;) {
+        struct iovec iov = {&request, sizeof(request)};
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        ssize_t n = recvmsg(fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+        }
+        if (n == 0) {
+            return -1;
+        }
+
+        int memfd = -1;
+        for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c != NULL; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+            size_t fds = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t k = 0; k < fds; ++k) {
+                int passed;
+                memcpy(&passed, CMSG_DATA(c) + k * sizeof(int), sizeof(int));
+                if (memfd < 0) {
+                    memfd = passed;
+                } else {
+                    close(passed);
+                }
+            }
+        }
+
+        int result;
+        if ((size_t)n < sizeof(sg_attest_msg_t) || (msg.msg_flags & MSG_TRUNC) ||
+            (size_t)n != sizeof(sg_attest_msg_t) + request.header.count * sizeof(uint32_t)) {
+            result = send_status(fd, &request.header, EMSGSIZE);
+        } else if (request.header.type == SG_ATTEST_MSG_REGISTER) {
+            result = handle_register(fd, &request.header, memfd);
+        } else if (request.header.type == SG_ATTEST_MSG_QUERY) {
+            result = handle_query(fd, &request.header, request.pids);
+        } else if (request.header.type == SG_ATTEST_MSG_REGIONS) {
+            result = handle_regions(fd, &request.header, request.pids);
+        } else {
+            result = send_status(fd, &request.header, EOPNOTSUPP);
+        }
+
+        if (memfd >= 0) {
+            close(memfd);
+        }
+        if (result != 0) {
+            return -1;
+        }
+    }
+}
+
+static int open_listener(const char* path, mode_t mode) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    const size_t len = strlen(path);
+    if (len >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "sg-attestd: socket path too long: %s\n", path);
+        return -1;
+    }
+    memcpy(addr.sun_path, path, len + 1);
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        perror("sg-attestd: socket");
+        return -1;
+    }
+
+    /* A socket file nobody answers on is left over from a dead daemon */
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "sg-attestd: already running on %s\n", path);
+        close(sock);
+        return -1;
+    }
+    unlink(path);
+
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        chmod(path, mode) != 0 ||
+        listen(sock, SOMAXCONN) != 0) {
+        perror(path);
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static int run_daemon(const char* path, mode_t mode) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    int listener = open_listener(path, mode);
+    if (listener < 0) {
+        return EXIT_FAILURE;
+    }
+
+    g_epoll = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listener;
+    if (g_epoll < 0 || epoll_ctl(g_epoll, EPOLL_CTL_ADD, listener, &ev) != 0) {
+        perror("sg-attestd: epoll");
+        unlink(path);
+        return EXIT_FAILURE;
+    }
+
+    struct epoll_event events[64];
+    while (!g_stop) {
+        int n = epoll_wait(g_epoll, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("sg-attestd: epoll_wait");
+            break;
+        }
+
+        for (int e = 0; e < n; ++e) {
+            int fd = events[e].data.fd;
+            if (fd != listener) {
+                if (serve_connection(fd) != 0) {
+                    close_connection(fd);
+                }
+                continue;
+            }
+
+            for (;;) {
+                int conn = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (conn < 0) {
+                    break;
+                }
+                ev.events = EPOLLIN | EPOLLRDHUP;
+                ev.data.fd = conn;
+                if (track_fd(conn) != 0 || epoll_ctl(g_epoll, EPOLL_CTL_ADD, conn, &ev) != 0) {
+                    close(conn);
+                }
+            }
+        }
+    }
+
+    unlink(path);
+    return EXIT_SUCCESS;
+}
+
+/* ============================================
+ * Query Mode
+ * ============================================ */
+
+static void print_root(const uint8_t* root) {
+    for (int i = 0; i < SG_ATTEST_ROOT_SIZE; ++i) {
+        printf("%02x", root[i]);
+    }
+}
+
+static int run_query(const char* path, int roots, long repeat, uint32_t* pids, size_t count) {
+    static sg_attest_record_t records[65536];
+    int sock = sg_attest_connect(path);
+    if (sock < 0) {
+        perror(path != NULL ? path : "sg-attestd");
+        return EXIT_FAILURE;
+    }
+
+    if (roots) {
+        for (size_t i = 0; i < count; ++i) {
+            sg_attest_region_t regions[SG_ATTEST_MAX_REGIONS];
+            int n = sg_attest_regions(sock, pids[i], regions, SG_ATTEST_MAX_REGIONS);
+            if (n < 0) {
+                fprintf(stderr, "pid %u: %s\n", pids[i], strerror(errno));
+                continue;
+            }
+            for (int r = 0; r < n; ++r) {
+                printf("%u 0x%llx %llu %u %u ", pids[i], (unsigned long long)regions[r].addr,
+                       (unsigned long long)regions[r].len, regions[r].granule, regions[r].hash);
+                print_root(regions[r].root);
+                printf("\n");
+            }
+        }
+        close(sock);
+        return EXIT_SUCCESS;
+    }
+
+    if (repeat > 0) {
+        uint64_t start = clock_ns(CLOCK_MONOTONIC);
+        long returned = 0;
+        for (long i = 0; i < repeat; ++i) {
+            int n = sg_attest_query(sock, pids, count, records, 65536);
+            if (n < 0) {
+                perror("query");
+                close(sock);
+                return EXIT_FAILURE;
+            }
+            returned += n;
+        }
+        double secs = (double)(clock_ns(CLOCK_MONOTONIC) - start) / 1e9;
+        printf("%ld queries, %ld records in %.3f s: %.0f queries/s, %.1f us/query\n",
+               repeat, returned, secs, repeat / secs, secs * 1e6 / repeat);
+        close(sock);
+        return EXIT_SUCCESS;
+    }
+
+    int n = sg_attest_query(sock, pids, count, records, 65536);
+    close(sock);
+    if (n < 0) {
+        perror("query");
+        return EXIT_FAILURE;
+    }
+    printf("%-8s %-12s %-10s %-14s %-7s %s\n", "PID", "STATE", "GEN", "AGE_MS", "REGIONS", "ROOT");
+    for (int i = 0; i < n && i < 65536; ++i) {
+        const sg_attest_record_t* rec = &records[i];
+        if (rec->flags & SG_ATTEST_R_UNKNOWN) {
+            printf("%-8u not registered\n", rec->pid);
+            continue;
+        }
+        char age[32];
+        if (rec->age_ns == UINT64_MAX) {
+            snprintf(age, sizeof(age), "never");
+        } else {
+            snprintf(age, sizeof(age), "%.3f", (double)rec->age_ns / 1e6);
+        }
+        printf("%-8u %-12s %-10u %-14s %-7u ", rec->pid, state_to_string(rec->state),
+               rec->generation, age, rec->region_total);
+        if (rec->flags & SG_ATTEST_R_NO_ROOTS) {
+            printf("-");
+        } else {
+            print_root(rec->root);
+        }
+        printf("%s\n", rec->flags & SG_ATTEST_R_STALLED ? " (monitor stalled)" : "");
+    }
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [-s socket] [-m mode] [-n max-processes]\n"
+            "       %s -q [-s socket] [-r] [-b count] [pid...]\n",
+            argv0, argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    mode_t mode = 0666;
+    int query = 0;
+    int roots = 0;
+    long repeat = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:m:n:qrb:")) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'm': mode = (mode_t)strtoul(optarg, NULL, 8); break;
+            case 'n': g_proc_max = strtoul(optarg, NULL, 10); break;
+            case 'q': query = 1; break;
+            case 'r': roots = 1; break;
+            case 'b': repeat = strtol(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    size_t count = (size_t)(argc - optind);
+    if (!query && (count != 0 || roots || repeat != 0)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (query) {
+        uint32_t* pids = calloc(count != 0 ? count : 1, sizeof(uint32_t));
+        if (pids == NULL) {
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            pids[i] = (uint32_t)strtoul(argv[optind + (int)i], NULL, 10);
+        }
+        if (roots && count == 0) {
+            usage(argv[0]);
+            free(pids);
+            return EXIT_FAILURE;
+        }
+        int rc = run_query(path, roots, repeat, pids, count);
+        free(pids);
+        return rc;
+    }
+
+    if (path == NULL) {
+        path = getenv(SG_ATTEST_SOCKET_ENV);
+    }
+    if (path == NULL || path[0] == '\0') {
+        path = SG_ATTEST_DEFAULT_SOCKET;
+    }
+    return run_daemon(path, mode);
+}
@@ -0,0 +1,139 @@
+/*
+ * sg-journal: Self-Guard forensic journal reader
+ *
+ * Usage: sg-journal <journal-file>
+ *
+ * Decodes every committed record in order. Slots that were reserved
+ * but never committed (writer killed mid-record) are reported as torn.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "self_guard_journal.h"
+
+static const char* event_to_string(uint16_t type) {
+    switch (type) {
+        case SG_JEV_OPEN:      return "OPEN";
+        case SG_JEV_SNAPSHOT:  return "SNAPSHOT";
+        case SG_JEV_DETECTION: return "DETECTION";
+        case SG_JEV_STATE:     return "STATE";
+        case SG_JEV_CLOSE:     return "CLOSE";
+        case SG_JEV_REPAIR:    return "REPAIR";
+        default:               return "UNKNOWN";
+    }
+}
+
+static const char* detector_to_string(uint8_t detector) {
+    switch (detector) {
+        case 0:    return "debugger";
+        case 1:    return "timing";
+        case 2:    return "memory";
+        case 3:    return "stack";
+        case 4:    return "signatures";
+        case 5:    return "maps";
+        case 6:    return "threads";
+        case 7:    return "watch";
+        case 0xFF: return "-";
+        default:   return "other";
+    }
+}
+
+static const char* state_to_string(uint64_t state) {
+    switch (state) {
+        case 0:  return "SAFE";
+        case 1:  return "WARNING";
+        case 2:  return "COMPROMISED";
+        default: return "UNKNOWN";
+    }
+}
+
+static void format_time(uint64_t ns, char* buf, size_t size) {
+    time_t secs = (time_t)(ns / 1000000000ULL);
+    struct tm tm;
+    if (gmtime_r(&secs, &tm) == NULL ||
+        strftime(buf, size, "%Y-%m-%dT%H:%M:%S", &tm) == 0) {
+        snprintf(buf, size, "%llu", (unsigned long long)ns);
+        return;
+    }
+    size_t used = strlen(buf);
+    snprintf(buf + used, size - used, ".%09lluZ",
+             (unsigned long long)(ns % 1000000000ULL));
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <journal-file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    sg_journal_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != SG_JOURNAL_MAGIC ||
+        header.version != SG_JOURNAL_VERSION ||
+        header.record_size != sizeof(sg_journal_record_t)) {
+        fprintf(stderr, "%s: not a Self-Guard journal (v%u)\n", argv[1], SG_JOURNAL_VERSION);
+        fclose(f);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t reserved = header.cursor < header.capacity ? header.cursor : header.capacity;
+    char when[64];
+    format_time(header.created_ns, when, sizeof(when));
+    printf("journal: %s created %s capacity %llu reserved %llu dropped %llu\n",
+           argv[1], when,
+           (unsigned long long)header.capacity,
+           (unsigned long long)reserved,
+           (unsigned long long)header.dropped);
+
+    uint64_t torn = 0;
+    for (uint64_t i = 0; i < reserved; i++) {
+        sg_journal_record_t rec;
+        if (fread(&rec, sizeof(rec), 1, f) != 1) {
+            fprintf(stderr, "%s: truncated at record %llu\n", argv[1], (unsigned long long)i);
+            break;
+        }
+
+        if (rec.commit != i + 1) {
+            printf("%8llu  <torn>\n", (unsigned long long)i);
+            torn++;
+            continue;
+        }
+
+        format_time(rec.realtime_ns, when, sizeof(when));
+        printf("%8llu  %s  pid %u tid %u  %-9s %-8s state %-11s",
+               (unsigned long long)i, when, rec.pid, rec.tid,
+               event_to_string(rec.type), detector_to_string(rec.detector),
+               state_to_string(rec.state));
+
+        if (rec.len != 0) {
+            printf("  region 0x%llx+0x%llx",
+                   (unsigned long long)rec.addr, (unsigned long long)rec.len);
+        }
+        if (rec.type == SG_JEV_STATE) {
+            printf("  from %s", state_to_string(rec.value));
+        } else if (rec.type == SG_JEV_SNAPSHOT || rec.type == SG_JEV_DETECTION) {
+            printf("  value 0x%llx", (unsigned long long)rec.value);
+        }
+        if (rec.cycles != 0) {
+            printf("  cycles %llu", (unsigned long long)rec.cycles);
+        }
+        printf("\n");
+    }
+
+    if (torn != 0) {
+        printf("%llu torn record(s)\n", (unsigned long long)torn);
+    }
+
+    fclose(f);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/*
+ * sg-sigc: Self-Guard signature set compiler
+ *
+ * Usage: sg-sigc <input.txt> <output.sgs>
+ *
+ * One signature per line: a decimal or 0x id followed by hex bytes,
+ * which may be grouped with spaces. '#' starts a comment.
+ *
+ *   # id  bytes
+ *   1001  48 31 c0 48 89 c7 b0 3b 0f 05
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "self_guard_signatures.h"
+
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* Parse one line into id/bytes; 0 = blank, 1 = signature, -1 = error */
+static int parse_line(char* line, uint32_t* id, uint8_t* bytes, size_t* len) {
+    char* hash = strchr(line, '#');
+    if (hash != NULL) {
+        *hash = '\0';
+    }
+    char* p = line;
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    if (*p == '\0') {
+        return 0;
+    }
+
+    char* end;
+    unsigned long value = strtoul(p, &end, 0);
+    if (end == p || !isspace((unsigned char)*end) || value > UINT32_MAX) {
+        return -1;
+    }
+    *id = (uint32_t)value;
+
+    *len = 0;
+    int high = -1;
+    for (p = end; *p != '\0'; p++) {
+        if (isspace((unsigned char)*p)) {
+            continue;
+        }
+        int nibble = hex_value((unsigned char)*p);
+        if (nibble < 0) {
+            return -1;
+        }
+        if (high < 0) {
+            high = nibble;
+            continue;
+        }
+        if (*len == SG_SIG_MAX_LEN) {
+            return -1;
+        }
+        bytes[(*len)++] = (uint8_t)((high << 4) | nibble);
+        high = -1;
+    }
+    return (high < 0 && *len >= SG_SIG_MIN_LEN) ? 1 : -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <input.txt> <output.sgs>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* in = fopen(argv[1], "r");
+    if (in == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t* payload = NULL;
+    size_t payload_size = 0;
+    size_t capacity = 0;
+    uint32_t count = 0;
+    char line[2048];
+    unsigned lineno = 0;
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        lineno++;
+        uint32_t id;
+        uint8_t bytes[SG_SIG_MAX_LEN];
+        size_t len;
+        int rc = parse_line(line, &id, bytes, &len);
+        if (rc == 0) {
+            continue;
+        }
+        if (rc < 0) {
+            fprintf(stderr, "%s:%u: expected '<id> <hex bytes>' with %d..%d bytes\n",
+                    argv[1], lineno, SG_SIG_MIN_LEN, SG_SIG_MAX_LEN);
+            fclose(in);
+            free(payload);
+            return EXIT_FAILURE;
+        }
+        if (count == SG_SIG_MAX_COUNT) {
+            fprintf(stderr, "%s: more than %d signatures\n", argv[1], SG_SIG_MAX_COUNT);
+            fclose(in);
+            free(payload);
+            return EXIT_FAILURE;
+        }
+        if (payload_size + 5 + len > capacity) {
+            capacity = capacity != 0 ? capacity * 2 : 4096;
+            uint8_t* grown = realloc(payload, capacity);
+            if (grown == NULL) {
+                perror("realloc");
+                fclose(in);
+                free(payload);
+                return EXIT_FAILURE;
+            }
+            payload = grown;
+        }
+        payload[payload_size++] = (uint8_t)id;
+        payload[payload_size++] = (uint8_t)(id >> 8);
+        payload[payload_size++] = (uint8_t)(id >> 16);
+        payload[payload_size++] = (uint8_t)(id >> 24);
+        payload[payload_size++] = (uint8_t)len;
+        memcpy(payload + payload_size, bytes, len);
+        payload_size += len;
+        count++;
+    }
+    fclose(in);
+
+    if (count == 0) {
+        fprintf(stderr, "%s: no signatures\n", argv[1]);
+        free(payload);
+        return EXIT_FAILURE;
+    }
+
+    sg_sigset_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SG_SIGSET_MAGIC;
+    header.version = SG_SIGSET_VERSION;
+    header.count = count;
+    header.payload_size = (uint32_t)payload_size;
+    header.checksum = SG_SIGSET_FNV_OFFSET;
+    for (size_t i = 0; i < payload_size; i++) {
+        header.checksum ^= payload[i];
+        header.checksum *= SG_SIGSET_FNV_PRIME;
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == NULL) {
+        perror(argv[2]);
+        free(payload);
+        return EXIT_FAILURE;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+             fwrite(payload, 1, payload_size, out) == payload_size;
+    ok = (fclose(out) == 0) && ok;
+    free(payload);
+    if (!ok) {
+        perror(argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u signatures, %zu bytes -> %s\n", count, sizeof(header) + payload_size, argv[2]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+/*
+ * sg-tune: Self-Guard checksum kernel autotuner
+ *
+ * Usage: sg-tune [tuning-file]
+ *
+ * Benchmarks every built-in checksum kernel on this host, rejects
+ * those whose digests differ from the reference, and prints the
+ * choice. With a path, the result is written there for sg_init to
+ * pick up via the SG_TUNING_FILE environment variable.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "self_guard.h"
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [tuning-file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* path = argc == 2 ? argv[1] : NULL;
+    sg_tuning_info_t info = {0};
+    sg_result_t result = sg_autotune(path, &info);
+
+    for (uint32_t i = 0; i < info.candidate_count && i < SG_TUNING_MAX_KERNELS; i++) {
+        const sg_tuning_candidate_t* cand = &info.candidates[i];
+        if (cand->matches_reference) {
+            printf("%-16s %10llu ns/KiB\n", cand->name,
+                   (unsigned long long)cand->ns_per_kib);
+        } else {
+            printf("%-16s   rejected (digest mismatch)\n", cand->name);
+        }
+    }
+
+    if (result != SG_OK && info.candidate_count == 0) {
+        fprintf(stderr, "[!] Autotuning failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("\nkernel       %s\n", info.kernel);
+    printf("slice_pages  %llu\n", (unsigned long long)info.slice_pages);
+
+    if (result != SG_OK) {
+        fprintf(stderr, "[!] Could not write %s\n", path);
+        return EXIT_FAILURE;
+    }
+    if (path != NULL) {
+        printf("written to   %s  (export SG_TUNING_FILE=%s)\n", path, path);
+    }
+    return EXIT_SUCCESS;
+}